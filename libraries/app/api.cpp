@@ -39,6 +39,21 @@
 
 namespace muse { namespace app {
 
+    /** the p2p node, which a replica (replicate-from) does not have */
+    static graphene::net::node& p2p_node_of( application& app )
+    {
+       graphene::net::node_ptr node = app.p2p_node();
+       FC_ASSERT( node, "This node follows a primary node and is not connected to the p2p network" );
+       return *node;
+    }
+
+    static transaction_admission_queue& transaction_queue_of( application& app )
+    {
+       std::shared_ptr< transaction_admission_queue > queue = app.get_transaction_admission_queue();
+       FC_ASSERT( queue, "The node has not started yet" );
+       return *queue;
+    }
+
     login_api::login_api(const api_context& ctx)
     :_ctx(ctx)
     {
@@ -107,67 +122,23 @@ namespace muse { namespace app {
 
     network_broadcast_api::network_broadcast_api(const api_context& a):_app(a.app)
     {
-       /// NOTE: cannot register callbacks in constructor because shared_from_this() is not valid.
-    }
-
-    void network_broadcast_api::on_api_startup()
-    {
-       /// note cannot capture shared pointer here, because _applied_block_connection will never
-       /// be freed if the lambda holds a reference to it.
-       _applied_block_connection = connect_signal( _app.chain_database()->applied_block, *this, &network_broadcast_api::on_applied_block );
     }
 
-    void network_broadcast_api::on_applied_block( const signed_block& b )
-    {
-       int32_t block_num = int32_t(b.block_num());
-       if( _callbacks.size() )
-       {
-          /// we need to ensure the database_api is not deleted for the life of the async operation
-          auto capture_this = shared_from_this();
-          for( size_t trx_num = 0; trx_num < b.transactions.size(); ++trx_num )
-          {
-             const auto& trx = b.transactions[trx_num];
-             auto id = trx.id();
-             auto itr = _callbacks.find(id);
-             if( itr != _callbacks.end() )
-             {
-                auto callback = _callbacks.find(id)->second;
-                fc::async( [capture_this,this,id,block_num,trx_num,callback](){ callback( fc::variant( transaction_confirmation{ id, block_num, int32_t(trx_num), false}, GRAPHENE_MAX_NESTED_OBJECTS ) ); } );
-                itr->second = []( const variant& ){};
-             }
-          }
-       }
-
-       /// clear all expirations
-       if( _callbacks_expirations.size() ) {
-          auto end = _callbacks_expirations.upper_bound( b.timestamp );
-          auto itr = _callbacks_expirations.begin();
-          while( itr != end ) {
-             for( const auto trx_id : itr->second ) {
-               auto cb_itr = _callbacks.find( trx_id );
-               if( cb_itr != _callbacks.end() ) {
-                   auto capture_this = shared_from_this();
-                   auto callback = _callbacks.find(trx_id)->second; 
-                   fc::async( [capture_this,this,block_num,trx_id,callback](){ callback( fc::variant( transaction_confirmation{ trx_id, block_num, -1, true}, GRAPHENE_MAX_NESTED_OBJECTS ) ); } );
-                   _callbacks.erase(cb_itr);
-               }
-             }
-             _callbacks_expirations.erase( itr );
-             itr = _callbacks_expirations.begin();
-          }
-       }
-    }
+    /// confirmations are tracked by the application's transaction_confirmation_tracker
+    void network_broadcast_api::on_api_startup() {}
 
     void network_broadcast_api::broadcast_transaction(const signed_transaction& trx)
     {
-       trx.validate();
-       _app.chain_database()->push_transaction(trx);
-       _app.p2p_node()->broadcast_transaction(trx);
+       graphene::net::node& node = p2p_node_of( _app );
+       // the admission queue runs trx.validate() before pushing
+       transaction_queue_of( _app ).push_transaction(trx, true);
+       node.broadcast_transaction(trx);
     }
     fc::variant network_broadcast_api::broadcast_transaction_synchronous(const signed_transaction& trx)
     {
+       // the waiting fiber is resumed by the tracker's delivery task, no other fiber is started
        promise<fc::variant>::ptr prom( new fc::promise<fc::variant>() );
-       broadcast_transaction_with_callback( [=]( const fc::variant& v ){ 
+       broadcast_transaction_with_callback( [prom]( const fc::variant& v ){
           prom->set_value(v);
        }, trx );
        return future<fc::variant>(prom).wait();
@@ -175,18 +146,19 @@ namespace muse { namespace app {
 
     void network_broadcast_api::broadcast_block( const signed_block& b )
     {
+       graphene::net::node& node = p2p_node_of( _app );
        _app.chain_database()->push_block(b);
-       _app.p2p_node()->broadcast( graphene::net::block_message( b ));
+       node.broadcast( graphene::net::block_message( b ));
     }
 
     void network_broadcast_api::broadcast_transaction_with_callback(confirmation_callback cb, const signed_transaction& trx)
     {
+       graphene::net::node& node = p2p_node_of( _app );
        trx.validate();
-       _callbacks[trx.id()] = cb;
-       _callbacks_expirations[trx.expiration].push_back(trx.id());
+       _app.get_transaction_confirmation_tracker()->watch( trx, std::move( cb ) );
 
-       _app.chain_database()->push_transaction(trx);
-       _app.p2p_node()->broadcast_transaction(trx);
+       transaction_queue_of( _app ).push_transaction(trx, true);
+       node.broadcast_transaction(trx);
     }
 
     network_node_api::network_node_api( const api_context& a ) : _app( a.app )
@@ -197,34 +169,56 @@ namespace muse { namespace app {
 
     fc::variant_object network_node_api::get_info() const
     {
-       fc::mutable_variant_object result = _app.p2p_node()->network_get_info();
-       result["connection_count"] = _app.p2p_node()->get_connection_count();
+       graphene::net::node& node = p2p_node_of( _app );
+       fc::mutable_variant_object result = node.network_get_info();
+       result["connection_count"] = node.get_connection_count();
        return result;
     }
 
     void network_node_api::add_node(const fc::ip::endpoint& ep)
     {
-       _app.p2p_node()->add_node(ep);
+       p2p_node_of( _app ).add_node(ep);
     }
 
     std::vector<graphene::net::peer_status> network_node_api::get_connected_peers() const
     {
-       return _app.p2p_node()->get_connected_peers();
+       return p2p_node_of( _app ).get_connected_peers();
     }
 
     std::vector<graphene::net::potential_peer_record> network_node_api::get_potential_peers() const
     {
-       return _app.p2p_node()->get_potential_peers();
+       return p2p_node_of( _app ).get_potential_peers();
+    }
+
+    transaction_admission_stats network_node_api::get_transaction_queue_stats() const
+    {
+       return transaction_queue_of( _app ).get_stats();
+    }
+
+    response_cache_stats network_node_api::get_response_cache_stats() const
+    {
+       return _app.get_response_cache()->get_stats();
     }
 
     fc::variant_object network_node_api::get_advanced_node_parameters() const
     {
-       return _app.p2p_node()->get_advanced_node_parameters();
+       return p2p_node_of( _app ).get_advanced_node_parameters();
     }
 
     void network_node_api::set_advanced_node_parameters(const fc::variant_object& params)
     {
-       return _app.p2p_node()->set_advanced_node_parameters(params);
+       return p2p_node_of( _app ).set_advanced_node_parameters(params);
+    }
+
+    node_stats_api::node_stats_api( const api_context& a ) : _app( a.app )
+    {
+    }
+
+    void node_stats_api::on_api_startup() {}
+
+    api_admission_stats node_stats_api::get_api_stats() const
+    {
+       return _app.get_api_admission_control()->get_stats();
     }
 
     vector< string > get_relevant_accounts( const object* obj )
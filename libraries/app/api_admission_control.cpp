@@ -0,0 +1,137 @@
+#include <muse/app/api_admission_control.hpp>
+
+#include <algorithm>
+
+namespace muse { namespace app {
+
+api_admission_control::api_admission_control( const chain::database& db, const config& cfg )
+   : _db( db ), _config( cfg )
+{
+}
+
+std::shared_ptr< api_admission_control::connection_budget > api_admission_control::open_connection()const
+{
+   std::shared_ptr< connection_budget > budget = std::make_shared< connection_budget >();
+   budget->tokens = _config.burst;
+   budget->refilled = fc::time_point::now();
+   return budget;
+}
+
+api_admission_control::method_entry& api_admission_control::entry( const char* method )
+{
+   auto itr = _methods.find( method );
+   if( itr == _methods.end() )
+   {
+      itr = _methods.emplace( method, method_entry() ).first;
+      auto cost = _config.costs.find( method );
+      if( cost != _config.costs.end() )
+         itr->second.cost = cost->second;
+   }
+   return itr->second;
+}
+
+uint32_t api_admission_control::call_cost( const method_entry& e, uint32_t size )const
+{
+   uint64_t unit = std::max< uint32_t >( _config.cost_unit_size, 1 );
+   uint64_t units = std::max< uint64_t >( ( uint64_t( size ) + unit - 1 ) / unit, 1 );
+   // a call of the largest allowed size is still possible with a full bucket
+   return std::min< uint64_t >( e.cost * units, std::max< uint32_t >( _config.burst, e.cost ) );
+}
+
+bool api_admission_control::shedding()const
+{
+   return _config.shed_head_age.count() > 0 &&
+          fc::time_point( _db.head_block_time() ) + _config.shed_head_age < fc::time_point::now();
+}
+
+api_admission_control::call_guard::call_guard( api_admission_control* control, const char* method, connection_budget* budget,
+                                               uint32_t size )
+{
+   if( control == nullptr )
+      return;
+   const config& cfg = control->_config;
+   fc::time_point now = fc::time_point::now();
+   std::lock_guard< std::mutex > lock( control->_mutex );
+   method_entry& e = control->entry( method );
+   const uint32_t cost = control->call_cost( e, size );
+
+   if( cfg.max_in_flight > 0 && control->_in_flight >= cfg.max_in_flight )
+   {
+      ++e.rejected;
+      FC_THROW( "Too many API calls in progress, retry ${m} later", ("m",method) );
+   }
+   if( cost >= cfg.shed_min_cost && control->shedding() )
+   {
+      ++e.rejected;
+      FC_THROW( "The node is catching up with the chain, retry ${m} later", ("m",method) );
+   }
+   if( budget != nullptr && cfg.tokens_per_second > 0 )
+   {
+      budget->tokens = std::min< double >( cfg.burst,
+         budget->tokens + double( ( now - budget->refilled ).count() ) * cfg.tokens_per_second / 1000000 );
+      budget->refilled = now;
+      if( budget->tokens < cost )
+      {
+         ++e.rejected;
+         FC_THROW( "API rate limit exceeded, ${m} costs ${c} tokens", ("m",method)("c",cost) );
+      }
+      budget->tokens -= cost;
+   }
+
+   ++e.in_flight;
+   ++control->_in_flight;
+   _control = control;
+   _entry = &e;
+   _start = now;
+}
+
+api_admission_control::call_guard::~call_guard()
+{
+   if( _control == nullptr )
+      return;
+   uint64_t elapsed_us = std::max< int64_t >( 0, ( fc::time_point::now() - _start ).count() );
+   size_t bucket = 0;
+   while( bucket + 1 < histogram_size && ( elapsed_us >> bucket ) != 0 )
+      ++bucket;
+
+   std::lock_guard< std::mutex > lock( _control->_mutex );
+   --_entry->in_flight;
+   --_control->_in_flight;
+   ++_entry->calls;
+   if( !_succeeded )
+      ++_entry->failed;
+   _entry->total_us += elapsed_us;
+   _entry->max_us = std::max( _entry->max_us, elapsed_us );
+   ++_entry->histogram[ bucket ];
+}
+
+api_admission_stats api_admission_control::get_stats()const
+{
+   api_admission_stats result;
+   result.max_in_flight = _config.max_in_flight;
+   result.shedding = shedding();
+   std::lock_guard< std::mutex > lock( _mutex );
+   result.in_flight = _in_flight;
+   result.methods.reserve( _methods.size() );
+   for( const auto& m : _methods )
+   {
+      api_method_stats stats;
+      stats.method    = m.first;
+      stats.cost      = m.second.cost;
+      stats.calls     = m.second.calls;
+      stats.rejected  = m.second.rejected;
+      stats.failed    = m.second.failed;
+      stats.in_flight = m.second.in_flight;
+      stats.total_us  = m.second.total_us;
+      stats.max_us    = m.second.max_us;
+      // trailing empty buckets are left out
+      size_t used = histogram_size;
+      while( used > 0 && m.second.histogram[ used - 1 ] == 0 )
+         --used;
+      stats.latency_histogram.assign( m.second.histogram.begin(), m.second.histogram.begin() + used );
+      result.methods.push_back( std::move( stats ) );
+   }
+   return result;
+}
+
+} } // muse::app
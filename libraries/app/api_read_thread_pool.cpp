@@ -0,0 +1,12 @@
+#include <muse/app/api_read_thread_pool.hpp>
+
+namespace muse { namespace app {
+
+api_read_thread_pool::api_read_thread_pool( const chain::database& db, uint32_t thread_count )
+   : _db( db )
+{
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.emplace_back( new fc::thread( "api_read_" + std::to_string( i ) ) );
+}
+
+} } // muse::app
@@ -25,9 +25,19 @@
 #include <muse/app/api_access.hpp>
 #include <muse/app/application.hpp>
 #include <muse/app/plugin.hpp>
+#include <muse/app/transaction_admission_queue.hpp>
+#include <muse/app/api_read_thread_pool.hpp>
+#include <muse/app/subscription_manager.hpp>
+#include <muse/app/transaction_confirmation_tracker.hpp>
+#include <muse/app/api_admission_control.hpp>
+#include <muse/app/response_cache.hpp>
+#include <muse/app/binary_rpc.hpp>
+#include <muse/app/http_rpc_server.hpp>
+#include <muse/app/state_replication.hpp>
 
 #include <muse/chain/protocol/types.hpp>
 #include <muse/chain/base_objects.hpp>
+#include <muse/chain/block_prevalidation.hpp>
 
 #include <muse/egenesis/egenesis.hpp>
 
@@ -42,13 +52,16 @@
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
 #include <fc/network/resolve.hpp>
+#include <fc/thread/thread.hpp>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/signals2.hpp>
 #include <boost/range/algorithm/reverse.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 
 #include <fc/log/file_appender.hpp>
 #include <fc/log/logger.hpp>
@@ -77,6 +90,13 @@ api_context::api_context( application& _app, const std::string& _api_name, std::
 
 namespace detail {
 
+   /** threads running prevalidate_block() on sync blocks ahead of push_block() */
+   static const uint32_t prevalidation_thread_count = 2;
+   /** sync blocks are no longer prevalidated while this many results are waiting */
+   static const size_t   max_prevalidated_blocks = 1000;
+   /** threads running validate() and signature key recovery for incoming transactions */
+   static const uint32_t transaction_check_thread_count = 2;
+
    class application_impl : public graphene::net::node_delegate
    {
    public:
@@ -204,6 +224,79 @@ namespace detail {
          _websocket_tls_server->start_accept();
       } FC_CAPTURE_AND_RETHROW() }
 
+      api_admission_control::config api_admission_config()const
+      { try {
+         api_admission_control::config cfg;
+         cfg.max_in_flight     = _options->at("api-max-in-flight").as<uint32_t>();
+         cfg.tokens_per_second = _options->at("api-connection-rate").as<uint32_t>();
+         cfg.burst             = _options->at("api-connection-burst").as<uint32_t>();
+         cfg.shed_head_age     = fc::seconds( _options->at("api-shed-head-age").as<uint32_t>() );
+         cfg.shed_min_cost     = _options->at("api-shed-min-cost").as<uint32_t>();
+         cfg.cost_unit_size    = _options->at("api-cost-unit-size").as<uint32_t>();
+
+         // expensive calls by default, api-method-cost overrides them
+         cfg.costs["get_order_book"]            = 10;
+         cfg.costs["get_order_book_for_asset"]  = 10;
+         cfg.costs["get_blocks"]                = 10;
+         cfg.costs["get_block_range_raw"]       = 5;
+         cfg.costs["get_proposed_transactions"] = 5;
+         cfg.costs["get_key_references"]        = 5;
+         cfg.costs["lookup_accounts"]           = 5;
+         cfg.costs["lookup_content"]            = 5;
+         cfg.costs["get_account_history"]       = 5;
+         if( _options->count("api-method-cost") )
+         {
+            for( const std::string& arg : _options->at("api-method-cost").as< std::vector< std::string > >() )
+            {
+               auto pos = arg.find( '=' );
+               FC_ASSERT( pos != std::string::npos, "Expected METHOD=COST" );
+               cfg.costs[ arg.substr( 0, pos ) ] = boost::lexical_cast<uint32_t>( arg.substr( pos + 1 ) );
+            }
+         }
+         return cfg;
+      } FC_CAPTURE_AND_RETHROW() }
+
+      void reset_binary_rpc_server()
+      { try {
+         if( !_options->count("rpc-binary-endpoint") )
+            return;
+         // there is no login on the binary endpoint
+         if( std::find( _public_apis.begin(), _public_apis.end(), "database_api" ) == _public_apis.end() )
+         {
+            wlog( "database_api must be a public-api to use rpc-binary-endpoint" );
+            return;
+         }
+
+         _binary_rpc_server = std::make_shared<binary_rpc_server>( *_self );
+         ilog("Configured binary rpc to listen on ${ip}", ("ip",_options->at("rpc-binary-endpoint").as<string>()));
+         _binary_rpc_server->listen( fc::ip::endpoint::from_string(_options->at("rpc-binary-endpoint").as<string>()) );
+      } FC_CAPTURE_AND_RETHROW() }
+
+      void reset_state_delta_follower()
+      { try {
+         // a replica takes its state from the primary only, it does not join the p2p network
+         fc::ip::endpoint primary = fc::ip::endpoint::from_string(_options->at("replicate-from").as<string>());
+         _state_delta_follower = std::make_shared<state_delta_follower>( *_chain_db, primary );
+         ilog("Configured replica to follow primary node ${ip}", ("ip",primary));
+         _state_delta_follower->start();
+      } FC_CAPTURE_AND_RETHROW() }
+
+      void reset_http_rpc_server()
+      { try {
+         if( !_options->count("rpc-http-endpoint") )
+            return;
+
+         http_rpc_limits limits;
+         limits.idle_timeout = fc::seconds( _options->at("rpc-http-idle-timeout").as<uint32_t>() );
+         limits.header_timeout = fc::seconds( _options->at("rpc-http-header-timeout").as<uint32_t>() );
+         limits.body_timeout = fc::seconds( _options->at("rpc-http-body-timeout").as<uint32_t>() );
+         limits.max_buffered_bytes = _options->at("rpc-http-max-buffered-bytes").as<uint64_t>();
+         _http_rpc_server = std::make_shared<http_rpc_server>( *_self, _public_apis,
+            _options->at("rpc-http-workers").as<uint32_t>(), _options->at("rpc-http-max-pipeline").as<uint32_t>(), limits );
+         ilog("Configured HTTP rpc to listen on ${ip}", ("ip",_options->at("rpc-http-endpoint").as<string>()));
+         _http_rpc_server->listen( fc::ip::endpoint::from_string(_options->at("rpc-http-endpoint").as<string>()) );
+      } FC_CAPTURE_AND_RETHROW() }
+
       void on_connection( const fc::http::websocket_connection_ptr& c )
       {
          std::shared_ptr< api_session_data > session = std::make_shared<api_session_data>();
@@ -233,6 +326,9 @@ namespace detail {
 
       ~application_impl()
       {
+         std::lock_guard< std::mutex > lock( _prevalidation_mutex );
+         _prevalidated_blocks.clear();
+         _prevalidation_threads.clear();
       }
 
       void register_builtin_apis()
@@ -241,6 +337,7 @@ namespace detail {
          _self->register_api_factory< database_api >( "database_api" );
          _self->register_api_factory< network_node_api >( "network_node_api" );
          _self->register_api_factory< network_broadcast_api >( "network_broadcast_api" );
+         _self->register_api_factory< node_stats_api >( "node_stats_api" );
       }
 
       void startup()
@@ -288,6 +385,12 @@ namespace detail {
          if( _options->count("replay-blockchain") )
             _chain_db->wipe( _data_dir / "blockchain", false );
 
+         if( _options->count("replay-conflict-analysis") )
+         {
+            ilog( "Recording transaction write conflicts during replay, for measurement only" );
+            _chain_db->enable_conflict_tracking();
+         }
+
          try
          {
             _chain_db->open( _data_dir / "blockchain", initial_state(), GRAPHENE_CURRENT_DB_VERSION );
@@ -300,6 +403,19 @@ namespace detail {
 
          _pending_trx_db->open(_data_dir / "node/transaction_history" );
 
+         _transaction_queue = std::make_shared< transaction_admission_queue >( *_chain_db,
+            _options->at("transaction-queue-size").as<uint32_t>(), transaction_check_thread_count );
+         _api_read_threads = std::make_shared< api_read_thread_pool >( *_chain_db,
+            _options->at("api-read-threads").as<uint32_t>() );
+         _subscriptions = std::make_shared< subscription_manager >( *_chain_db );
+         _confirmations = std::make_shared< transaction_confirmation_tracker >( *_chain_db );
+         _response_cache = std::make_shared< response_cache >( *_chain_db,
+            _options->at("api-response-cache-size").as<uint32_t>() );
+         _api_admission = std::make_shared< api_admission_control >( *_chain_db, api_admission_config() );
+         if( _options->at("state-delta-history").as<uint32_t>() > 0 )
+            _state_delta_feed = std::make_shared< state_delta_feed >( *_chain_db,
+               _options->at("state-delta-history").as<uint32_t>() );
+
          if( _options->count("force-validate") )
          {
             ilog( "All transaction signatures will be validated" );
@@ -341,9 +457,19 @@ namespace detail {
             }
          }
 
-         reset_p2p_node(_data_dir);
+         if( _options->count("replicate-from") )
+         {
+            for( const auto& entry : _plugins_enabled )
+               FC_ASSERT( entry.second->plugin_supports_replica(),
+                          "Plugin ${p} cannot be enabled on a node that replicates another one", ("p",entry.first) );
+            reset_state_delta_follower();
+         }
+         else
+            reset_p2p_node(_data_dir);
          reset_websocket_server();
          reset_websocket_tls_server();
+         reset_binary_rpc_server();
+         reset_http_rpc_server();
       } FC_LOG_AND_RETHROW() }
 
       optional< api_access_info > get_api_access_info(const string& username)const
@@ -425,7 +551,14 @@ namespace detail {
             // you can help the network code out by throwing a block_older_than_undo_history exception.
             // when the net code sees that, it will stop trying to push blocks from that chain, but
             // leave that peer connected so that they can get sync blocks from us
-            bool result = _chain_db->push_block(blk_msg.block, (_is_block_producer | _force_validate) ? database::skip_nothing : database::skip_transaction_signatures);
+            // only sync blocks are prevalidated, a block from any other path is checked in full
+            std::shared_ptr< chain::prevalidated_block > pre;
+            if( sync_mode )
+               pre = take_prevalidated_block( blk_msg.block_id );
+            else
+               drop_prevalidated_blocks();
+            bool result = _chain_db->push_block(blk_msg.block, (_is_block_producer | _force_validate) ? database::skip_nothing : database::skip_transaction_signatures,
+                                                pre.get());
 
             if( !sync_mode )
             {
@@ -455,9 +588,64 @@ namespace detail {
          }
       } FC_CAPTURE_AND_RETHROW( (blk_msg)(sync_mode) ) }
 
+      /**
+       * Runs the state independent checks of a sync block on one of the prevalidation threads,
+       * the result is picked up by handle_block().  Called on the p2p thread.
+       */
+      virtual void prevalidate_block(const graphene::net::block_message& blk_msg) override
+      {
+         std::lock_guard< std::mutex > lock( _prevalidation_mutex );
+         if( _prevalidated_blocks.size() >= max_prevalidated_blocks || _prevalidated_blocks.count( blk_msg.block_id ) )
+            return;
+
+         if( _prevalidation_threads.empty() )
+            for( uint32_t i = 0; i < prevalidation_thread_count; ++i )
+               _prevalidation_threads.emplace_back( new fc::thread( "prevalidation_" + std::to_string( i ) ) );
+
+         auto block = std::make_shared< signed_block >( blk_msg.block );
+         bool recover_signature_keys = _is_block_producer | _force_validate;
+         fc::thread& thread = *_prevalidation_threads[ _next_prevalidation_thread++ % _prevalidation_threads.size() ];
+         _prevalidated_blocks[ blk_msg.block_id ] = thread.async( [block, recover_signature_keys]() {
+            return std::make_shared< chain::prevalidated_block >(
+               chain::prevalidate_block( *block, MUSE_CHAIN_ID, recover_signature_keys ) );
+         }, "prevalidate_block" );
+      }
+
+      /**
+       * Waits for and removes the prevalidation result of the given block, if there is one.
+       * Results for lower block numbers are dropped too, block ids sort by block number.
+       */
+      std::shared_ptr< chain::prevalidated_block > take_prevalidated_block( const block_id_type& block_id )
+      {
+         fc::future< std::shared_ptr< chain::prevalidated_block > > result;
+         {
+            std::lock_guard< std::mutex > lock( _prevalidation_mutex );
+            auto itr = _prevalidated_blocks.find( block_id );
+            if( itr == _prevalidated_blocks.end() )
+               return std::shared_ptr< chain::prevalidated_block >();
+            result = itr->second;
+            _prevalidated_blocks.erase( _prevalidated_blocks.begin(), ++itr );
+         }
+         try
+         {
+            return result.wait();
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "prevalidation of block ${id} failed: ${e}", ("id",block_id)("e",e.to_detail_string()) );
+            return std::shared_ptr< chain::prevalidated_block >();
+         }
+      }
+
+      void drop_prevalidated_blocks()
+      {
+         std::lock_guard< std::mutex > lock( _prevalidation_mutex );
+         _prevalidated_blocks.clear();
+      }
+
       virtual void handle_transaction(const graphene::net::trx_message& transaction_message) override
       { try {
-         _chain_db->push_transaction( transaction_message.trx );
+         _transaction_queue->push_transaction( transaction_message.trx, false );
       } FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
 
       virtual void handle_message(const message& message_to_process) override
@@ -789,6 +977,16 @@ namespace detail {
       std::shared_ptr<graphene::net::node>             _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
+      std::shared_ptr<binary_rpc_server>               _binary_rpc_server;
+      std::shared_ptr<http_rpc_server>                 _http_rpc_server;
+      std::shared_ptr<transaction_admission_queue>     _transaction_queue;
+      std::shared_ptr<api_read_thread_pool>            _api_read_threads;
+      std::shared_ptr<subscription_manager>            _subscriptions;
+      std::shared_ptr<transaction_confirmation_tracker> _confirmations;
+      std::shared_ptr<response_cache>                  _response_cache;
+      std::shared_ptr<api_admission_control>           _api_admission;
+      std::shared_ptr<state_delta_feed>                _state_delta_feed;
+      std::shared_ptr<state_delta_follower>            _state_delta_follower;
 
       std::map<string, std::shared_ptr<abstract_plugin> > _plugins_available;
       std::map<string, std::shared_ptr<abstract_plugin> > _plugins_enabled;
@@ -797,6 +995,11 @@ namespace detail {
 
       bool _is_finished_syncing = false;
       uint32_t allow_future_time = 5;
+
+      std::mutex                                       _prevalidation_mutex;
+      std::vector< std::unique_ptr< fc::thread > >     _prevalidation_threads;
+      uint32_t                                         _next_prevalidation_thread = 0;
+      std::map< block_id_type, fc::future< std::shared_ptr< chain::prevalidated_block > > > _prevalidated_blocks;
    };
 
 }
@@ -807,11 +1010,26 @@ application::application()
 
 application::~application()
 {
+   if( my->_http_rpc_server )
+   {
+      my->_http_rpc_server->close();
+      my->_http_rpc_server.reset();
+   }
+   if( my->_binary_rpc_server )
+   {
+      my->_binary_rpc_server->close();
+      my->_binary_rpc_server.reset();
+   }
    if( my->_p2p_network )
    {
       my->_p2p_network->close();
       my->_p2p_network.reset();
    }
+   if( my->_state_delta_follower )
+   {
+      my->_state_delta_follower->stop();
+      my->_state_delta_follower.reset();
+   }
    if( my->_chain_db )
    {
       my->_chain_db->close();
@@ -844,6 +1062,14 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("checkpoint,c", bpo::value<vector<string>>()->composing()->default_value(vector<string>(1,DEFAULT_CHECKPOINT), DEFAULT_CHECKPOINT), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
          ("rpc-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8090"), "Endpoint for websocket RPC to listen on")
          ("rpc-tls-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8089"), "Endpoint for TLS websocket RPC to listen on")
+         ("rpc-binary-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8091"), "Endpoint for binary RPC to listen on, serves database_api with packed results")
+         ("rpc-http-endpoint", bpo::value<string>()->implicit_value("127.0.0.1:8092"), "Endpoint for HTTP JSON-RPC with persistent connections to listen on")
+         ("rpc-http-workers", bpo::value<uint32_t>()->default_value(8), "Number of HTTP JSON-RPC requests executed at the same time")
+         ("rpc-http-max-pipeline", bpo::value<uint32_t>()->default_value(16), "Number of requests an HTTP connection may send ahead of the responses")
+         ("rpc-http-idle-timeout", bpo::value<uint32_t>()->default_value(60), "Seconds an HTTP connection may stay open without a request")
+         ("rpc-http-header-timeout", bpo::value<uint32_t>()->default_value(10), "Seconds a client may take to send the headers of an HTTP request")
+         ("rpc-http-body-timeout", bpo::value<uint32_t>()->default_value(30), "Seconds a client may take to send the body of an HTTP request")
+         ("rpc-http-max-buffered-bytes", bpo::value<uint64_t>()->default_value(32 * 1024 * 1024), "Request bytes an HTTP connection may send ahead of the responses")
          ("server-pem,p", bpo::value<string>()->implicit_value("server.pem"), "The TLS certificate file for this server")
          ("server-pem-password,P", bpo::value<string>()->implicit_value(""), "Password for this certificate")
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
@@ -851,10 +1077,23 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("api-user", bpo::value< vector<string> >()->composing(), "API user specification, may be specified multiple times")
          ("public-api", bpo::value< vector<string> >()->composing()->default_value(default_apis, str_default_apis), "Set an API to be publicly available, may be specified multiple times")
          ("enable-plugin", bpo::value< vector<string> >()->composing()->default_value(default_plugins, str_default_plugins), "Plugin(s) to enable, may be specified multiple times")
+         ("transaction-queue-size", bpo::value<uint32_t>()->default_value(1000), "Number of network transactions that may wait to be checked and applied before further ones are refused")
+         ("api-read-threads", bpo::value<uint32_t>()->default_value(0), "Number of threads serving database_api queries, 0 (the default) serves them on the chain thread")
+         ("api-response-cache-size", bpo::value<uint32_t>()->default_value(1000), "Number of database_api results shared between sessions until the state changes, 0 disables the cache")
+         ("api-max-in-flight", bpo::value<uint32_t>()->default_value(0), "Number of database_api calls served at the same time before further ones are refused, 0 for no limit")
+         ("api-connection-rate", bpo::value<uint32_t>()->default_value(0), "Cost of the database_api calls a connection may make per second, 0 for no limit")
+         ("api-connection-burst", bpo::value<uint32_t>()->default_value(100), "Cost of the database_api calls a connection may make at once when it is under its rate")
+         ("api-method-cost", bpo::value< vector<string> >()->composing(), "Cost of a database_api call as METHOD=COST, the default is 1, may be specified multiple times")
+         ("api-cost-unit-size", bpo::value<uint32_t>()->default_value(100), "Number of items a database_api call may request for its cost, larger requests cost accordingly more")
+         ("api-shed-head-age", bpo::value<uint32_t>()->default_value(0), "Refuse expensive database_api calls while the head block is older than this many seconds, 0 never refuses them")
+         ("api-shed-min-cost", bpo::value<uint32_t>()->default_value(2), "Cost from which database_api calls are refused while the head block is too old")
+         ("state-delta-history", bpo::value<uint32_t>()->default_value(0), "Number of recent blocks whose state deltas are kept for replicas on rpc-binary-endpoint, 0 keeps none")
+         ("replicate-from", bpo::value<string>(), "Binary RPC endpoint of a primary node to follow by applying its state deltas instead of joining the P2P network; only plugins that support replicas may be enabled")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
          ("replay-blockchain", "Rebuild object graph by replaying all blocks")
+         ("replay-conflict-analysis", "Log how many transactions write objects an earlier transaction of their block wrote while replaying. Measurement only, reads are not tracked")
          ("resync-blockchain", "Delete all blocks and re-sync with network from scratch")
          ("force-validate", "Force validation of all transactions")
          ;
@@ -900,6 +1139,41 @@ std::shared_ptr<graphene::db::object_database> application::pending_trx_database
    return my->_pending_trx_db;
 }
 
+std::shared_ptr<transaction_admission_queue> application::get_transaction_admission_queue() const
+{
+   return my->_transaction_queue;
+}
+
+std::shared_ptr<api_read_thread_pool> application::get_api_read_thread_pool() const
+{
+   return my->_api_read_threads;
+}
+
+std::shared_ptr<subscription_manager> application::get_subscription_manager() const
+{
+   return my->_subscriptions;
+}
+
+std::shared_ptr<transaction_confirmation_tracker> application::get_transaction_confirmation_tracker() const
+{
+   return my->_confirmations;
+}
+
+std::shared_ptr<api_admission_control> application::get_api_admission_control() const
+{
+   return my->_api_admission;
+}
+
+std::shared_ptr<response_cache> application::get_response_cache() const
+{
+   return my->_response_cache;
+}
+
+std::shared_ptr<state_delta_feed> application::get_state_delta_feed() const
+{
+   return my->_state_delta_feed;
+}
+
 void application::set_block_production(bool producing_blocks)
 {
    my->_is_block_producer = producing_blocks;
@@ -938,8 +1212,14 @@ void application::shutdown_plugins()
 }
 void application::shutdown()
 {
+   if( my->_http_rpc_server )
+      my->_http_rpc_server->close();
+   if( my->_binary_rpc_server )
+      my->_binary_rpc_server->close();
    if( my->_p2p_network )
       my->_p2p_network->close();
+   if( my->_state_delta_follower )
+      my->_state_delta_follower->stop();
    if( my->_chain_db )
       my->_chain_db->close();
    if( my->_pending_trx_db )
@@ -0,0 +1,314 @@
+#include <muse/app/binary_rpc.hpp>
+#include <muse/app/api_context.hpp>
+#include <muse/app/application.hpp>
+#include <muse/app/database_api.hpp>
+#include <muse/app/state_replication.hpp>
+#include <muse/chain/history_object.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <limits>
+
+namespace muse { namespace app {
+
+namespace binary_rpc {
+
+void write_frame( fc::tcp_socket& socket, const std::vector< char >& header, const char* body, size_t body_size )
+{
+   uint32_t size = header.size() + body_size;
+   std::vector< char > prefix = fc::raw::pack_to_vector( size );
+   socket.write( prefix.data(), prefix.size() );
+   socket.write( header.data(), header.size() );
+   if( body_size > 0 )
+      socket.write( body, body_size );
+   socket.flush();
+}
+
+std::vector< char > read_frame( fc::tcp_socket& socket, uint32_t max_size )
+{
+   char prefix[ sizeof( uint32_t ) ];
+   socket.read( prefix, sizeof( prefix ) );
+   uint32_t size = unpack< uint32_t >( prefix, sizeof( prefix ) );
+   FC_ASSERT( size <= max_size, "Frame of ${s} bytes exceeds the limit of ${m} bytes", ("s",size)("m",max_size) );
+   std::vector< char > result( size );
+   if( size > 0 )
+      socket.read( result.data(), size );
+   return result;
+}
+
+} // binary_rpc
+
+template< typename T >
+void binary_rpc_server::reply_packed( connection& c, uint32_t id, uint8_t status, const T& value )
+{
+   std::vector< char > body = fc::raw::pack_to_vector( value );
+   reply( c, id, status, body.data(), body.size() );
+}
+
+binary_rpc_server::binary_rpc_server( application& app )
+   : _app( app )
+{
+   std::shared_ptr< state_delta_feed > delta_feed = app.get_state_delta_feed();
+
+   _handlers["get_dynamic_global_properties"] = []( connection& c, const binary_rpc_request& request ) {
+      reply_packed( c, request.id, binary_rpc_reply_header::ok, c.db_api->get_dynamic_global_properties() );
+   };
+   _handlers["get_block"] = []( connection& c, const binary_rpc_request& request ) {
+      uint32_t block_num = binary_rpc::unpack< uint32_t >( request.params.data(), request.params.size() );
+      std::vector< std::vector< char > > blocks = c.db_api->get_block_range_raw( block_num, 1 );
+      if( blocks.empty() )
+         reply( c, request.id, binary_rpc_reply_header::ok, nullptr, 0 );
+      else
+         reply( c, request.id, binary_rpc_reply_header::ok, blocks.front().data(), blocks.front().size() );
+   };
+   _handlers["get_blocks"] = []( connection& c, const binary_rpc_request& request ) {
+      uint32_t start = 0;
+      uint32_t count = 0;
+      fc::datastream< const char* > ds( request.params.data(), request.params.size() );
+      fc::raw::unpack( ds, start );
+      fc::raw::unpack( ds, count );
+      while( count > 0 )
+      {
+         // reads are batched, the connection fiber yields while each batch is sent
+         uint32_t batch_size = std::min< uint32_t >( count, 100 );
+         std::vector< std::vector< char > > blocks = c.db_api->get_block_range_raw( start, batch_size );
+         for( const std::vector< char >& block : blocks )
+            reply( c, request.id, binary_rpc_reply_header::more, block.data(), block.size() );
+         if( blocks.size() < batch_size )
+            break;
+         start += batch_size;
+         count -= batch_size;
+      }
+      reply( c, request.id, binary_rpc_reply_header::ok, nullptr, 0 );
+   };
+   _handlers["get_objects"] = []( connection& c, const binary_rpc_request& request ) {
+      std::vector< chain::object_id_type > ids = binary_rpc::unpack< std::vector< chain::object_id_type > >(
+         request.params.data(), request.params.size() );
+      reply_packed( c, request.id, binary_rpc_reply_header::ok, c.db_api->get_objects_raw( ids ) );
+   };
+   _handlers["lookup_account_names"] = []( connection& c, const binary_rpc_request& request ) {
+      std::vector< std::string > names = binary_rpc::unpack< std::vector< std::string > >( request.params.data(), request.params.size() );
+      reply_packed( c, request.id, binary_rpc_reply_header::ok, c.db_api->lookup_account_names( names ) );
+   };
+   _handlers["get_account_history"] = []( connection& c, const binary_rpc_request& request ) {
+      std::string account;
+      uint64_t from = 0;
+      uint32_t limit = 0;
+      fc::datastream< const char* > ds( request.params.data(), request.params.size() );
+      fc::raw::unpack( ds, account );
+      fc::raw::unpack( ds, from );
+      fc::raw::unpack( ds, limit );
+      std::map< uint32_t, chain::operation_object > history = c.db_api->get_account_history( account, from, limit );
+      for( const auto& entry : history )
+         reply_packed( c, request.id, binary_rpc_reply_header::more, entry );
+      reply( c, request.id, binary_rpc_reply_header::ok, nullptr, 0 );
+   };
+   _handlers["get_state_deltas"] = [delta_feed]( connection& c, const binary_rpc_request& request ) {
+      FC_ASSERT( delta_feed, "This node does not keep state deltas" );
+      uint32_t start = 0;
+      uint32_t count = 0;
+      fc::datastream< const char* > ds( request.params.data(), request.params.size() );
+      fc::raw::unpack( ds, start );
+      fc::raw::unpack( ds, count );
+      // replicas cannot undo a block, so only irreversible deltas are served
+      uint32_t last = c.db_api->get_dynamic_global_properties().last_irreversible_block_num;
+      for( ; count > 0 && start <= last; ++start, --count )
+      {
+         std::shared_ptr< const std::vector< char > > delta = delta_feed->get( start );
+         FC_ASSERT( delta, "The state delta of block ${n} is not kept", ("n",start) );
+         reply( c, request.id, binary_rpc_reply_header::more, delta->data(), delta->size() );
+      }
+      reply( c, request.id, binary_rpc_reply_header::ok, nullptr, 0 );
+   };
+}
+
+binary_rpc_server::~binary_rpc_server()
+{
+   close();
+}
+
+void binary_rpc_server::listen( const fc::ip::endpoint& ep )
+{
+   _tcp_server.set_reuse_address();
+   _tcp_server.listen( ep );
+   _accept_task = fc::async( [this]() { accept_loop(); }, "binary_rpc_accept" );
+}
+
+uint16_t binary_rpc_server::get_port()const
+{
+   return _tcp_server.get_port();
+}
+
+void binary_rpc_server::close()
+{
+   if( _accept_task.valid() && !_accept_task.ready() )
+   {
+      _tcp_server.close();
+      _accept_task.cancel_and_wait( __FUNCTION__ );
+   }
+   std::set< std::shared_ptr< connection > > connections;
+   connections.swap( _connections );
+   for( const std::shared_ptr< connection >& c : connections )
+   {
+      c->socket.close();
+      if( c->reader.valid() && !c->reader.ready() )
+         c->reader.cancel_and_wait( __FUNCTION__ );
+   }
+}
+
+void binary_rpc_server::accept_loop()
+{
+   try
+   {
+      while( !_accept_task.canceled() )
+      {
+         std::shared_ptr< connection > c = std::make_shared< connection >();
+         _tcp_server.accept( c->socket );
+         // each connection is admitted and accounted on its own, like a websocket session
+         c->db_api = std::make_shared< database_api >( api_context( _app, "database_api", std::weak_ptr< api_session_data >() ) );
+         _connections.insert( c );
+         c->reader = fc::async( [this, c]() { serve( c ); }, "binary_rpc_connection" );
+      }
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "binary RPC server stopped accepting connections: ${e}", ("e",e.to_detail_string()) );
+   }
+}
+
+void binary_rpc_server::serve( std::shared_ptr< connection > c )
+{
+   try
+   {
+      while( true )
+      {
+         std::vector< char > frame = binary_rpc::read_frame( c->socket, binary_rpc::max_request_size );
+         handle( *c, binary_rpc::unpack< binary_rpc_request >( frame.data(), frame.size() ) );
+      }
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::eof_exception& )
+   {
+   }
+   catch( const fc::exception& e )
+   {
+      dlog( "closing binary RPC connection: ${e}", ("e",e.to_string()) );
+   }
+   c->socket.close();
+   _connections.erase( c );
+}
+
+void binary_rpc_server::handle( connection& c, const binary_rpc_request& request )
+{
+   auto itr = _handlers.find( request.method );
+   std::string error;
+   try
+   {
+      FC_ASSERT( itr != _handlers.end(), "Unknown method ${m}", ("m",request.method) );
+      itr->second( c, request );
+      return;
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      error = e.to_string();
+   }
+   reply_packed( c, request.id, binary_rpc_reply_header::error, error );
+}
+
+void binary_rpc_server::reply( connection& c, uint32_t id, uint8_t status, const char* body, size_t body_size )
+{
+   binary_rpc_reply_header header;
+   header.id = id;
+   header.status = status;
+   binary_rpc::write_frame( c.socket, fc::raw::pack_to_vector( header ), body, body_size );
+}
+
+void binary_rpc_client::connect( const fc::ip::endpoint& ep )
+{
+   _socket.connect_to( ep );
+}
+
+void binary_rpc_client::close()
+{
+   _socket.close();
+}
+
+void binary_rpc_client::call( const std::string& method, const std::vector< char >& params, const body_callback& on_body )
+{
+   binary_rpc_request request;
+   request.id = _next_id++;
+   request.method = method;
+   request.params = params;
+   binary_rpc::write_frame( _socket, fc::raw::pack_to_vector( request ), nullptr, 0 );
+
+   while( true )
+   {
+      std::vector< char > frame = binary_rpc::read_frame( _socket, std::numeric_limits< uint32_t >::max() );
+      _bytes_received += sizeof( uint32_t ) + frame.size();
+      fc::datastream< const char* > ds( frame.data(), frame.size() );
+      binary_rpc_reply_header header;
+      fc::raw::unpack( ds, header );
+      FC_ASSERT( header.id == request.id, "Reply to request ${r} while waiting for ${i}", ("r",header.id)("i",request.id) );
+      const char* body = frame.data() + ds.tellp();
+      size_t body_size = ds.remaining();
+      if( header.status == binary_rpc_reply_header::error )
+         FC_THROW( "${m} failed: ${e}", ("m",method)("e",binary_rpc::unpack< std::string >( body, body_size )) );
+      if( body_size > 0 )
+         on_body( body, body_size );
+      if( header.status == binary_rpc_reply_header::ok )
+         return;
+   }
+}
+
+chain::dynamic_global_property_object binary_rpc_client::get_dynamic_global_properties()
+{
+   return call_packed< chain::dynamic_global_property_object >( "get_dynamic_global_properties" );
+}
+
+fc::optional< chain::signed_block > binary_rpc_client::get_block( uint32_t block_num )
+{
+   fc::optional< chain::signed_block > result;
+   std::vector< char > params;
+   binary_rpc::pack_args( params, block_num );
+   call( "get_block", params, [&result]( const char* data, size_t size ) {
+      result = binary_rpc::unpack< chain::signed_block >( data, size );
+   } );
+   return result;
+}
+
+uint32_t binary_rpc_client::get_blocks( uint32_t start, uint32_t count, const std::function< void( const chain::signed_block& ) >& on_block )
+{
+   uint32_t received = 0;
+   std::vector< char > params;
+   binary_rpc::pack_args( params, start, count );
+   call( "get_blocks", params, [&]( const char* data, size_t size ) {
+      on_block( binary_rpc::unpack< chain::signed_block >( data, size ) );
+      ++received;
+   } );
+   return received;
+}
+
+uint32_t binary_rpc_client::get_state_deltas( uint32_t start, uint32_t count, const std::function< void( const chain::state_delta& ) >& on_delta )
+{
+   uint32_t received = 0;
+   std::vector< char > params;
+   binary_rpc::pack_args( params, start, count );
+   call( "get_state_deltas", params, [&]( const char* data, size_t size ) {
+      on_delta( binary_rpc::unpack< chain::state_delta >( data, size ) );
+      ++received;
+   } );
+   return received;
+}
+
+} } // muse::app
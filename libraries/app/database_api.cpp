@@ -1,12 +1,16 @@
 #include <muse/app/api_context.hpp>
+#include <muse/app/api_read_thread_pool.hpp>
 #include <muse/app/application.hpp>
 #include <muse/app/database_api.hpp>
+#include <muse/app/subscription_manager.hpp>
+#include <muse/app/response_cache.hpp>
+#include <muse/app/api_admission_control.hpp>
 #include <muse/chain/get_config.hpp>
 #include <muse/chain/base_objects.hpp>
-#include <fc/bloom_filter.hpp>
 #include <fc/smart_ref_impl.hpp>
 
 #include <fc/crypto/hex.hpp>
+#include <fc/io/raw.hpp>
 
 #include <boost/range/iterator_range.hpp>
 #include <boost/algorithm/string.hpp>
@@ -24,17 +28,101 @@ static const std::locale& c_locale = std::locale::classic();
 
 namespace muse { namespace app {
 
+/** list cursors are the hex encoded index key of the first item not returned yet */
+template< typename Key >
+static string encode_cursor( const Key& key )
+{
+   return fc::to_hex( fc::raw::pack_to_vector( key ) );
+}
+
+template< typename Key >
+static Key decode_cursor( const string& cursor )
+{ try {
+   vector<char> data( cursor.size() / 2 );
+   FC_ASSERT( cursor.size() % 2 == 0 && fc::from_hex( cursor, data.data(), data.size() ) == data.size() );
+   Key key;
+   fc::datastream<const char*> ds( data.data(), data.size() );
+   fc::raw::unpack( ds, key );
+   return key;
+} FC_CAPTURE_AND_RETHROW( (cursor) ) }
+
+/**
+ *  The required_approval_index maps every account and content that a proposal involves to it.
+ *  The lookups narrow that down to what they have always returned: get_accounts lists the
+ *  proposals that need the account's own authority, the proposal calls those that need it or
+ *  its content's, or that it has approved, but not basic authority alone.
+ */
+static bool proposal_requires_account( const proposal_object& p, const string& name )
+{
+   return p.required_active_approvals.find( name ) != p.required_active_approvals.end()
+       || p.required_owner_approvals.find( name ) != p.required_owner_approvals.end()
+       || p.required_basic_approvals.find( name ) != p.required_basic_approvals.end();
+}
+
+static bool proposal_involves( const proposal_object& p, const string& id )
+{
+   return p.required_active_approvals.find( id ) != p.required_active_approvals.end()
+       || p.required_owner_approvals.find( id ) != p.required_owner_approvals.end()
+       || p.available_active_approvals.find( id ) != p.available_active_approvals.end()
+       || p.required_master_content_approvals.find( id ) != p.required_master_content_approvals.end()
+       || p.required_comp_content_approvals.find( id ) != p.required_comp_content_approvals.end();
+}
+
 class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 {
    public:
-      explicit database_api_impl( muse::chain::database& db );
+      explicit database_api_impl( muse::chain::database& db,
+                                  std::shared_ptr< api_read_thread_pool > read_threads = nullptr,
+                                  std::shared_ptr< subscription_manager > subscriptions = nullptr,
+                                  std::shared_ptr< response_cache > cache = nullptr,
+                                  std::shared_ptr< api_admission_control > admission = nullptr );
       ~database_api_impl();
 
+      /**
+       *  Runs a read-only query on the application's API read threads under the database
+       *  read lock, or inline when there are none.  The call is admitted and accounted under
+       *  the name method, size is the number of items it requests.
+       */
+      template< typename Lambda >
+      auto query( const char* method, uint32_t size, Lambda&& q )const -> decltype( q() )
+      {
+         api_admission_control::call_guard guard( _admission.get(), method, _budget.get(), size );
+         auto result = _read_threads ? _read_threads->run( std::forward< Lambda >( q ) ) : q();
+         guard.succeeded();
+         return result;
+      }
+
+      template< typename Lambda >
+      auto query( const char* method, Lambda&& q )const -> decltype( q() )
+      {
+         return query( method, 1, std::forward< Lambda >( q ) );
+      }
+
+      /**
+       *  Returns the result of compute() shared through the application's response cache, to be
+       *  used inside query().  immutable results do not depend on the head block.
+       */
+      template< typename T, typename Lambda >
+      T cached( const char* method, const std::string& params, bool immutable, Lambda&& compute )const
+      {
+         if( !_cache )
+            return compute();
+         return _cache->get< T >( method, params, immutable, std::forward< Lambda >( compute ) );
+      }
+
+      /** blocks up to the last irreversible one do not change anymore */
+      bool is_irreversible( uint32_t block_num )const
+      {
+         return block_num <= _db.get_dynamic_global_properties().last_irreversible_block_num;
+      }
+
       // Objects
       fc::variants get_objects(const vector<object_id_type>& ids)const;
+      vector< vector<char> > get_objects_raw(const vector<object_id_type>& ids)const;
 
       // Subscriptions
       void set_subscribe_callback( std::function<void(const variant&)> cb, bool clear_filter );
+      void subscribe_to_changes( const subscription_interests& interests );
       void set_pending_transaction_callback( std::function<void(const variant&)> cb );
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
       void cancel_all_subscriptions();
@@ -42,7 +130,10 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       // Blocks and transactions
       optional<block_header> get_block_header(uint32_t block_num)const;
       optional<signed_block> get_block(uint32_t block_num)const;
+      vector<signed_block> get_blocks(uint32_t start, uint32_t count)const;
+      vector< vector<char> > get_block_range_raw(uint32_t start, uint32_t count)const;
       vector<proposal_object> get_proposed_transactions( string id )const;
+      proposal_page list_proposed_transactions( string id, string cursor, uint32_t limit )const;
 
       // Globals
       fc::variant_object get_config()const;
@@ -71,9 +162,13 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       bool is_streaming_platform(string straming_platform)const;
       //content
       vector<report_object> get_reports_for_account(string consumer)const; 
+      report_page list_reports_for_account( string consumer, string cursor, uint32_t limit )const;
       vector<content_object> get_content_by_uploader(string author)const;
+      content_page list_content_by_uploader( string uploader, string cursor, uint32_t limit )const;
       optional<content_object>    get_content_by_url(string url)const;
+      vector< optional<content_object> > get_contents_by_urls( const vector<string>& urls )const;
       vector<content_object>  lookup_content(const string& start, uint32_t limit )const;
+      content_page list_content_by_title( string start, string cursor, uint32_t limit )const;
       //scoring
       uint64_t get_account_scoring( string account );
       uint64_t get_content_scoring( string content );
@@ -98,12 +193,17 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       // signal handlers
       void on_applied_block( const chain::signed_block& b );
 
-      mutable fc::bloom_filter                _subscribe_filter;
-      std::function<void(const fc::variant&)> _subscribe_callback;
+      std::shared_ptr< subscription_manager > _subscriptions;
+      subscription_manager::session_id        _subscription_session = 0;
       std::function<void(const fc::variant&)> _pending_trx_callback;
       std::function<void(const fc::variant&)> _block_applied_callback;
 
       muse::chain::database&                _db;
+      std::shared_ptr< api_read_thread_pool > _read_threads;
+      std::shared_ptr< response_cache >       _cache;
+      std::shared_ptr< api_admission_control > _admission;
+      /** the token bucket of this connection */
+      std::shared_ptr< api_admission_control::connection_budget > _budget;
 
       boost::signals2::scoped_connection       _block_applied_connection;
 
@@ -126,16 +226,36 @@ void database_api::set_subscribe_callback( std::function<void(const variant&)> c
 
 void database_api_impl::set_subscribe_callback( std::function<void(const variant&)> cb, bool clear_filter )
 {
-   _subscribe_callback = cb;
-   if( clear_filter || !cb )
+   if( !cb )
+   {
+      if( _subscriptions )
+         _subscriptions->remove_session( _subscription_session );
+      _subscription_session = 0;
+      return;
+   }
+
+   // an api created without an application has no shared manager
+   if( !_subscriptions )
+      _subscriptions = std::make_shared< subscription_manager >( _db );
+   if( _subscription_session == 0 )
    {
-      static fc::bloom_parameters param;
-      param.projected_element_count    = 10000;
-      param.false_positive_probability = 1.0/10000;
-      param.maximum_size = 1024*8*8*2;
-      param.compute_optimal_parameters();
-      _subscribe_filter = fc::bloom_filter(param);
+      _subscription_session = _subscriptions->add_session( cb );
+      return;
    }
+   _subscriptions->set_callback( _subscription_session, cb );
+   if( clear_filter )
+      _subscriptions->clear_interests( _subscription_session );
+}
+
+void database_api::subscribe_to_changes( const subscription_interests& interests )
+{
+   my->subscribe_to_changes( interests );
+}
+
+void database_api_impl::subscribe_to_changes( const subscription_interests& interests )
+{
+   FC_ASSERT( _subscription_session != 0, "set_subscribe_callback must be called first" );
+   _subscriptions->subscribe( _subscription_session, interests );
 }
 
 void database_api::set_pending_transaction_callback( std::function<void(const variant&)> cb )
@@ -157,7 +277,10 @@ void database_api_impl::on_applied_block( const chain::signed_block& b )
 {
    try
    {
-      _block_applied_callback( fc::variant( signed_block_header(b), GRAPHENE_MAX_NESTED_OBJECTS ) );
+      if( _cache )
+         _block_applied_callback( _cache->applied_block_header( b ) );
+      else
+         _block_applied_callback( fc::variant( signed_block_header(b), GRAPHENE_MAX_NESTED_OBJECTS ) );
    }
    catch( ... )
    {
@@ -188,21 +311,32 @@ void database_api_impl::cancel_all_subscriptions()
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-database_api::database_api( muse::chain::database& db )
-   : my( new database_api_impl( db ) ) {}
+database_api::database_api( muse::chain::database& db, std::shared_ptr< api_read_thread_pool > read_threads )
+   : my( new database_api_impl( db, std::move( read_threads ) ) ) {}
 
 database_api::database_api( const muse::app::api_context& ctx )
-   : database_api( *ctx.app.chain_database() ) {}
+   : my( new database_api_impl( *ctx.app.chain_database(), ctx.app.get_api_read_thread_pool(),
+                                ctx.app.get_subscription_manager(), ctx.app.get_response_cache(),
+                                ctx.app.get_api_admission_control() ) ) {}
 
 database_api::~database_api() {}
 
-database_api_impl::database_api_impl( muse::chain::database& db ):_db(db)
+database_api_impl::database_api_impl( muse::chain::database& db, std::shared_ptr< api_read_thread_pool > read_threads,
+                                      std::shared_ptr< subscription_manager > subscriptions,
+                                      std::shared_ptr< response_cache > cache,
+                                      std::shared_ptr< api_admission_control > admission )
+   : _subscriptions( std::move( subscriptions ) ), _db(db), _read_threads( std::move( read_threads ) ),
+     _cache( std::move( cache ) ), _admission( std::move( admission ) )
 {
+   if( _admission )
+      _budget = _admission->open_connection();
    ilog("creating database api ${x}", ("x",int64_t(this)) );
 }
 
 database_api_impl::~database_api_impl()
 {
+   if( _subscriptions )
+      _subscriptions->remove_session( _subscription_session );
    ilog("freeing database api ${x}", ("x",int64_t(this)) );
 }
 
@@ -216,7 +350,11 @@ void database_api::on_api_startup() {}
 
 optional<block_header> database_api::get_block_header(uint32_t block_num)const
 {
-   return my->get_block_header( block_num );
+   return my->query( __FUNCTION__, [&]() {
+      return my->cached< optional<block_header> >( "get_block_header", std::to_string( block_num ),
+                                                   my->is_irreversible( block_num ),
+                                                   [&]() { return my->get_block_header( block_num ); } );
+   } );
 }
 
 optional<block_header> database_api_impl::get_block_header(uint32_t block_num) const
@@ -229,7 +367,11 @@ optional<block_header> database_api_impl::get_block_header(uint32_t block_num) c
 
 optional<signed_block> database_api::get_block(uint32_t block_num)const
 {
-   return my->get_block( block_num );
+   return my->query( __FUNCTION__, [&]() {
+      return my->cached< optional<signed_block> >( "get_block", std::to_string( block_num ),
+                                                   my->is_irreversible( block_num ),
+                                                   [&]() { return my->get_block( block_num ); } );
+   } );
 }
 
 optional<signed_block> database_api_impl::get_block(uint32_t block_num)const
@@ -237,6 +379,32 @@ optional<signed_block> database_api_impl::get_block(uint32_t block_num)const
    return _db.fetch_block_by_number(block_num);
 }
 
+vector<signed_block> database_api::get_blocks(uint32_t start, uint32_t count)const
+{
+   return my->query( __FUNCTION__, count, [&]() { return my->get_blocks( start, count ); } );
+}
+
+vector<signed_block> database_api_impl::get_blocks(uint32_t start, uint32_t count)const
+{
+   vector< vector<char> > packed = get_block_range_raw( start, count );
+   vector<signed_block> result;
+   result.reserve( packed.size() );
+   for( const vector<char>& data : packed )
+      result.push_back( fc::raw::unpack_from_vector<signed_block>( data ) );
+   return result;
+}
+
+vector< vector<char> > database_api::get_block_range_raw(uint32_t start, uint32_t count)const
+{
+   return my->query( __FUNCTION__, count, [&]() { return my->get_block_range_raw( start, count ); } );
+}
+
+vector< vector<char> > database_api_impl::get_block_range_raw(uint32_t start, uint32_t count)const
+{
+   FC_ASSERT( count <= 1000 );
+   return _db.fetch_block_range_packed( start, count );
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Globals                                                          //
@@ -255,20 +423,20 @@ fc::variant_object database_api_impl::get_config()const
 
 dynamic_global_property_object database_api::get_dynamic_global_properties()const
 {
-   return my->get_dynamic_global_properties();
+   return my->query( __FUNCTION__, [&]() { return my->get_dynamic_global_properties(); } );
 }
 
 chain_properties database_api::get_chain_properties()const
 {
-   return my->_db.get_witness_schedule_object().median_props;
+   return my->query( __FUNCTION__, [&]() { return my->_db.get_witness_schedule_object().median_props; } );
 }
 
 feed_history_object database_api::get_feed_history()const {
-   return my->_db.get_feed_history();
+   return my->query( __FUNCTION__, [&]() { return my->_db.get_feed_history(); } );
 }
 
 price database_api::get_current_median_history_price()const {
-   return my->_db.get_feed_history().current_median_history;
+   return my->query( __FUNCTION__, [&]() { return my->_db.get_feed_history().current_median_history; } );
 }
 
 dynamic_global_property_object database_api_impl::get_dynamic_global_properties()const
@@ -278,21 +446,24 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
 
 witness_schedule_object database_api::get_witness_schedule()const
 {
-   return witness_schedule_id_type()( my->_db );
+   return my->query( __FUNCTION__, [&]() { return witness_schedule_id_type()( my->_db ); } );
 }
 
 hardfork_version database_api::get_hardfork_version()const
 {
-   return hardfork_property_id_type()( my->_db ).current_hardfork_version;
+   return my->query( __FUNCTION__, [&]() { return hardfork_property_id_type()( my->_db ).current_hardfork_version; } );
 }
 
 scheduled_hardfork database_api::get_next_scheduled_hardfork() const
 {
-   scheduled_hardfork shf;
-   const auto& hpo = hardfork_property_id_type()( my->_db );
-   shf.hf_version = hpo.next_hardfork;
-   shf.live_time = hpo.next_hardfork_time;
-   return shf;
+   return my->query( __FUNCTION__, [&]() -> scheduled_hardfork
+   {
+      scheduled_hardfork shf;
+      const auto& hpo = hardfork_property_id_type()( my->_db );
+      shf.hf_version = hpo.next_hardfork;
+      shf.live_time = hpo.next_hardfork_time;
+      return shf;
+   } );
 }
 
 
@@ -304,7 +475,7 @@ scheduled_hardfork database_api::get_next_scheduled_hardfork() const
 
 fc::variants database_api::get_objects(const vector<object_id_type>& ids)const
 {
-   return my->get_objects( ids );
+   return my->query( __FUNCTION__, ids.size(), [&]() { return my->get_objects( ids ); } );
 }
 
 fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)const
@@ -322,6 +493,24 @@ fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)co
    return result;
 }
 
+vector< vector<char> > database_api::get_objects_raw(const vector<object_id_type>& ids)const
+{
+   return my->query( __FUNCTION__, ids.size(), [&]() { return my->get_objects_raw( ids ); } );
+}
+
+vector< vector<char> > database_api_impl::get_objects_raw(const vector<object_id_type>& ids)const
+{
+   FC_ASSERT( ids.size() <= 1000 );
+   vector< vector<char> > result;
+   result.reserve( ids.size() );
+   for( const object_id_type& id : ids )
+   {
+      const graphene::db::object* obj = _db.find_object( id );
+      result.push_back( obj ? obj->pack() : vector<char>() );
+   }
+   return result;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Keys                                                             //
@@ -330,7 +519,7 @@ fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)co
 
 vector<set<string>> database_api::get_key_references( vector<public_key_type> key )const
 {
-   return my->get_key_references( key );
+   return my->query( __FUNCTION__, key.size(), [&]() { return my->get_key_references( key ); } );
 }
 
 /**
@@ -368,12 +557,12 @@ vector<set<string>> database_api_impl::get_key_references( vector<public_key_typ
 
 vector< extended_account > database_api::get_accounts( const vector< string >& names )const
 {
-   return my->get_accounts( names );
+   return my->query( __FUNCTION__, names.size(), [&]() { return my->get_accounts( names ); } );
 }
 
 optional < account_object > database_api::get_account_from_id( account_id_type account_id ) const
 {
-   return my->get_account_from_id(account_id);
+   return my->query( __FUNCTION__, [&]() { return my->get_account_from_id(account_id); } );
 }
 
 vector< extended_account > database_api_impl::get_accounts( const vector< string >& names )const
@@ -401,10 +590,14 @@ vector< extended_account > database_api_impl::get_accounts( const vector< string
          ++vitr;
       }
 
-      const set<proposal_id_type> proposals = proposals_by_account.lookup( name );
+      const set<proposal_id_type>& proposals = proposals_by_account.lookup( name );
       results.back().proposals.reserve( proposals.size() );
       for( const auto proposal_id : proposals )
-         results.back().proposals.push_back( proposal_id(_db) );
+      {
+         const proposal_object& p = proposal_id(_db);
+         if( proposal_requires_account( p, name ) )
+            results.back().proposals.push_back( p );
+      }
    }
 
    return results;
@@ -420,7 +613,7 @@ optional < account_object > database_api_impl::get_account_from_id( account_id_t
 
 vector<account_id_type> database_api::get_account_references( account_id_type account_id )const
 {
-   return my->get_account_references( account_id );
+   return my->query( __FUNCTION__, [&]() { return my->get_account_references( account_id ); } );
 }
 
 vector<account_id_type> database_api_impl::get_account_references( account_id_type account_id )const
@@ -441,7 +634,7 @@ vector<account_id_type> database_api_impl::get_account_references( account_id_ty
 }
 
 vector <account_balance_object> database_api::get_uia_balances( string account ){
-   return my->get_uia_balances(account);
+   return my->query( __FUNCTION__, [&]() { return my->get_uia_balances(account); } );
 }
 
 vector <account_balance_object> database_api_impl::get_uia_balances( string account ){
@@ -462,7 +655,7 @@ vector <account_balance_object> database_api_impl::get_uia_balances( string acco
 
 vector<optional<account_object>> database_api::lookup_account_names(const vector<string>& account_names)const
 {
-   return my->lookup_account_names( account_names );
+   return my->query( __FUNCTION__, account_names.size(), [&]() { return my->lookup_account_names( account_names ); } );
 }
 
 vector<optional<account_object>> database_api_impl::lookup_account_names(const vector<string>& account_names)const
@@ -480,7 +673,7 @@ vector<optional<account_object>> database_api_impl::lookup_account_names(const v
 
 set<string> database_api::lookup_accounts(const string& lower_bound_name, uint32_t limit)const
 {
-   return my->lookup_accounts( lower_bound_name, limit );
+   return my->query( __FUNCTION__, limit, [&]() { return my->lookup_accounts( lower_bound_name, limit ); } );
 }
 
 set<string> database_api_impl::lookup_accounts(const string& lower_bound_name, uint32_t limit)const
@@ -501,7 +694,7 @@ set<string> database_api_impl::lookup_accounts(const string& lower_bound_name, u
 
 uint64_t database_api::get_account_count()const
 {
-   return my->get_account_count();
+   return my->query( __FUNCTION__, [&]() { return my->get_account_count(); } );
 }
 
 uint64_t database_api_impl::get_account_count()const
@@ -511,31 +704,37 @@ uint64_t database_api_impl::get_account_count()const
 
 vector< owner_authority_history_object > database_api::get_owner_history( string account )const
 {
-   vector< owner_authority_history_object > results;
+   return my->query( __FUNCTION__, [&]() -> vector< owner_authority_history_object >
+   {
+      vector< owner_authority_history_object > results;
 
-   const auto& hist_idx = my->_db.get_index_type< owner_authority_history_index >().indices().get< by_account >();
-   auto itr = hist_idx.lower_bound( account );
+      const auto& hist_idx = my->_db.get_index_type< owner_authority_history_index >().indices().get< by_account >();
+      auto itr = hist_idx.lower_bound( account );
 
-   while( itr != hist_idx.end() && itr->account == account )
-   {
-      results.push_back( *itr );
-      ++itr;
-   }
+      while( itr != hist_idx.end() && itr->account == account )
+      {
+         results.push_back( *itr );
+         ++itr;
+      }
 
-   return results;
+      return results;
+   } );
 }
 
 optional< account_recovery_request_object > database_api::get_recovery_request( string account )const
 {
-   optional< account_recovery_request_object > result;
+   return my->query( __FUNCTION__, [&]() -> optional< account_recovery_request_object >
+   {
+      optional< account_recovery_request_object > result;
 
-   const auto& rec_idx = my->_db.get_index_type< account_recovery_request_index >().indices().get< by_account >();
-   auto req = rec_idx.find( account );
+      const auto& rec_idx = my->_db.get_index_type< account_recovery_request_index >().indices().get< by_account >();
+      auto req = rec_idx.find( account );
 
-   if( req != rec_idx.end() )
-      result = *req;
+      if( req != rec_idx.end() )
+         result = *req;
 
-   return result;
+      return result;
+   } );
 }
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
@@ -545,29 +744,50 @@ optional< account_recovery_request_object > database_api::get_recovery_request(
 
 vector<proposal_object> database_api::get_proposed_transactions( string id )const
 {
-   return my->get_proposed_transactions( id );
+   return my->query( __FUNCTION__, [&]() { return my->get_proposed_transactions( id ); } );
 }
 
-/** TODO: add secondary index that will accelerate this process */
 vector<proposal_object> database_api_impl::get_proposed_transactions( string id )const
 {
-   const auto& idx = _db.get_index_type<proposal_index>();
+   const auto& pidx = _db.get_index_type<proposal_index>();
+   const auto& proposals_by_account = pidx.get_secondary_index<muse::chain::required_approval_index>();
+   const auto& ids = proposals_by_account.lookup( id );
    vector<proposal_object> result;
-   
-   idx.inspect_all_objects( [&](const object& obj){
-           const proposal_object& p = static_cast<const proposal_object&>(obj);
-           //result.push_back(p);
-           if( p.required_active_approvals.find( id ) != p.required_active_approvals.end() )
-              result.push_back(p);
-           else if ( p.required_owner_approvals.find( id ) != p.required_owner_approvals.end() )
-              result.push_back(p);
-           else if ( p.available_active_approvals.find( id ) != p.available_active_approvals.end() )
-              result.push_back(p);
-           else if ( p.required_master_content_approvals.find( id ) != p.required_master_content_approvals.end() )
-              result.push_back(p);
-           else if ( p.required_comp_content_approvals.find( id ) != p.required_comp_content_approvals.end() )
-              result.push_back(p);
-   });
+   result.reserve( ids.size() );
+   for( const proposal_id_type& pid : ids )
+   {
+      const proposal_object& p = pid(_db);
+      if( proposal_involves( p, id ) )
+         result.push_back( p );
+   }
+   return result;
+}
+
+proposal_page database_api::list_proposed_transactions( string id, string cursor, uint32_t limit )const
+{
+   return my->query( __FUNCTION__, limit, [&]() { return my->list_proposed_transactions( id, cursor, limit ); } );
+}
+
+proposal_page database_api_impl::list_proposed_transactions( string id, string cursor, uint32_t limit )const
+{
+   FC_ASSERT( limit <= 1000 );
+   const auto& pidx = _db.get_index_type<proposal_index>();
+   const auto& ids = pidx.get_secondary_index<muse::chain::required_approval_index>().lookup( id );
+
+   auto itr = cursor.empty() ? ids.begin() : ids.lower_bound( decode_cursor<proposal_id_type>( cursor ) );
+   proposal_page result;
+   result.items.reserve( std::min<size_t>( limit, ids.size() ) );
+   for( ; itr != ids.end(); ++itr )
+   {
+      const proposal_object& p = (*itr)(_db);
+      if( !proposal_involves( p, id ) )
+         continue;
+      if( result.items.size() == limit )
+         break;
+      result.items.push_back( p );
+   }
+   if( itr != ids.end() )
+      result.next_cursor = encode_cursor( *itr );
    return result;
 }
 
@@ -579,7 +799,7 @@ vector<proposal_object> database_api_impl::get_proposed_transactions( string id
 
 uint64_t database_api::get_account_scoring( string account )
 {
-   return my->get_account_scoring(account);
+   return my->query( __FUNCTION__, [&]() { return my->get_account_scoring(account); } );
 }
 
 uint64_t database_api_impl::get_account_scoring( string account )
@@ -602,7 +822,7 @@ uint64_t database_api_impl::get_account_scoring( string account )
 
 uint64_t database_api::get_content_scoring( string content )
 {
-   return my->get_content_scoring(content);
+   return my->query( __FUNCTION__, [&]() { return my->get_content_scoring(content); } );
 }
 
 uint64_t database_api_impl::get_content_scoring( string content )
@@ -622,7 +842,7 @@ uint64_t database_api_impl::get_content_scoring( string content )
 
 vector<optional<witness_object>> database_api::get_witnesses(const vector<witness_id_type>& witness_ids)const
 {
-   return my->get_witnesses( witness_ids );
+   return my->query( __FUNCTION__, witness_ids.size(), [&]() { return my->get_witnesses( witness_ids ); } );
 }
 
 vector<optional<witness_object>> database_api_impl::get_witnesses(const vector<witness_id_type>& witness_ids)const
@@ -639,34 +859,37 @@ vector<optional<witness_object>> database_api_impl::get_witnesses(const vector<w
 
 fc::optional<witness_object> database_api::get_witness_by_account( string account_name ) const
 {
-   return my->get_witness_by_account( account_name );
+   return my->query( __FUNCTION__, [&]() { return my->get_witness_by_account( account_name ); } );
 }
 
 vector< witness_object > database_api::get_witnesses_by_vote( string from, uint32_t limit )const
 {
-   FC_ASSERT( limit <= 100 );
+   return my->query( __FUNCTION__, limit, [&]() -> vector< witness_object >
+   {
+      FC_ASSERT( limit <= 100 );
 
-   vector<witness_object> result;
-   result.reserve(limit);
+      vector<witness_object> result;
+      result.reserve(limit);
 
-   const auto& name_idx = my->_db.get_index_type< witness_index >().indices().get< by_name >();
-   const auto& vote_idx = my->_db.get_index_type< witness_index >().indices().get< by_vote_name >();
+      const auto& name_idx = my->_db.get_index_type< witness_index >().indices().get< by_name >();
+      const auto& vote_idx = my->_db.get_index_type< witness_index >().indices().get< by_vote_name >();
 
-   auto itr = vote_idx.begin();
-   if( from.size() ) {
-      auto nameitr = name_idx.find( from );
-      FC_ASSERT( nameitr != name_idx.end(), "invalid witness name ${n}", ("n",from) );
-      itr = vote_idx.iterator_to( *nameitr );
-   }
+      auto itr = vote_idx.begin();
+      if( from.size() ) {
+         auto nameitr = name_idx.find( from );
+         FC_ASSERT( nameitr != name_idx.end(), "invalid witness name ${n}", ("n",from) );
+         itr = vote_idx.iterator_to( *nameitr );
+      }
 
-   while( itr != vote_idx.end()  &&
-          result.size() < limit &&
-          itr->votes > 0 )
-   {
-      result.push_back(*itr);
-      ++itr;
-   }
-   return result;
+      while( itr != vote_idx.end()  &&
+             result.size() < limit &&
+             itr->votes > 0 )
+      {
+         result.push_back(*itr);
+         ++itr;
+      }
+      return result;
+   } );
 }
 
 fc::optional<witness_object> database_api_impl::get_witness_by_account( string account_name ) const
@@ -680,17 +903,17 @@ fc::optional<witness_object> database_api_impl::get_witness_by_account( string a
 
 set< string > database_api::lookup_witness_accounts( const string& lower_bound_name, uint32_t limit ) const
 {
-   return my->lookup_witness_accounts( lower_bound_name, limit );
+   return my->query( __FUNCTION__, limit, [&]() { return my->lookup_witness_accounts( lower_bound_name, limit ); } );
 }
 
 set< string > database_api::lookup_streaming_platform_accounts( const string& lower_bound_name, uint32_t limit ) const
 {
-   return my->lookup_streaming_platform_accounts( lower_bound_name, limit );
+   return my->query( __FUNCTION__, limit, [&]() { return my->lookup_streaming_platform_accounts( lower_bound_name, limit ); } );
 }
 
 bool database_api::is_streaming_platform( string streaming_platform ) const
 {
-   return my->is_streaming_platform( streaming_platform );
+   return my->query( __FUNCTION__, [&]() { return my->is_streaming_platform( streaming_platform ); } );
 }
 
 set< string > database_api_impl::lookup_witness_accounts( const string& lower_bound_name, uint32_t limit ) const
@@ -740,7 +963,7 @@ bool database_api_impl::is_streaming_platform(string streaming_platform) const
 
 uint64_t database_api::get_witness_count()const
 {
-   return my->get_witness_count();
+   return my->query( __FUNCTION__, [&]() { return my->get_witness_count(); } );
 }
 
 uint64_t database_api_impl::get_witness_count()const
@@ -750,46 +973,98 @@ uint64_t database_api_impl::get_witness_count()const
 
 vector<report_object> database_api::get_reports_for_account(string consumer)const
 {
-   return my->get_reports_for_account(consumer);
+   return my->query( __FUNCTION__, [&]() { return my->get_reports_for_account(consumer); } );
 }
 
 vector<report_object> database_api_impl::get_reports_for_account(string consumer)const
 {
+   return list_reports_for_account( consumer, string(), 1000 ).items;
+}
+
+report_page database_api::list_reports_for_account( string consumer, string cursor, uint32_t limit )const
+{
+   return my->query( __FUNCTION__, limit, [&]() { return my->list_reports_for_account( consumer, cursor, limit ); } );
+}
+
+report_page database_api_impl::list_reports_for_account( string consumer, string cursor, uint32_t limit )const
+{
+   FC_ASSERT( limit <= 1000 );
    const auto& idx= _db.get_index_type< report_index >().indices().get< by_consumer>();
-   vector <report_object> result;
    account_id_type c=_db.get_account(consumer).id;
 
-   auto itr = idx.lower_bound( c );
-   while( itr != idx.end() && itr->consumer == c && result.size() < 1000 )
+   auto itr = cursor.empty() ? idx.lower_bound( c )
+                             : idx.lower_bound( boost::make_tuple( c, decode_cursor<object_id_type>( cursor ) ) );
+   report_page result;
+   result.items.reserve( limit );
+   while( itr != idx.end() && itr->consumer == c && result.items.size() < limit )
    {
-      result.push_back (*itr);
+      result.items.push_back (*itr);
       ++itr;
    }
+   if( itr != idx.end() && itr->consumer == c )
+      result.next_cursor = encode_cursor( itr->id );
    return result;
 }
 
 vector<content_object> database_api::get_content_by_uploader(string author)const
 {
-   return my->get_content_by_uploader(author);
+   return my->query( __FUNCTION__, [&]() { return my->get_content_by_uploader(author); } );
 }
 
 vector<content_object> database_api_impl::get_content_by_uploader(string uploader)const
 {
+   return list_content_by_uploader( uploader, string(), 1000 ).items;
+}
+
+content_page database_api::list_content_by_uploader( string author, string cursor, uint32_t limit )const
+{
+   return my->query( __FUNCTION__, limit, [&]() { return my->list_content_by_uploader( author, cursor, limit ); } );
+}
+
+content_page database_api_impl::list_content_by_uploader( string uploader, string cursor, uint32_t limit )const
+{
+   FC_ASSERT( limit <= 1000 );
    const auto& idx= _db.get_index_type<content_index>().indices().get< by_uploader_url >();
-   vector <content_object> result;
-    
-   auto itr = idx.lower_bound( std::make_tuple( uploader, "") );
-   while( itr != idx.end() && itr->uploader == uploader && result.size() < 1000 )
+   string start_url = cursor.empty() ? string() : decode_cursor<string>( cursor );
+
+   auto itr = idx.lower_bound( boost::make_tuple( uploader, start_url ) );
+   content_page result;
+   result.items.reserve( limit );
+   while( itr != idx.end() && itr->uploader == uploader && result.items.size() < limit )
    {
-      result.push_back (*itr);
+      result.items.push_back (*itr);
       ++itr;
    }
+   if( itr != idx.end() && itr->uploader == uploader )
+      result.next_cursor = encode_cursor( itr->url );
    return result;
 }
 
 optional<content_object> database_api::get_content_by_url(string url)const
 {
-   return my->get_content_by_url(url);
+   return my->query( __FUNCTION__, [&]() { return my->get_content_by_url(url); } );
+}
+
+vector< optional<content_object> > database_api::get_contents_by_urls( const vector<string>& urls )const
+{
+   return my->query( __FUNCTION__, urls.size(), [&]() { return my->get_contents_by_urls( urls ); } );
+}
+
+vector< optional<content_object> > database_api_impl::get_contents_by_urls( const vector<string>& urls )const
+{
+   FC_ASSERT( urls.size() <= 1000 );
+   const auto& idx = _db.get_index_type< content_index >().indices().get< by_url >();
+   vector< optional<content_object> > result;
+   result.reserve( urls.size() );
+   for( const string& url : urls )
+   {
+      auto itr = idx.find( url );
+      if( itr != idx.end() )
+         result.emplace_back( *itr );
+      else
+         result.emplace_back();
+   }
+   return result;
 }
 
 optional<content_object> database_api_impl::get_content_by_url(string url)const
@@ -808,14 +1083,14 @@ optional<content_object> database_api_impl::get_content_by_url(string url)const
 
 vector<content_object>  database_api::lookup_content(const string& start, uint32_t limit )const
 {
-   return my->lookup_content(start, limit);
+   return my->query( __FUNCTION__, limit, [&]() { return my->lookup_content(start, limit); } );
 }
 
 vector<content_object>  database_api_impl::lookup_content(const string& start, uint32_t limit )const
 {
    vector <content_object> result;
    const auto& idx = _db.get_index_type<content_index>().indices().get<by_title>();
-   auto itr = idx.lower_bound( start );
+   auto itr = idx.lower_bound( boost::make_tuple( start ) );
    while( itr!=idx.end() && result.size() < limit && itr->track_title.compare( 0, start.size(), start ) == 0 )
    {
       result.push_back( *itr );
@@ -824,6 +1099,36 @@ vector<content_object>  database_api_impl::lookup_content(const string& start, u
    return result;
 }
 
+content_page database_api::list_content_by_title( string start, string cursor, uint32_t limit )const
+{
+   return my->query( __FUNCTION__, limit, [&]() { return my->list_content_by_title( start, cursor, limit ); } );
+}
+
+content_page database_api_impl::list_content_by_title( string start, string cursor, uint32_t limit )const
+{
+   FC_ASSERT( limit <= 1000 );
+   const auto& idx = _db.get_index_type<content_index>().indices().get<by_title>();
+   auto itr = idx.lower_bound( boost::make_tuple( start ) );
+   if( !cursor.empty() )
+   {
+      auto position = decode_cursor< std::pair< string, object_id_type > >( cursor );
+      FC_ASSERT( position.first.compare( 0, start.size(), start ) == 0, "Cursor does not belong to this query" );
+      itr = idx.lower_bound( boost::make_tuple( position.first, position.second ) );
+   }
+   auto matches = [&start]( const content_object& c ) { return c.track_title.compare( 0, start.size(), start ) == 0; };
+
+   content_page result;
+   result.items.reserve( limit );
+   while( itr != idx.end() && result.items.size() < limit && matches( *itr ) )
+   {
+      result.items.push_back( *itr );
+      ++itr;
+   }
+   if( itr != idx.end() && matches( *itr ) )
+      result.next_cursor = encode_cursor( std::make_pair( itr->track_title, itr->id ) );
+   return result;
+}
+
 
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
@@ -833,23 +1138,29 @@ vector<content_object>  database_api_impl::lookup_content(const string& start, u
 
 order_book database_api::get_order_book( uint32_t limit )const
 {
-   return my->get_order_book( limit );
+   return my->query( __FUNCTION__, limit, [&]() {
+      return my->cached< order_book >( "get_order_book", std::to_string( limit ), false,
+                                       [&]() { return my->get_order_book( limit ); } );
+   } );
 }
 
 vector<extended_limit_order> database_api::get_open_orders( string owner )const {
-   vector<extended_limit_order> result;
-   const auto& idx = my->_db.get_index_type<limit_order_index>().indices().get<by_account>();
-   auto itr = idx.lower_bound( owner );
-   while( itr != idx.end() && itr->seller == owner ) {
-      result.push_back( *itr );
-
-      if( itr->sell_price.base.asset_id == MUSE_SYMBOL )
-         result.back().real_price = (result.back().sell_price).to_real();
-      else
-         result.back().real_price = (~result.back().sell_price).to_real();
-      ++itr;
-   }
-   return result;
+   return my->query( __FUNCTION__, [&]() -> vector<extended_limit_order>
+   {
+      vector<extended_limit_order> result;
+      const auto& idx = my->_db.get_index_type<limit_order_index>().indices().get<by_account>();
+      auto itr = idx.lower_bound( owner );
+      while( itr != idx.end() && itr->seller == owner ) {
+         result.push_back( *itr );
+
+         if( itr->sell_price.base.asset_id == MUSE_SYMBOL )
+            result.back().real_price = (result.back().sell_price).to_real();
+         else
+            result.back().real_price = (~result.back().sell_price).to_real();
+         ++itr;
+      }
+      return result;
+   } );
 }
 
 order_book database_api_impl::get_order_book( uint32_t limit )const
@@ -895,7 +1206,11 @@ order_book database_api_impl::get_order_book( uint32_t limit )const
 
 order_book database_api::get_order_book_for_asset( asset_id_type asset_id, uint32_t limit )const
 {
-   return my->get_order_book_for_asset( asset_id, limit ); 
+   return my->query( __FUNCTION__, limit, [&]() {
+      return my->cached< order_book >( "get_order_book_for_asset",
+                                       std::to_string( asset_id.instance.value ) + ',' + std::to_string( limit ), false,
+                                       [&]() { return my->get_order_book_for_asset( asset_id, limit ); } );
+   } );
 }
 order_book database_api_impl::get_order_book_for_asset( asset_id_type asset_id, uint32_t limit )const
 { 
@@ -943,7 +1258,7 @@ order_book database_api_impl::get_order_book_for_asset( asset_id_type asset_id,
 
 vector< liquidity_balance > database_api::get_liquidity_queue( string start_account, uint32_t limit )const
 {
-   return my->get_liquidity_queue( start_account, limit );
+   return my->query( __FUNCTION__, limit, [&]() { return my->get_liquidity_queue( start_account, limit ); } );
 }
 
 vector< liquidity_balance > database_api_impl::get_liquidity_queue( string start_account, uint32_t limit )const
@@ -992,17 +1307,17 @@ vector< liquidity_balance > database_api_impl::get_liquidity_queue( string start
 
 vector<asset_object> database_api::lookup_uias(uint64_t start_id)const
 {
-   return my->lookup_uias(start_id);
+   return my->query( __FUNCTION__, [&]() { return my->lookup_uias(start_id); } );
 }
 
 optional<asset_object> database_api::get_uia_details(string UIA)const
 {
-   return my->get_uia_details(UIA);
+   return my->query( __FUNCTION__, [&]() { return my->get_uia_details(UIA); } );
 }
 
 asset_object database_api::get_asset(asset_id_type asset_id)const
 {
-   return my->get_asset(asset_id);
+   return my->query( __FUNCTION__, [&]() { return my->get_asset(asset_id); } );
 }
 
 vector<asset_object> database_api_impl::lookup_uias(uint64_t start_id )const
@@ -1052,7 +1367,7 @@ std::string database_api_impl::get_transaction_hex(const signed_transaction& trx
 
 set<public_key_type> database_api::get_required_signatures( const signed_transaction& trx, const flat_set<public_key_type>& available_keys )const
 {
-   return my->get_required_signatures( trx, available_keys );
+   return my->query( __FUNCTION__, [&]() { return my->get_required_signatures( trx, available_keys ); } );
 }
 
 set<public_key_type> database_api_impl::get_required_signatures( const signed_transaction& trx, const flat_set<public_key_type>& available_keys )const
@@ -1070,7 +1385,7 @@ set<public_key_type> database_api_impl::get_required_signatures( const signed_tr
 
 set<public_key_type> database_api::get_potential_signatures( const signed_transaction& trx )const
 {
-   return my->get_potential_signatures( trx );
+   return my->query( __FUNCTION__, [&]() { return my->get_potential_signatures( trx ); } );
 }
 
 set<public_key_type> database_api_impl::get_potential_signatures( const signed_transaction& trx )const
@@ -1122,7 +1437,7 @@ set<public_key_type> database_api_impl::get_potential_signatures( const signed_t
 
 bool database_api::verify_authority( const signed_transaction& trx ) const
 {
-   return my->verify_authority( trx );
+   return my->query( __FUNCTION__, [&]() { return my->verify_authority( trx ); } );
 }
 
 bool database_api_impl::verify_authority( const signed_transaction& trx )const
@@ -1139,7 +1454,7 @@ bool database_api_impl::verify_authority( const signed_transaction& trx )const
 
 bool database_api::verify_account_authority( const string& name_or_id, const flat_set<public_key_type>& signers )const
 {
-   return my->verify_account_authority( name_or_id, signers );
+   return my->query( __FUNCTION__, [&]() { return my->verify_account_authority( name_or_id, signers ); } );
 }
 
 bool database_api_impl::verify_account_authority( const string& name_or_id, const flat_set<public_key_type>& keys )const
@@ -1168,14 +1483,17 @@ bool database_api_impl::verify_account_authority( const string& name_or_id, cons
 }
 
 vector<convert_request_object> database_api::get_conversion_requests( const string& account )const {
-  const auto& idx = my->_db.get_index_type<convert_index>().indices().get<by_owner>();
-  vector<convert_request_object> result;
-  auto itr = idx.lower_bound(account);
-  while( itr != idx.end() && itr->owner == account ) {
-     result.push_back(*itr);
-     ++itr;
-  }
-  return result;
+   return my->query( __FUNCTION__, [&]() -> vector<convert_request_object>
+   {
+      const auto& idx = my->_db.get_index_type<convert_index>().indices().get<by_owner>();
+      vector<convert_request_object> result;
+      auto itr = idx.lower_bound(account);
+      while( itr != idx.end() && itr->owner == account ) {
+         result.push_back(*itr);
+         ++itr;
+      }
+      return result;
+   } );
 }
 
 
@@ -1190,29 +1508,52 @@ u256 to256( const fc::uint128& t ) {
 
 
 map<uint32_t,operation_object> database_api::get_account_history( string account, uint64_t from, uint32_t limit )const {
-   FC_ASSERT( limit <= 2000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
-   FC_ASSERT( from >= limit, "From must be greater than limit" );
-   const auto& idx = my->_db.get_index_type<account_history_index>().indices().get<by_account>();
-   auto itr = idx.lower_bound( boost::make_tuple( account, from ) );
-   auto end = idx.upper_bound( boost::make_tuple( account, std::max( int64_t(0), int64_t(itr->sequence)-limit ) ) );
-
-   map<uint32_t,operation_object> result;
-   while( itr != end ) {
-      result[itr->sequence] = itr->op(my->_db);
-      ++itr;
-   }
-   return result;
+   return my->query( __FUNCTION__, limit, [&]() -> map<uint32_t,operation_object>
+   {
+      FC_ASSERT( limit <= 2000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
+      FC_ASSERT( from >= limit, "From must be greater than limit" );
+      const auto& idx = my->_db.get_index_type<account_history_index>().indices().get<by_account>();
+      auto itr = idx.lower_bound( boost::make_tuple( account, from ) );
+      auto end = idx.upper_bound( boost::make_tuple( account, std::max( int64_t(0), int64_t(itr->sequence)-limit ) ) );
+
+      map<uint32_t,operation_object> result;
+      while( itr != end ) {
+         result[itr->sequence] = itr->op(my->_db);
+         ++itr;
+      }
+      return result;
+   } );
+}
+
+account_history_page database_api::list_account_history( string account, string cursor, uint32_t limit )const
+{
+   return my->query( __FUNCTION__, limit, [&]() -> account_history_page
+   {
+      FC_ASSERT( limit <= 2000, "Limit of ${l} is greater than maxmimum allowed", ("l",limit) );
+      const auto& idx = my->_db.get_index_type<account_history_index>().indices().get<by_account>();
+      auto itr = cursor.empty() ? idx.lower_bound( boost::make_tuple( account ) )
+                                : idx.lower_bound( boost::make_tuple( account, decode_cursor<uint32_t>( cursor ) ) );
+      account_history_page result;
+      for( ; itr != idx.end() && itr->account == account && result.items.size() < limit; ++itr )
+         result.items.emplace_back( itr->sequence, itr->op(my->_db) );
+      if( itr != idx.end() && itr->account == account )
+         result.next_cursor = encode_cursor( itr->sequence );
+      return result;
+   } );
 }
 
 
 
 vector<string> database_api::get_active_witnesses()const {
-   const auto& wso = my->_db.get_witness_schedule_object();
-   return wso.current_shuffled_witnesses;
+   return my->query( __FUNCTION__, [&]() -> vector<string>
+   {
+      const auto& wso = my->_db.get_witness_schedule_object();
+      return wso.current_shuffled_witnesses;
+   } );
 }
 
 vector<string> database_api::get_voted_streaming_platforms()const {
-   return my->_db.get_voted_streaming_platforms();
+   return my->query( __FUNCTION__, [&]() { return my->_db.get_voted_streaming_platforms(); } );
 }
 
 
@@ -1364,24 +1705,27 @@ vector<string> database_api::get_voted_streaming_platforms()const {
 }*/
 
 annotated_signed_transaction database_api::get_transaction( transaction_id_type id )const {
-   const auto& idx = my->_db.get_index_type<operation_index>().indices().get<by_transaction_id>();
-   auto itr = idx.lower_bound( id );
-   if( itr != idx.end() && itr->trx_id == id ) {
-      auto blk = my->_db.fetch_block_by_number( itr->block );
-      FC_ASSERT( blk.valid() );
-      FC_ASSERT( blk->transactions.size() > itr->trx_in_block );
-      annotated_signed_transaction result = blk->transactions[itr->trx_in_block];
-      result.block_num       = itr->block;
-      result.transaction_num = itr->trx_in_block;
-      return result;
-   }
-   FC_ASSERT( false, "Unknown Transaction ${t}", ("t",id));
+   return my->query( __FUNCTION__, [&]() -> annotated_signed_transaction
+   {
+      const auto& idx = my->_db.get_index_type<operation_index>().indices().get<by_transaction_id>();
+      auto itr = idx.lower_bound( id );
+      if( itr != idx.end() && itr->trx_id == id ) {
+         auto blk = my->_db.fetch_block_by_number( itr->block );
+         FC_ASSERT( blk.valid() );
+         FC_ASSERT( blk->transactions.size() > itr->trx_in_block );
+         annotated_signed_transaction result = blk->transactions[itr->trx_in_block];
+         result.block_num       = itr->block;
+         result.transaction_num = itr->trx_in_block;
+         return result;
+      }
+      FC_ASSERT( false, "Unknown Transaction ${t}", ("t",id));
+   } );
 }
 
 
 vector<balance_object> database_api::get_balance_objects( const vector<address>& addrs )const
 {
-   return my->get_balance_objects( addrs );
+   return my->query( __FUNCTION__, addrs.size(), [&]() { return my->get_balance_objects( addrs ); } );
 }
 
 vector<balance_object> database_api::get_balance_objects_by_key( const string& pubkey )const
@@ -1395,7 +1739,7 @@ vector<balance_object> database_api::get_balance_objects_by_key( const string& p
    addrs.push_back( pts_address( pk, true, 56 ) );
    addrs.push_back( pts_address( pk, false, 0 ) );
    addrs.push_back( pts_address( pk, true, 0 ) );
-   return my->get_balance_objects(addrs);
+   return my->query( __FUNCTION__, [&]() { return my->get_balance_objects(addrs); } );
 }
 
 vector<balance_object> database_api_impl::get_balance_objects( const vector<address>& addrs )const
@@ -0,0 +1,560 @@
+#include <muse/app/http_rpc_server.hpp>
+#include <muse/app/application.hpp>
+
+#include <graphene/net/config.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/rpc/api_connection.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <map>
+
+namespace muse { namespace app {
+
+namespace {
+
+   const size_t max_header_line_size = 8 * 1024;
+   const size_t max_header_count     = 100;
+   const size_t max_body_size        = 16 * 1024 * 1024;
+
+   /** receives the API calls of one HTTP connection, there is nothing to call back over HTTP */
+   class http_api_connection : public fc::api_connection
+   {
+      public:
+         http_api_connection() : fc::api_connection( GRAPHENE_NET_MAX_NESTED_OBJECTS ) {}
+
+         virtual fc::variant send_call( fc::api_id_type, std::string, fc::variants ) override
+         {
+            FC_THROW( "Calls to the client are not supported over HTTP" );
+         }
+         virtual fc::variant send_callback( uint64_t, fc::variants ) override
+         {
+            FC_THROW( "Callbacks are not supported over HTTP" );
+         }
+         virtual void send_notice( uint64_t, fc::variants ) override
+         {
+            FC_THROW( "Notices are not supported over HTTP" );
+         }
+   };
+
+   /** reads lines and bodies from a socket through one buffer */
+   class buffered_reader
+   {
+      public:
+         explicit buffered_reader( fc::tcp_socket& socket ) : _socket( socket ), _buffer( 64 * 1024 ) {}
+
+         /** returns false at the end of the stream if no partial line was read */
+         bool read_line( std::string& line )
+         {
+            line.clear();
+            while( true )
+            {
+               for( ; _begin < _end; ++_begin )
+               {
+                  char ch = _buffer[ _begin ];
+                  if( ch == '\n' )
+                  {
+                     ++_begin;
+                     if( !line.empty() && line.back() == '\r' )
+                        line.pop_back();
+                     return true;
+                  }
+                  line.push_back( ch );
+               }
+               FC_ASSERT( line.size() <= max_header_line_size, "HTTP header line is too long" );
+               if( !fill() )
+               {
+                  FC_ASSERT( line.empty(), "Connection closed in the middle of a line" );
+                  return false;
+               }
+            }
+         }
+
+         void read( std::string& out, size_t size )
+         {
+            out.clear();
+            out.reserve( size );
+            while( out.size() < size )
+            {
+               if( _begin == _end )
+                  FC_ASSERT( fill(), "Connection closed in the middle of a request body" );
+               size_t n = std::min( size - out.size(), _end - _begin );
+               out.append( _buffer.data() + _begin, n );
+               _begin += n;
+            }
+         }
+
+      private:
+         bool fill()
+         {
+            try
+            {
+               _begin = 0;
+               _end = _socket.readsome( _buffer.data(), _buffer.size() );
+               return _end > 0;
+            }
+            catch( const fc::eof_exception& )
+            {
+               _end = 0;
+               return false;
+            }
+         }
+
+         fc::tcp_socket&     _socket;
+         std::vector< char > _buffer;
+         size_t              _begin = 0;
+         size_t              _end = 0;
+   };
+
+   const char* status_text( uint16_t status )
+   {
+      switch( status )
+      {
+         case 200: return "OK";
+         case 400: return "Bad Request";
+         case 405: return "Method Not Allowed";
+         case 411: return "Length Required";
+         case 413: return "Payload Too Large";
+         default:  return "Error";
+      }
+   }
+
+   fc::variant rpc_error( const fc::variant& id, int64_t code, const std::string& message )
+   {
+      return fc::mutable_variant_object( "jsonrpc", "2.0" )( "id", id )
+         ( "error", fc::mutable_variant_object( "code", code )( "message", message ) );
+   }
+
+} // anonymous
+
+struct http_rpc_server::http_request
+{
+   std::string method;
+   std::string version;
+   std::map< std::string, std::string > headers;
+   std::string body;
+   /** the status to answer with without executing the request, 0 if it is valid */
+   uint16_t    error_status = 0;
+};
+
+struct http_rpc_server::connection
+{
+   fc::tcp_socket                                   socket;
+   std::shared_ptr< api_session_data >              session;
+   std::shared_ptr< http_api_connection >           rpc;
+   std::map< std::string, fc::api_id_type >         api_ids;
+
+   struct pending_response
+   {
+      fc::future< http_response >                   response;
+      size_t                                        body_size;
+   };
+
+   /** responses in request order, the writer waits for the oldest one */
+   std::deque< pending_response >                   responses;
+   fc::promise< void >::ptr                         responses_changed;
+   /** body bytes of the requests in responses */
+   size_t                                           buffered_bytes = 0;
+   bool                                             reading_done = false;
+
+   /** the connection is closed when the deadline passes */
+   fc::time_point                                   deadline = fc::time_point::maximum();
+   /** waiting for the next request, the idle time counts once every response is written */
+   bool                                             idle = false;
+
+   fc::future< void >                               reader;
+   fc::future< void >                               writer;
+   fc::future< void >                               watchdog;
+
+   void notify()
+   {
+      if( responses_changed )
+      {
+         fc::promise< void >::ptr p = responses_changed;
+         responses_changed.reset();
+         p->set_value();
+      }
+   }
+
+   void wait()
+   {
+      responses_changed.reset( new fc::promise< void >( "http_rpc_server::connection" ) );
+      fc::future< void >( responses_changed ).wait();
+   }
+};
+
+http_rpc_server::http_rpc_server( application& app, std::vector< std::string > public_apis, uint32_t max_workers,
+                                  uint32_t max_pipeline, const http_rpc_limits& limits )
+   : _app( app ), _public_apis( std::move( public_apis ) ), _max_workers( std::max< uint32_t >( max_workers, 1 ) ),
+     _max_pipeline( std::max< uint32_t >( max_pipeline, 1 ) ), _limits( limits )
+{
+}
+
+http_rpc_server::~http_rpc_server()
+{
+   close();
+}
+
+void http_rpc_server::listen( const fc::ip::endpoint& ep )
+{
+   _tcp_server.set_reuse_address();
+   _tcp_server.listen( ep );
+   _accept_task = fc::async( [this]() { accept_loop(); }, "http_rpc_accept" );
+}
+
+uint16_t http_rpc_server::get_port()const
+{
+   return _tcp_server.get_port();
+}
+
+void http_rpc_server::close()
+{
+   if( _accept_task.valid() && !_accept_task.ready() )
+   {
+      _tcp_server.close();
+      _accept_task.cancel_and_wait( __FUNCTION__ );
+   }
+   std::set< std::shared_ptr< connection > > connections;
+   connections.swap( _connections );
+   for( const std::shared_ptr< connection >& c : connections )
+   {
+      c->socket.close();
+      if( c->reader.valid() && !c->reader.ready() )
+         c->reader.cancel_and_wait( __FUNCTION__ );
+      if( c->writer.valid() && !c->writer.ready() )
+         c->writer.cancel_and_wait( __FUNCTION__ );
+      if( c->watchdog.valid() && !c->watchdog.ready() )
+         c->watchdog.cancel_and_wait( __FUNCTION__ );
+   }
+}
+
+void http_rpc_server::accept_loop()
+{
+   try
+   {
+      while( !_accept_task.canceled() )
+      {
+         std::shared_ptr< connection > c = std::make_shared< connection >();
+         _tcp_server.accept( c->socket );
+
+         c->session = std::make_shared< api_session_data >();
+         c->rpc = std::make_shared< http_api_connection >();
+         for( const std::string& name : _public_apis )
+         {
+            api_context ctx( _app, name, c->session );
+            fc::api_ptr api = _app.create_api_by_name( ctx );
+            if( api )
+               c->session->api_map[name] = api;
+         }
+
+         _connections.insert( c );
+         c->reader = fc::async( [this, c]() { read_requests( c ); }, "http_rpc_reader" );
+         c->writer = fc::async( [this, c]() { write_responses( c ); }, "http_rpc_writer" );
+         c->watchdog = fc::async( [this, c]() { watch_deadline( c ); }, "http_rpc_watchdog" );
+      }
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "HTTP RPC server stopped accepting connections: ${e}", ("e",e.to_detail_string()) );
+   }
+}
+
+void http_rpc_server::read_requests( std::shared_ptr< connection > c )
+{
+   try
+   {
+      buffered_reader reader( c->socket );
+      std::string line;
+      while( true )
+      {
+         c->idle = true;
+         c->deadline = fc::time_point::now() + _limits.idle_timeout;
+         if( !reader.read_line( line ) )
+            break;
+         c->idle = false;
+         if( line.empty() )
+            continue; // tolerated between requests
+         c->deadline = fc::time_point::now() + _limits.header_timeout;
+
+         std::shared_ptr< http_request > request = std::make_shared< http_request >();
+         std::vector< std::string > parts;
+         boost::split( parts, line, boost::is_any_of( " " ), boost::token_compress_on );
+         if( parts.size() == 3 )
+         {
+            request->method = parts[0];
+            request->version = parts[2];
+         }
+         else
+            request->error_status = 400;
+
+         while( true )
+         {
+            FC_ASSERT( reader.read_line( line ), "Connection closed in the middle of a request" );
+            if( line.empty() )
+               break;
+            FC_ASSERT( request->headers.size() < max_header_count, "Too many HTTP headers" );
+            auto colon = line.find( ':' );
+            if( colon == std::string::npos )
+            {
+               request->error_status = 400;
+               continue;
+            }
+            std::string name = boost::algorithm::to_lower_copy( line.substr( 0, colon ) );
+            request->headers[name] = boost::algorithm::trim_copy( line.substr( colon + 1 ) );
+         }
+
+         if( request->error_status == 0 )
+         {
+            auto length = request->headers.find( "content-length" );
+            if( request->method != "POST" )
+               request->error_status = 405;
+            else if( request->headers.count( "transfer-encoding" ) )
+               request->error_status = 411;
+            else if( length == request->headers.end() )
+               request->error_status = 411;
+            else
+            {
+               size_t size = boost::lexical_cast< size_t >( length->second );
+               if( size > max_body_size )
+                  request->error_status = 413;
+               else
+               {
+                  // waiting for earlier requests to be answered does not count against the client
+                  c->deadline = fc::time_point::maximum();
+                  while( !c->responses.empty() && c->buffered_bytes + size > _limits.max_buffered_bytes )
+                     c->wait();
+                  c->deadline = fc::time_point::now() + _limits.body_timeout;
+                  reader.read( request->body, size );
+               }
+            }
+         }
+
+         connection::pending_response pending;
+         pending.response = fc::async( [this, c, request]() { return handle( *c, *request ); }, "http_rpc_request" );
+         pending.body_size = request->body.size();
+         c->buffered_bytes += pending.body_size;
+         c->responses.push_back( pending );
+         c->notify();
+         if( request->error_status != 0 && request->error_status != 405 )
+            break; // the rest of the stream cannot be parsed reliably
+         c->deadline = fc::time_point::maximum();
+         while( c->responses.size() >= _max_pipeline )
+            c->wait();
+      }
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      dlog( "stopped reading HTTP RPC requests: ${e}", ("e",e.to_string()) );
+   }
+   catch( const boost::bad_lexical_cast& )
+   {
+      dlog( "stopped reading HTTP RPC requests: invalid Content-Length" );
+   }
+   c->reading_done = true;
+   c->notify();
+}
+
+void http_rpc_server::write_responses( std::shared_ptr< connection > c )
+{
+   try
+   {
+      while( true )
+      {
+         if( c->responses.empty() )
+         {
+            if( c->reading_done )
+               break;
+            c->wait();
+            continue;
+         }
+         http_response response = c->responses.front().response.wait();
+         c->buffered_bytes -= c->responses.front().body_size;
+         c->responses.pop_front();
+         c->notify();
+
+         std::string head = "HTTP/1.1 " + std::to_string( response.status ) + " " + status_text( response.status ) + "\r\n"
+                            "Content-Type: application/json\r\n"
+                            "Content-Length: " + std::to_string( response.body.size() ) + "\r\n";
+         if( response.close )
+            head += "Connection: close\r\n";
+         head += "\r\n";
+         c->socket.write( head.data(), head.size() );
+         c->socket.write( response.body.data(), response.body.size() );
+         c->socket.flush();
+         if( response.close )
+            break;
+      }
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      dlog( "stopped writing HTTP RPC responses: ${e}", ("e",e.to_string()) );
+   }
+   c->socket.close();
+   if( c->reader.valid() && !c->reader.ready() )
+      c->reader.cancel();
+   if( c->watchdog.valid() && !c->watchdog.ready() )
+      c->watchdog.cancel();
+   _connections.erase( c );
+}
+
+void http_rpc_server::watch_deadline( std::shared_ptr< connection > c )
+{
+   while( !c->reading_done )
+   {
+      fc::usleep( fc::seconds( 1 ) );
+      fc::time_point now = fc::time_point::now();
+      if( c->idle && !c->responses.empty() )
+         c->deadline = now + _limits.idle_timeout;
+      if( now >= c->deadline )
+      {
+         // the reader fails on the closed socket, the writer then ends the connection
+         dlog( "HTTP RPC connection timed out ${w}", ("w",c->idle ? "idling" : "sending a request") );
+         c->socket.close();
+         break;
+      }
+   }
+}
+
+http_rpc_server::http_response http_rpc_server::handle( connection& c, const http_request& request )
+{
+   http_response response;
+   auto header = request.headers.find( "connection" );
+   std::string connection_header = header != request.headers.end() ? boost::algorithm::to_lower_copy( header->second ) : "";
+   // HTTP/1.1 connections persist by default, HTTP/1.0 ones only on request
+   response.close = request.version == "HTTP/1.0" ? connection_header != "keep-alive" : connection_header == "close";
+
+   if( request.error_status != 0 )
+   {
+      response.status = request.error_status;
+      response.close = response.close || request.error_status != 405;
+      response.body = fc::json::to_string( rpc_error( fc::variant(), -32600, status_text( request.error_status ) ) );
+      return response;
+   }
+
+   fc::variant call;
+   try
+   {
+      call = fc::json::from_string( request.body );
+   }
+   catch( const fc::exception& e )
+   {
+      response.body = fc::json::to_string( rpc_error( fc::variant(), -32700, e.to_string() ) );
+      return response;
+   }
+
+   acquire_worker();
+   try
+   {
+      if( call.is_array() )
+      {
+         const fc::variants& calls = call.get_array();
+         fc::variants results;
+         results.reserve( calls.size() );
+         for( const fc::variant& single : calls )
+            results.push_back( handle_call( c, single ) );
+         response.body = fc::json::to_string( fc::variant( results ) );
+      }
+      else
+         response.body = fc::json::to_string( handle_call( c, call ) );
+   }
+   catch( ... )
+   {
+      release_worker();
+      throw;
+   }
+   release_worker();
+   return response;
+}
+
+fc::variant http_rpc_server::handle_call( connection& c, const fc::variant& call )
+{
+   fc::variant id;
+   try
+   {
+      FC_ASSERT( call.is_object(), "A call must be an object" );
+      const fc::variant_object& obj = call.get_object();
+      if( obj.contains( "id" ) )
+         id = obj["id"];
+      std::string method = obj["method"].as_string();
+      fc::variants params;
+      if( obj.contains( "params" ) )
+         params = obj["params"].get_array();
+
+      fc::variant result;
+      if( method == "call" )
+      {
+         FC_ASSERT( params.size() == 3, "call expects [api, method, args]" );
+         result = c.rpc->receive_call( resolve_api( c, params[0] ), params[1].as_string(), params[2].get_array() );
+      }
+      else
+      {
+         auto dot = method.find( '.' );
+         FC_ASSERT( dot != std::string::npos, "Unknown method ${m}, expected call or api.method", ("m",method) );
+         result = c.rpc->receive_call( resolve_api( c, fc::variant( method.substr( 0, dot ) ) ), method.substr( dot + 1 ), params );
+      }
+      return fc::mutable_variant_object( "jsonrpc", "2.0" )( "id", id )( "result", result );
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      return rpc_error( id, -32000, e.to_string() );
+   }
+}
+
+fc::api_id_type http_rpc_server::resolve_api( connection& c, const fc::variant& api )
+{
+   if( !api.is_string() )
+      return api.as_uint64();
+   const std::string& name = api.get_string();
+   auto itr = c.api_ids.find( name );
+   if( itr != c.api_ids.end() )
+      return itr->second;
+   // APIs granted by login are added to the session later, they are registered on first use
+   auto session_api = c.session->api_map.find( name );
+   FC_ASSERT( session_api != c.session->api_map.end() && session_api->second, "API ${a} is not available", ("a",name) );
+   fc::api_id_type id = session_api->second->register_api( *c.rpc );
+   c.api_ids[name] = id;
+   return id;
+}
+
+void http_rpc_server::acquire_worker()
+{
+   while( _busy_workers >= _max_workers )
+   {
+      fc::promise< void >::ptr waiter( new fc::promise< void >( "http_rpc_server::worker" ) );
+      _worker_waiters.push_back( waiter );
+      fc::future< void >( waiter ).wait();
+   }
+   ++_busy_workers;
+}
+
+void http_rpc_server::release_worker()
+{
+   --_busy_workers;
+   if( !_worker_waiters.empty() )
+   {
+      fc::promise< void >::ptr waiter = _worker_waiters.front();
+      _worker_waiters.pop_front();
+      waiter->set_value();
+   }
+}
+
+} } // muse::app
@@ -25,6 +25,10 @@
 
 #include <muse/app/api_context.hpp>
 #include <muse/app/database_api.hpp>
+#include <muse/app/transaction_admission_queue.hpp>
+#include <muse/app/response_cache.hpp>
+#include <muse/app/transaction_confirmation_tracker.hpp>
+#include <muse/app/api_admission_control.hpp>
 #include <muse/chain/protocol/types.hpp>
 
 #include <graphene/net/node.hpp>
@@ -57,13 +61,7 @@ namespace muse { namespace app {
       public:
          network_broadcast_api(const api_context& a);
 
-         struct transaction_confirmation
-         {
-            transaction_id_type   id;
-            int32_t               block_num;
-            int32_t               trx_num;
-            bool                  expired;
-         };
+         typedef muse::app::transaction_confirmation transaction_confirmation;
 
          typedef std::function<void(variant/*transaction_confirmation*/)> confirmation_callback;
 
@@ -83,30 +81,15 @@ namespace muse { namespace app {
          void broadcast_transaction_with_callback( confirmation_callback cb, const signed_transaction& trx);
 
          /**
-          * This call will not return until the transaction is included in a block.
+          * This call will not return until the transaction is included in a block or has expired.
           */
          fc::variant broadcast_transaction_synchronous( const signed_transaction& trx);
 
          void broadcast_block( const signed_block& block );
 
-         /**
-          * @brief Not reflected, thus not accessible to API clients.
-          *
-          * This function is registered to receive the applied_block
-          * signal from the chain database when a block is received.
-          * It then dispatches callbacks to clients who have requested
-          * to be notified when a particular txid is included in a block.
-          */
-         void on_applied_block( const signed_block& b );
-
          /// internal method, not exposed via JSON RPC
          void on_api_startup();
       private:
-         boost::signals2::scoped_connection             _applied_block_connection;
-
-         map<transaction_id_type,confirmation_callback>     _callbacks;
-         map<time_point_sec, vector<transaction_id_type> >  _callbacks_expirations;
-
          application&                                   _app;
    };
 
@@ -152,6 +135,37 @@ namespace muse { namespace app {
           */
          std::vector<graphene::net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Return the depth of the incoming transaction queue and how many transactions
+          *        it admitted, rejected and dropped
+          */
+         transaction_admission_stats get_transaction_queue_stats() const;
+
+         /**
+          * @brief Return the hits and misses of the database_api response cache
+          */
+         response_cache_stats get_response_cache_stats() const;
+
+         /// internal method, not exposed via JSON RPC
+         void on_api_startup();
+
+      private:
+         application& _app;
+   };
+
+   /**
+    * @brief The node_stats_api class reports how the node serves API calls.
+    */
+   class node_stats_api
+   {
+      public:
+         node_stats_api(const api_context& a);
+
+         /**
+          * @brief Return the calls, refusals and latency histogram of every database_api method called so far
+          */
+         api_admission_stats get_api_stats() const;
+
          /// internal method, not exposed via JSON RPC
          void on_api_startup();
 
@@ -192,8 +206,6 @@ namespace muse { namespace app {
 
 }}  // muse::app
 
-FC_REFLECT( muse::app::network_broadcast_api::transaction_confirmation,
-        (id)(block_num)(trx_num)(expired) )
 //FC_REFLECT_TYPENAME( fc::ecc::compact_signature );
 //FC_REFLECT_TYPENAME( fc::ecc::commitment_type );
 
@@ -210,6 +222,11 @@ FC_API(muse::app::network_node_api,
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (get_transaction_queue_stats)
+       (get_response_cache_stats)
+     )
+FC_API(muse::app::node_stats_api,
+       (get_api_stats)
      )
 FC_API(muse::app::login_api,
        (login)
@@ -0,0 +1,145 @@
+#pragma once
+#include <muse/chain/database.hpp>
+
+#include <fc/reflect/reflect.hpp>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace muse { namespace app {
+
+   struct api_method_stats
+   {
+      std::string             method;
+      /** cost per cost_unit_size requested items */
+      uint32_t                cost      = 1;
+      uint64_t                calls     = 0;
+      /** calls refused by admission control, not counted in calls */
+      uint64_t                rejected  = 0;
+      /** calls that threw */
+      uint64_t                failed    = 0;
+      uint32_t                in_flight = 0;
+      uint64_t                total_us  = 0;
+      uint64_t                max_us    = 0;
+      /** latency_histogram[i] counts the calls that took less than 2^i microseconds and at least half of that */
+      std::vector< uint64_t > latency_histogram;
+   };
+
+   struct api_admission_stats
+   {
+      uint32_t                        in_flight     = 0;
+      uint32_t                        max_in_flight = 0;
+      /** whether expensive calls are refused because block application is behind */
+      bool                            shedding      = false;
+      std::vector< api_method_stats > methods;
+   };
+
+   /**
+    *  @class api_admission_control
+    *  @brief accounts and limits the database_api calls of all connections
+    *
+    *  Every method has a cost, 1 unless configured otherwise, for each cost_unit_size items a
+    *  call requests, e.g. its limit or the number of ids it looks up, but at most burst.  A call
+    *  is refused when
+    *  - the node already runs max_in_flight calls,
+    *  - the connection's token bucket holds fewer tokens than the cost of the call, the bucket
+    *    refills at tokens_per_second up to burst tokens,
+    *  - or the head block is older than shed_head_age, i.e. the node is busy catching up, and the
+    *    cost of the call is at least shed_min_cost.
+    *
+    *  Latency is measured from admission until the result is ready, including the wait for a
+    *  read thread.
+    */
+   class api_admission_control
+   {
+      public:
+         struct config
+         {
+            /** 0 for no limit */
+            uint32_t                             max_in_flight     = 0;
+            /** 0 for no per connection limit */
+            uint32_t                             tokens_per_second = 0;
+            uint32_t                             burst             = 100;
+            /** number of requested items a method's cost pays for */
+            uint32_t                             cost_unit_size    = 100;
+            /** 0 to never shed calls */
+            fc::microseconds                     shed_head_age;
+            uint32_t                             shed_min_cost     = 2;
+            std::map< std::string, uint32_t >    costs;
+         };
+
+         struct connection_budget
+         {
+            double           tokens = 0;
+            fc::time_point   refilled;
+         };
+
+         /** how many latency_histogram buckets are kept, the last one counts all slower calls */
+         static const size_t histogram_size = 26;
+
+      private:
+         struct method_entry
+         {
+            uint32_t                                    cost = 1;
+            uint64_t                                    calls = 0;
+            uint64_t                                    rejected = 0;
+            uint64_t                                    failed = 0;
+            uint32_t                                    in_flight = 0;
+            uint64_t                                    total_us = 0;
+            uint64_t                                    max_us = 0;
+            std::array< uint64_t, histogram_size >      histogram{};
+         };
+
+      public:
+         /**
+          *  Admits a call for the lifetime of the guard and records its latency when it is destroyed.
+          *  Throws when the call is refused.  Does nothing when control is null.
+          *
+          *  size is the number of items the call requests.  The call is counted as failed unless
+          *  succeeded() is called before the guard is destroyed.
+          */
+         class call_guard
+         {
+            public:
+               call_guard( api_admission_control* control, const char* method, connection_budget* budget, uint32_t size = 1 );
+               ~call_guard();
+
+               void succeeded() { _succeeded = true; }
+
+            private:
+               call_guard( const call_guard& ) = delete;
+               call_guard& operator=( const call_guard& ) = delete;
+
+               api_admission_control* _control = nullptr;
+               method_entry*          _entry = nullptr;
+               fc::time_point         _start;
+               bool                   _succeeded = false;
+         };
+
+         api_admission_control( const chain::database& db, const config& cfg );
+
+         /** the token bucket of a new connection, which starts full */
+         std::shared_ptr< connection_budget > open_connection()const;
+
+         api_admission_stats get_stats()const;
+
+      private:
+         method_entry& entry( const char* method );
+         uint32_t      call_cost( const method_entry& e, uint32_t size )const;
+         bool          shedding()const;
+
+         const chain::database&                      _db;
+         const config                                _config;
+         mutable std::mutex                          _mutex;
+         uint32_t                                    _in_flight = 0;
+         std::map< std::string, method_entry >       _methods;
+   };
+
+} } // muse::app
+
+FC_REFLECT( muse::app::api_method_stats, (method)(cost)(calls)(rejected)(failed)(in_flight)(total_us)(max_us)(latency_histogram) )
+FC_REFLECT( muse::app::api_admission_stats, (in_flight)(max_in_flight)(shedding)(methods) )
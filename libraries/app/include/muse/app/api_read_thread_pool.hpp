@@ -0,0 +1,80 @@
+#pragma once
+#include <muse/chain/database.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace muse { namespace app {
+
+   /**
+    *  @class api_read_thread_pool
+    *  @brief runs read-only API queries on worker threads
+    *
+    *  Queries hold the database read lock while they run, so they see the state between two
+    *  pushed blocks or transactions, never one that is half applied.  The calling fiber
+    *  yields until its query is done, so the chain thread keeps applying blocks meanwhile
+    *  and waits at most for the queries that are already running.
+    *
+    *  Without threads, queries run inline on the calling thread, which must be the chain
+    *  thread, as before.
+    */
+   class api_read_thread_pool
+   {
+      public:
+         api_read_thread_pool( const chain::database& db, uint32_t thread_count );
+
+         uint32_t thread_count()const { return _threads.size(); }
+
+         /**
+          *  Runs query on one of the worker threads and returns its result, exceptions are
+          *  rethrown to the caller.  query must only read the database and must not yield.
+          *
+          *  The worker owns query until it is done.  query may refer to the caller's frame, so
+          *  a caller canceled while it waits does not unwind before the worker is done with it.
+          */
+         template< typename Lambda >
+         auto run( Lambda&& query ) -> decltype( query() )
+         {
+            typedef decltype( query() ) result_type;
+            typedef typename std::decay< Lambda >::type query_type;
+            if( _threads.empty() )
+               return query();
+            auto task = std::make_shared< query_type >( std::forward< Lambda >( query ) );
+            fc::future< result_type > result = _threads[ _next_thread++ % _threads.size() ]->async(
+               [this, task]() -> result_type {
+                  return _db.with_read_lock( *task );
+               }, "api_read" );
+            try
+            {
+               return result.wait();
+            }
+            catch( const fc::canceled_exception& )
+            {
+               // the fiber stays canceled, so each wait throws again once it wakes up; waiting on the
+               // future yields to the other fibers of this thread, which may hold the write lock the
+               // query is waiting for
+               while( !result.ready() )
+               {
+                  try
+                  {
+                     result.wait();
+                  }
+                  catch( const fc::exception& )
+                  {
+                  }
+               }
+               throw;
+            }
+         }
+
+      private:
+         const chain::database&                         _db;
+         std::vector< std::unique_ptr< fc::thread > >   _threads;
+         std::atomic< uint32_t >                        _next_thread{ 0 };
+   };
+
+} } // muse::app
@@ -40,6 +40,13 @@ namespace muse { namespace app {
 
    class abstract_plugin;
    class application;
+   class transaction_admission_queue;
+   class api_read_thread_pool;
+   class subscription_manager;
+   class transaction_confirmation_tracker;
+   class api_admission_control;
+   class response_cache;
+   class state_delta_feed;
 
    class application
    {
@@ -77,9 +84,24 @@ namespace muse { namespace app {
             return result;
          }
 
+         /** null when the node follows a primary node (replicate-from) */
          graphene::net::node_ptr                    p2p_node();
          std::shared_ptr<chain::database> chain_database()const;
          std::shared_ptr<graphene::db::object_database> pending_trx_database() const;
+         /** null until startup() */
+         std::shared_ptr<transaction_admission_queue> get_transaction_admission_queue() const;
+         /** null until startup() */
+         std::shared_ptr<api_read_thread_pool> get_api_read_thread_pool() const;
+         /** null until startup() */
+         std::shared_ptr<subscription_manager> get_subscription_manager() const;
+         /** null until startup() */
+         std::shared_ptr<transaction_confirmation_tracker> get_transaction_confirmation_tracker() const;
+         /** null until startup() */
+         std::shared_ptr<api_admission_control> get_api_admission_control() const;
+         /** null until startup() */
+         std::shared_ptr<response_cache> get_response_cache() const;
+         /** null until startup(), and when no state deltas are kept (state-delta-history) */
+         std::shared_ptr<state_delta_feed> get_state_delta_feed() const;
 
          void set_block_production(bool producing_blocks);
          fc::optional< api_access_info > get_api_access_info( const string& username )const;
@@ -0,0 +1,191 @@
+#pragma once
+#include <muse/chain/global_property_object.hpp>
+#include <muse/chain/protocol/block.hpp>
+#include <muse/chain/state_delta.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/network/ip.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/future.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace muse { namespace app {
+
+   class application;
+   class database_api;
+
+   /**
+    *  The binary RPC protocol serves the database_api without converting results to variants and
+    *  JSON.  Every message is a frame: the size of the payload as a 32 bit little endian integer,
+    *  followed by the payload.
+    *
+    *  A request frame holds a packed binary_rpc_request.  Its params are the arguments of the
+    *  method packed one after the other.  Every reply frame starts with a packed
+    *  binary_rpc_reply_header, the rest of the frame is the body.  Streaming methods send one
+    *  frame with status more for each item and end with an ok frame without body; other methods
+    *  send a single ok frame.  An error frame carries the error message as a packed string.
+    *
+    *  Methods:
+    *  - get_dynamic_global_properties() -> dynamic_global_property_object
+    *  - get_block( uint32_t block_num ) -> signed_block as stored in the block log, empty if unknown
+    *  - get_blocks( uint32_t start, uint32_t count ) -> streams the signed_blocks as stored in the
+    *    block log, stops at the head block
+    *  - get_objects( vector<object_id_type> ) -> vector<vector<char>>, each object packed as its
+    *    type, empty if it does not exist
+    *  - lookup_account_names( vector<string> ) -> vector<optional<account_object>>
+    *  - get_account_history( string account, uint64_t from, uint32_t limit ) -> streams a
+    *    pair<uint32_t,operation_object> per operation
+    *  - get_state_deltas( uint32_t start, uint32_t count ) -> streams the state_delta of each
+    *    block, stops at the last irreversible block; an error if the node does not keep the delta
+    *    of start
+    */
+   struct binary_rpc_request
+   {
+      uint32_t            id = 0;
+      std::string         method;
+      std::vector< char > params;
+   };
+
+   struct binary_rpc_reply_header
+   {
+      enum status_type
+      {
+         ok    = 0,
+         more  = 1,
+         error = 2
+      };
+
+      uint32_t id     = 0;
+      uint8_t  status = ok;
+   };
+
+   namespace binary_rpc {
+
+      /** largest request frame a server accepts */
+      const uint32_t max_request_size = 1024 * 1024;
+
+      inline void pack_args( std::vector< char >& ) {}
+
+      template< typename Arg, typename... Args >
+      void pack_args( std::vector< char >& out, const Arg& arg, const Args&... args )
+      {
+         std::vector< char > packed = fc::raw::pack_to_vector( arg );
+         out.insert( out.end(), packed.begin(), packed.end() );
+         pack_args( out, args... );
+      }
+
+      template< typename T >
+      T unpack( const char* data, size_t size )
+      {
+         T result;
+         fc::datastream< const char* > ds( data, size );
+         fc::raw::unpack( ds, result );
+         return result;
+      }
+
+      /** writes one frame made of header followed by body */
+      void write_frame( fc::tcp_socket& socket, const std::vector< char >& header, const char* body, size_t body_size );
+      /** reads one frame, throws if its payload is larger than max_size */
+      std::vector< char > read_frame( fc::tcp_socket& socket, uint32_t max_size );
+
+   } // binary_rpc
+
+   /**
+    *  @class binary_rpc_server
+    *  @brief serves the binary RPC protocol on a TCP endpoint
+    *
+    *  Requests of a connection are handled in order, queries run through a database_api of the
+    *  connection and thereby on the API read threads, admitted against the connection's own
+    *  budget.  Blocks and objects are sent with their packed bytes.
+    */
+   class binary_rpc_server
+   {
+      public:
+         explicit binary_rpc_server( application& app );
+         ~binary_rpc_server();
+
+         void listen( const fc::ip::endpoint& ep );
+         /** the port listened on, useful after listening on port 0 */
+         uint16_t get_port()const;
+         void close();
+
+      private:
+         struct connection
+         {
+            fc::tcp_socket                    socket;
+            fc::future< void >                reader;
+            std::shared_ptr< database_api >   db_api;
+         };
+         typedef std::function< void( connection&, const binary_rpc_request& ) > handler_type;
+
+         void accept_loop();
+         void serve( std::shared_ptr< connection > c );
+         void handle( connection& c, const binary_rpc_request& request );
+
+         static void reply( connection& c, uint32_t id, uint8_t status, const char* body, size_t body_size );
+         template< typename T >
+         static void reply_packed( connection& c, uint32_t id, uint8_t status, const T& value );
+
+         application&                                    _app;
+         std::map< std::string, handler_type >           _handlers;
+         fc::tcp_server                                  _tcp_server;
+         fc::future< void >                              _accept_task;
+         std::set< std::shared_ptr< connection > >       _connections;
+   };
+
+   /**
+    *  @class binary_rpc_client
+    *  @brief client of the binary RPC protocol
+    */
+   class binary_rpc_client
+   {
+      public:
+         typedef std::function< void( const char* data, size_t size ) > body_callback;
+
+         void connect( const fc::ip::endpoint& ep );
+         void close();
+
+         /**
+          *  Sends a request and waits for its replies, on_body is called with the body of each
+          *  reply frame that has one.  Throws the error message of an error reply.
+          */
+         void call( const std::string& method, const std::vector< char >& params, const body_callback& on_body );
+
+         template< typename Result, typename... Args >
+         Result call_packed( const std::string& method, const Args&... args )
+         {
+            std::vector< char > params;
+            binary_rpc::pack_args( params, args... );
+            Result result;
+            call( method, params, [&result]( const char* data, size_t size ) {
+               result = binary_rpc::unpack< Result >( data, size );
+            } );
+            return result;
+         }
+
+         chain::dynamic_global_property_object get_dynamic_global_properties();
+         fc::optional< chain::signed_block >   get_block( uint32_t block_num );
+         /** calls on_block for each block from start on, returns the number of blocks received */
+         uint32_t get_blocks( uint32_t start, uint32_t count, const std::function< void( const chain::signed_block& ) >& on_block );
+         /** calls on_delta for each state delta from start on, returns the number of deltas received */
+         uint32_t get_state_deltas( uint32_t start, uint32_t count, const std::function< void( const chain::state_delta& ) >& on_delta );
+
+         /** bytes received in reply frames so far, including framing */
+         uint64_t bytes_received()const { return _bytes_received; }
+
+      private:
+         fc::tcp_socket _socket;
+         uint32_t       _next_id = 1;
+         uint64_t       _bytes_received = 0;
+   };
+
+} } // muse::app
+
+FC_REFLECT( muse::app::binary_rpc_request, (id)(method)(params) )
+FC_REFLECT( muse::app::binary_rpc_reply_header, (id)(status) )
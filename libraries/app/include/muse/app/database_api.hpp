@@ -1,5 +1,6 @@
 #pragma once
 #include <muse/app/state.hpp>
+#include <muse/app/subscription_manager.hpp>
 #include <muse/chain/protocol/types.hpp>
 
 #include <muse/chain/database.hpp>
@@ -55,7 +56,37 @@ struct liquidity_balance
    fc::uint128_t        weight;
 };
 
+/**
+ *  One page of a list query.  next_cursor is an opaque position to pass to the next call, it is
+ *  empty once the list is complete.
+ */
+struct report_page
+{
+   vector< report_object > items;
+   string                  next_cursor;
+};
+
+struct content_page
+{
+   vector< content_object > items;
+   string                   next_cursor;
+};
+
+struct proposal_page
+{
+   vector< proposal_object > items;
+   string                    next_cursor;
+};
+
+/** operations of an account, newest first, with their sequence numbers */
+struct account_history_page
+{
+   vector< pair< uint32_t, operation_object > > items;
+   string                                       next_cursor;
+};
+
 class database_api_impl;
+class api_read_thread_pool;
 
 /**
  *  Defines the arguments to a query as a struct so it can be easily extended
@@ -81,11 +112,14 @@ struct discussion_query {
  * This API exposes accessors on the database which query state tracked by a blockchain validating node. This API is
  * read-only; all modifications to the database must be performed via transactions. Transactions are broadcast via
  * the @ref network_broadcast_api.
+ *
+ * When created through the application, queries run on its API read threads (see api_read_thread_pool) while the
+ * chain thread keeps applying blocks, each query seeing the state between two writes.
  */
 class database_api
 {
    public:
-      database_api(muse::chain::database& db);
+      database_api(muse::chain::database& db, std::shared_ptr< api_read_thread_pool > read_threads = nullptr);
       database_api(const muse::app::api_context& ctx);
       ~database_api();
 
@@ -96,6 +130,15 @@ class database_api
        * @ingroup db_api
        ****************/
       vector<report_object> get_reports_for_account(string consumer)const;
+
+      /*****************
+       * Get reports streaming related to given consumer, one page at a time
+       * @param consumer Account whose report we retrieve
+       * @param cursor Empty for the first page, next_cursor of the previous page otherwise
+       * @param limit Maximum number of reports to return, not more than 1000
+       * @ingroup db_api
+       ****************/
+      report_page list_reports_for_account( string consumer, string cursor, uint32_t limit )const;
       
       // vector<something> get_reports_for_content()
       
@@ -106,6 +149,15 @@ class database_api
        * @ingroup db_api
        */
       vector<content_object> get_content_by_uploader(string author)const;
+
+      /***************
+       * Get list of content uploaded by given account, one page at a time, ordered by url
+       * @param author Account uploading the content
+       * @param cursor Empty for the first page, next_cursor of the previous page otherwise
+       * @param limit Maximum number of content objects to return, not more than 1000
+       * @ingroup db_api
+       */
+      content_page list_content_by_uploader( string author, string cursor, uint32_t limit )const;
       
       /****************
        * Get piece of content by its url
@@ -115,6 +167,14 @@ class database_api
        */
       optional<content_object>    get_content_by_url(string url)const;
 
+      /****************
+       * Get several pieces of content by their urls
+       * @param urls URLs to retrieve, not more than 1000
+       * @return Content objects in the order of urls, empty for urls without content
+       * @ingroup db_api
+       */
+      vector< optional<content_object> > get_contents_by_urls( const vector<string>& urls )const;
+
       /****************
        * Lookup songs by title
        * @param start First letters of the title to look for
@@ -124,6 +184,15 @@ class database_api
        */
       vector<content_object>  lookup_content(const string& start, uint32_t limit )const;
 
+      /****************
+       * Lookup songs by title, one page at a time
+       * @param start First letters of the title to look for
+       * @param cursor Empty for the first page, next_cursor of the previous page otherwise
+       * @param limit Maximum number of content objects to return, not more than 1000
+       * @ingroup db_api
+       */
+      content_page list_content_by_title( string start, string cursor, uint32_t limit )const;
+
       /****************
        * Lookup User Issued Assets
        * @param start_id the ID to start with
@@ -177,7 +246,19 @@ class database_api
       // Subscriptions //
       ///////////////////
 
+      /**
+       * @brief Set callback receiving object change notifications
+       * @param cb Called once per batch of changes with an array of the changed objects, removed objects
+       *        are reported by their id
+       * @param clear_filter Drop the interests registered with subscribe_to_changes so far
+       * @ingroup db_api
+       */
       void set_subscribe_callback( std::function<void(const variant&)> cb, bool clear_filter );
+      /**
+       * @brief Add objects, accounts and content to be notified about through the subscribe callback
+       * @ingroup db_api
+       */
+      void subscribe_to_changes( const subscription_interests& interests );
       void set_pending_transaction_callback( std::function<void(const variant&)> cb );
       /**
        * @brief Set callback to be called after new block has been applied
@@ -241,11 +322,38 @@ class database_api
        * @ingroup db_api
        */
       optional<signed_block> get_block(uint32_t block_num)const;
+
+      /**
+       * @brief Retrieve consecutive blocks in one call
+       * @param start Height of the first block
+       * @param count Number of blocks, must not exceed 1000
+       * @return the blocks from start on, fewer than count if the chain ends earlier
+       * @ingroup db_api
+       */
+      vector<signed_block> get_blocks(uint32_t start, uint32_t count)const;
+
+      /**
+       * @brief Retrieve consecutive blocks in their binary serialization, as stored in the block log
+       * @param start Height of the first block
+       * @param count Number of blocks, must not exceed 1000
+       * @return the packed blocks from start on, fewer than count if the chain ends earlier
+       * @ingroup db_api
+       */
+      vector< vector<char> > get_block_range_raw(uint32_t start, uint32_t count)const;
       /**
        *  @return the set of proposed transactions relevant to the specified account id.
        *  @ingroup db_api
        */
       vector<proposal_object> get_proposed_transactions( string id )const;
+
+      /**
+       *  @brief Get the proposed transactions relevant to an account or content, one page at a time
+       *  @param id Account name or content url
+       *  @param cursor Empty for the first page, next_cursor of the previous page otherwise
+       *  @param limit Maximum number of proposals to return, not more than 1000
+       *  @ingroup db_api
+       */
+      proposal_page list_proposed_transactions( string id, string cursor, uint32_t limit )const;
             
       /////////////
       // Globals //
@@ -267,6 +375,16 @@ class database_api
        */
       fc::variants get_objects(const vector<object_id_type>& ids)const;
 
+      /**
+       * @brief Get the objects corresponding to the provided IDs in their binary serialization
+       * @param ids IDs of the objects to retrieve, must not exceed 1000
+       * @return Each object packed as its type, in the order they are mentioned in ids
+       *
+       * If any of the provided IDs does not map to an object, an empty vector is returned in its position.
+       * @ingroup db_api
+       */
+      vector< vector<char> > get_objects_raw(const vector<object_id_type>& ids)const;
+
       /**
        * @brief Retrieve the current @ref dynamic_global_property_object
        * @ingroup db_api
@@ -480,6 +598,14 @@ class database_api
     */
       map<uint32_t,operation_object> get_account_history( string account, uint64_t from, uint32_t limit )const;
 
+      /**
+       *  @brief Get the operations of an account from the most recent one back, one page at a time
+       *  @param account Name of the account
+       *  @param cursor Empty for the first page, next_cursor of the previous page otherwise
+       *  @param limit Maximum number of operations to return, not more than 2000
+       */
+      account_history_page list_account_history( string account, string cursor, uint32_t limit )const;
+
       vector<balance_object> get_balance_objects( const vector<address>& addrs )const;
       vector<balance_object> get_balance_objects_by_key( const string& pubkey )const;
 
@@ -498,12 +624,17 @@ FC_REFLECT( muse::app::order, (order_price)(real_price)(base)(quote)(created) );
 FC_REFLECT( muse::app::order_book, (asks)(bids) );
 FC_REFLECT( muse::app::scheduled_hardfork, (hf_version)(live_time) );
 FC_REFLECT( muse::app::liquidity_balance, (account)(weight) );
+FC_REFLECT( muse::app::report_page, (items)(next_cursor) );
+FC_REFLECT( muse::app::content_page, (items)(next_cursor) );
+FC_REFLECT( muse::app::proposal_page, (items)(next_cursor) );
+FC_REFLECT( muse::app::account_history_page, (items)(next_cursor) );
 
 FC_REFLECT( muse::app::discussion_query, (tag)(filter_tags)(start_author)(start_permlink)(parent_author)(parent_permlink)(limit) );
 
 FC_API(muse::app::database_api,
    // Subscriptions
    (set_subscribe_callback)
+   (subscribe_to_changes)
    (set_pending_transaction_callback)
    (set_block_applied_callback)
    (cancel_all_subscriptions)
@@ -512,13 +643,17 @@ FC_API(muse::app::database_api,
    // Blocks and transactions
    (get_block_header)
    (get_block)
+   (get_blocks)
+   (get_block_range_raw)
 //   (get_state)
 
    (get_proposed_transactions)
+   (list_proposed_transactions)
 
    // Globals
    (get_config)
    (get_objects)
+   (get_objects_raw)
    (get_dynamic_global_properties)
    (get_chain_properties)
    (get_feed_history)
@@ -539,6 +674,7 @@ FC_API(muse::app::database_api,
    (get_account_count)
    (get_conversion_requests)
    (get_account_history)
+   (list_account_history)
    (get_owner_history)
    (get_recovery_request)
 
@@ -568,9 +704,13 @@ FC_API(muse::app::database_api,
    // Content
    (lookup_streaming_platform_accounts)
    (get_reports_for_account)
+   (list_reports_for_account)
    (get_content_by_uploader)
+   (list_content_by_uploader)
    (get_content_by_url)
+   (get_contents_by_urls)
    (lookup_content)
+   (list_content_by_title)
    //UIAs
    (lookup_uias)
    (get_uia_details)
@@ -0,0 +1,99 @@
+#pragma once
+#include <muse/app/api_context.hpp>
+
+#include <fc/network/ip.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/future.hpp>
+#include <fc/time.hpp>
+
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace muse { namespace app {
+
+   class application;
+
+   struct http_rpc_limits
+   {
+      /** time a connection may stay open with every request answered and no new one started */
+      fc::microseconds idle_timeout       = fc::seconds( 60 );
+      /** time from the end of a request line to the end of its headers */
+      fc::microseconds header_timeout     = fc::seconds( 10 );
+      /** time to receive a request body once its headers are read */
+      fc::microseconds body_timeout       = fc::seconds( 30 );
+      /** request body bytes a connection may have read and not answered yet */
+      size_t           max_buffered_bytes = 32 * 1024 * 1024;
+   };
+
+   /**
+    *  @class http_rpc_server
+    *  @brief serves JSON-RPC over plain HTTP/1.1 with persistent connections
+    *
+    *  Connections are kept open between requests unless the client asks otherwise, and
+    *  requests a client sends without waiting for the responses are answered in order.  A
+    *  connection keeps its API session like a websocket connection does, so login works as
+    *  usual.
+    *
+    *  A request body is a JSON-RPC call or a JSON-RPC 2.0 batch array, which is executed as one
+    *  unit of work and answered with one array.  A call names its API either the websocket way,
+    *  method "call" with params [api, method, args], or as method "api.method" with the args as
+    *  params.  The API may be given by name or by id.
+    *
+    *  At most max_workers requests, counting a batch once, are executed at the same time across
+    *  all connections; further requests wait for a free worker.
+    *
+    *  A connection is closed when it idles or sends a request more slowly than the limits allow.
+    *  Reading stops while the unanswered requests of a connection hold max_buffered_bytes of
+    *  body or max_pipeline requests.
+    */
+   class http_rpc_server
+   {
+      public:
+         http_rpc_server( application& app, std::vector< std::string > public_apis, uint32_t max_workers,
+                          uint32_t max_pipeline, const http_rpc_limits& limits = http_rpc_limits() );
+         ~http_rpc_server();
+
+         void listen( const fc::ip::endpoint& ep );
+         /** the port listened on, useful after listening on port 0 */
+         uint16_t get_port()const;
+         void close();
+
+      private:
+         struct connection;
+         struct http_request;
+         struct http_response
+         {
+            std::string body;
+            uint16_t    status = 200;
+            bool        close  = false;
+         };
+
+         void accept_loop();
+         void read_requests( std::shared_ptr< connection > c );
+         void write_responses( std::shared_ptr< connection > c );
+         void watch_deadline( std::shared_ptr< connection > c );
+         http_response handle( connection& c, const http_request& request );
+         fc::variant   handle_call( connection& c, const fc::variant& call );
+         fc::api_id_type resolve_api( connection& c, const fc::variant& api );
+
+         void acquire_worker();
+         void release_worker();
+
+         application&                                   _app;
+         const std::vector< std::string >               _public_apis;
+         const uint32_t                                 _max_workers;
+         const uint32_t                                 _max_pipeline;
+         const http_rpc_limits                          _limits;
+
+         uint32_t                                       _busy_workers = 0;
+         std::deque< fc::promise< void >::ptr >         _worker_waiters;
+
+         fc::tcp_server                                 _tcp_server;
+         fc::future< void >                             _accept_task;
+         std::set< std::shared_ptr< connection > >      _connections;
+   };
+
+} } // muse::app
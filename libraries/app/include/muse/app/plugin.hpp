@@ -90,6 +90,14 @@ class abstract_plugin
          boost::program_options::options_description& config_file_options
          ) = 0;
 
+      /**
+       * @brief Whether the plugin may run on a replica, which follows a primary node by applying its state deltas.
+       *
+       * A replica does not evaluate operations, the objects plugins create from operations come with the deltas.
+       * Plugins that change the database or push blocks in any other way must not run on a replica.
+       */
+      virtual bool plugin_supports_replica()const { return false; }
+
 };
 
 /**
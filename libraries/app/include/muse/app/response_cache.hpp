@@ -0,0 +1,118 @@
+#pragma once
+#include <muse/chain/database.hpp>
+
+#include <fc/reflect/reflect.hpp>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace muse { namespace app {
+
+   struct response_cache_stats
+   {
+      uint64_t hits          = 0;
+      uint64_t misses        = 0;
+      /** times the results computed on the previous head block were dropped */
+      uint64_t invalidations = 0;
+      /** least recently used results dropped to make room */
+      uint64_t evictions     = 0;
+      uint32_t entries       = 0;
+      uint32_t max_entries   = 0;
+   };
+
+   /**
+    *  @class response_cache
+    *  @brief shares the results of frequently repeated API queries between sessions
+    *
+    *  Results are keyed by method, parameters and the head block they were computed on, and
+    *  are dropped when a block is applied or the head block changes otherwise, e.g. by
+    *  pop_block().  Pending transactions do not invalidate them, so a result may not reflect
+    *  transactions pushed since it was computed until the next block.  Immutable results, such
+    *  as irreversible blocks, are not keyed by the head block and stay until evicted.  When the
+    *  cache is full the least recently used result is evicted.
+    *
+    *  Results are stored with their C++ type, each hit copies the stored value instead of
+    *  querying the database again.
+    *
+    *  The header of the last applied block is converted to a variant once for all
+    *  block_applied_callback subscribers.
+    *
+    *  Lookups may happen on any API read thread, invalidation happens on the chain thread.
+    */
+   class response_cache
+   {
+      public:
+         response_cache( chain::database& db, uint32_t max_entries );
+
+         /**
+          *  Returns the cached result of method for params, or the result of compute() which is
+          *  then cached.  Must be called while the database cannot change, i.e. on the chain
+          *  thread or under the database read lock.
+          *
+          *  @param immutable true if the result does not depend on the head block
+          */
+         template< typename T, typename Lambda >
+         T get( const char* method, const std::string& params, bool immutable, Lambda&& compute )
+         {
+            if( _max_entries == 0 )
+               return compute();
+            std::string key = std::string( method ) + '(' + params + ')';
+            {
+               std::lock_guard< std::mutex > lock( _mutex );
+               check_head();
+               if( !immutable )
+                  key += '@' + _head.str();
+               std::shared_ptr< const void > value = find( key );
+               if( value )
+               {
+                  ++_stats.hits;
+                  return *std::static_pointer_cast< const T >( value );
+               }
+               ++_stats.misses;
+            }
+            std::shared_ptr< const T > result = std::make_shared< const T >( compute() );
+            std::lock_guard< std::mutex > lock( _mutex );
+            insert( std::move( key ), result, immutable );
+            return *result;
+         }
+
+         fc::variant applied_block_header( const chain::signed_block& b );
+
+         response_cache_stats get_stats()const;
+
+      private:
+         struct entry
+         {
+            std::shared_ptr< const void >           value;
+            bool                                    immutable;
+            /** position in _lru */
+            std::list< std::string >::iterator      lru_position;
+         };
+
+         void check_head();
+         /** drops the results that depend on the head block */
+         void invalidate();
+         std::shared_ptr< const void > find( const std::string& key );
+         void insert( std::string key, std::shared_ptr< const void > value, bool immutable );
+
+         chain::database&                                                _db;
+         const uint32_t                                                  _max_entries;
+         mutable std::mutex                                              _mutex;
+         chain::block_id_type                                            _head;
+         std::unordered_map< std::string, entry >                        _entries;
+         /** keys of _entries, most recently used first */
+         std::list< std::string >                                        _lru;
+         response_cache_stats                                            _stats;
+
+         chain::signature_type                                           _header_signature;
+         fc::variant                                                     _header;
+
+         boost::signals2::scoped_connection                              _applied_block_connection;
+   };
+
+} } // muse::app
+
+FC_REFLECT( muse::app::response_cache_stats, (hits)(misses)(invalidations)(evictions)(entries)(max_entries) )
@@ -0,0 +1,72 @@
+#pragma once
+#include <muse/chain/database.hpp>
+
+#include <fc/network/ip.hpp>
+#include <fc/thread/future.hpp>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace muse { namespace app {
+
+   class binary_rpc_client;
+
+   /**
+    *  @class state_delta_feed
+    *  @brief keeps the packed state deltas of the recent blocks of a primary node for its replicas
+    *
+    *  Each delta is packed once, when its block is applied, and served to every replica as it is.
+    *  The deltas of the last max_blocks blocks are kept.  When a block is applied again after a
+    *  fork switch, the deltas of it and of the blocks after it are replaced.
+    */
+   class state_delta_feed
+   {
+      public:
+         state_delta_feed( chain::database& db, uint32_t max_blocks );
+
+         /** the packed state_delta of block_num, null if it is not kept */
+         std::shared_ptr< const std::vector< char > > get( uint32_t block_num )const;
+
+      private:
+         void on_applied_state_delta( const chain::state_delta& delta );
+
+         const uint32_t                                               _max_blocks;
+         mutable std::mutex                                           _mutex;
+         /** the deltas of consecutive blocks starting at _first_block_num */
+         std::deque< std::shared_ptr< const std::vector< char > > >   _deltas;
+         uint32_t                                                     _first_block_num = 0;
+
+         boost::signals2::scoped_connection                           _applied_state_delta_connection;
+   };
+
+   /**
+    *  @class state_delta_follower
+    *  @brief keeps the database of a replica in step with a primary node
+    *
+    *  The follower fetches the state deltas of the primary's irreversible blocks from its binary
+    *  RPC endpoint and applies them with database::apply_state_delta(), so the blocks are not
+    *  evaluated again.  Blocks whose delta the primary no longer keeps, e.g. while a new replica
+    *  catches up, are fetched and pushed instead.  The connection is retried when it fails.
+    */
+   class state_delta_follower
+   {
+      public:
+         state_delta_follower( chain::database& db, const fc::ip::endpoint& primary );
+         ~state_delta_follower();
+
+         void start();
+         void stop();
+
+      private:
+         void follow();
+         /** brings the head up to the primary's last irreversible block, returns the number of blocks applied */
+         uint32_t catch_up( binary_rpc_client& client );
+
+         chain::database&         _db;
+         const fc::ip::endpoint   _primary;
+         fc::future< void >       _task;
+   };
+
+} } // muse::app
@@ -0,0 +1,97 @@
+#pragma once
+#include <muse/chain/database.hpp>
+
+#include <fc/thread/future.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace muse { namespace app {
+
+   /**
+    *  The objects a subscribed session wants to be notified about.  Account names match the
+    *  account_object of that name, content urls the content_object of that url, whether or not
+    *  the object exists yet.
+    */
+   struct subscription_interests
+   {
+      std::vector< chain::object_id_type > objects;
+      std::vector< std::string >           accounts;
+      std::vector< std::string >           content;
+   };
+
+   /**
+    *  @class subscription_manager
+    *  @brief delivers object change notifications to subscribed API sessions
+    *
+    *  The ids reported by database::changed_objects and removed_objects are collected until the
+    *  chain thread is done with the current write, then matched against the interests of all
+    *  sessions at once.  Every matching object is converted to a variant once and the same
+    *  variant is shared by the notifications of all sessions interested in it.  Each session
+    *  receives one array per batch: changed objects as variants, removed objects as their ids.
+    *
+    *  All methods must be called on the chain thread, callbacks are invoked there.
+    */
+   class subscription_manager
+   {
+      public:
+         typedef uint64_t                                 session_id;
+         typedef std::function< void(const fc::variant&) > callback_type;
+
+         explicit subscription_manager( chain::database& db );
+         ~subscription_manager();
+
+         session_id add_session( callback_type callback );
+         void       set_callback( session_id session, callback_type callback );
+         void       remove_session( session_id session );
+
+         void subscribe( session_id session, const subscription_interests& interests );
+         /** drops all interests of session, it stays registered */
+         void clear_interests( session_id session );
+
+         size_t session_count()const { return _sessions.size(); }
+
+      private:
+         struct session
+         {
+            callback_type                                  callback;
+            std::unordered_set< chain::object_id_type >    objects;
+            std::unordered_set< std::string >              accounts;
+            std::unordered_set< std::string >              content;
+         };
+
+         typedef std::unordered_map< std::string, std::unordered_set< session_id > > key_index;
+
+         void on_changed_objects( const std::vector< chain::object_id_type >& ids );
+         void on_removed_objects( const std::vector< const graphene::db::object* >& objects );
+         void schedule_delivery();
+         void deliver();
+         void match( const graphene::db::object* obj, chain::object_id_type id, std::vector< session_id >& result )const;
+         void match_key( const key_index& index, const std::string& key, std::vector< session_id >& result )const;
+         void forget_interests( session_id session );
+
+         chain::database&                                                         _db;
+         session_id                                                               _next_session = 1;
+         std::unordered_map< session_id, session >                                _sessions;
+         std::unordered_map< chain::object_id_type, std::unordered_set< session_id > > _by_object;
+         key_index                                                                _by_account;
+         key_index                                                                _by_content;
+
+         /** changed since the last delivery, in the order first reported */
+         std::vector< chain::object_id_type >                                     _changed;
+         std::unordered_set< chain::object_id_type >                              _changed_set;
+         /** sessions matched by the account name or url of objects removed since the last delivery */
+         std::unordered_map< chain::object_id_type, std::vector< session_id > >   _removed_matches;
+         fc::future< void >                                                       _delivery_task;
+
+         boost::signals2::scoped_connection                                       _changed_objects_connection;
+         boost::signals2::scoped_connection                                       _removed_objects_connection;
+   };
+
+} } // muse::app
+
+FC_REFLECT( muse::app::subscription_interests, (objects)(accounts)(content) )
@@ -0,0 +1,81 @@
+#pragma once
+#include <muse/chain/database.hpp>
+
+#include <fc/thread/future.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace fc { class thread; }
+
+namespace muse { namespace app {
+
+   struct transaction_admission_stats
+   {
+      /** transactions being checked or waiting to be pushed */
+      uint32_t queue_depth     = 0;
+      uint32_t max_queue_depth = 0;
+      uint64_t admitted        = 0;
+      /** transactions that failed their checks or failed to apply */
+      uint64_t rejected        = 0;
+      /** network transactions refused because the queue was full */
+      uint64_t dropped         = 0;
+   };
+
+   /**
+    *  @class transaction_admission_queue
+    *  @brief checks incoming transactions before they are pushed to the chain database
+    *
+    *  validate() and signature key recovery run on worker threads, leaving the chain thread
+    *  free meanwhile.  Checked transactions are pushed in batches by one task on the chain
+    *  thread with database::push_transactions(), transactions from local API clients first.
+    *
+    *  Network transactions arriving while the queue is full are refused with
+    *  graphene::net::transaction_queue_full, on which the p2p code stops fetching
+    *  transactions from the sending peer for a while.
+    */
+   class transaction_admission_queue
+   {
+      public:
+         transaction_admission_queue( chain::database& db, uint32_t max_queue_depth, uint32_t thread_count );
+         ~transaction_admission_queue();
+
+         /**
+          *  Must be called on the chain thread.  Waits until trx is pushed, throws if it was
+          *  refused, failed its checks or failed to apply, so that the p2p code relays only
+          *  transactions that applied and penalizes peers for the others.  The callers' waits
+          *  overlap, which is what fills the batches.
+          *
+          *  @param local true for transactions from API clients, these are never refused and are
+          *  pushed before network transactions
+          */
+         void push_transaction( const chain::signed_transaction& trx, bool local );
+
+         const transaction_admission_stats& get_stats()const { return _stats; }
+
+      private:
+         struct checked_transaction
+         {
+            std::shared_ptr< const chain::signed_transaction > trx;
+            fc::flat_set< chain::public_key_type >            signature_keys;
+            /** set once pushed */
+            fc::promise< void >::ptr                          pushed;
+         };
+
+         fc::flat_set< chain::public_key_type > check_transaction( const std::shared_ptr< const chain::signed_transaction >& trx );
+         void push_checked_transactions();
+
+         chain::database&                               _db;
+         std::vector< std::unique_ptr< fc::thread > >   _threads;
+         uint32_t                                       _next_thread = 0;
+         std::deque< checked_transaction >              _local_queue;
+         std::deque< checked_transaction >              _network_queue;
+         fc::future< void >                             _push_task;
+         transaction_admission_stats                    _stats;
+   };
+
+} } // muse::app
+
+FC_REFLECT( muse::app::transaction_admission_stats, (queue_depth)(max_queue_depth)(admitted)(rejected)(dropped) )
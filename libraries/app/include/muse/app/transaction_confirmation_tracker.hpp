@@ -0,0 +1,78 @@
+#pragma once
+#include <muse/chain/database.hpp>
+
+#include <fc/thread/future.hpp>
+
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace muse { namespace app {
+
+   struct transaction_confirmation
+   {
+      chain::transaction_id_type id;
+      int32_t                    block_num;
+      int32_t                    trx_num;
+      bool                       expired;
+   };
+
+   /**
+    *  @class transaction_confirmation_tracker
+    *  @brief notifies API sessions when their broadcast transactions are included in a block or expire
+    *
+    *  One tracker serves all sessions.  Applied blocks are matched by the transaction ids the
+    *  database computed while applying them, so the cost per block is one lookup per transaction,
+    *  independent of the number of waiting sessions.  Expiration only visits the transactions
+    *  that expire.
+    *
+    *  The confirmations of a block are delivered by a single task after the block has been
+    *  applied, each confirmation is converted to a variant once for all of its callbacks.
+    *
+    *  All methods must be called on the chain thread, callbacks are invoked there.
+    */
+   class transaction_confirmation_tracker
+   {
+      public:
+         typedef std::function< void(const fc::variant&) > callback_type;
+
+         explicit transaction_confirmation_tracker( chain::database& db );
+         ~transaction_confirmation_tracker();
+
+         /** callback is invoked once, when trx is included in a block or has expired */
+         void watch( const chain::signed_transaction& trx, callback_type callback );
+
+         size_t waiting_count()const { return _waiting.size(); }
+
+      private:
+         struct id_hash
+         {
+            size_t operator()( const chain::transaction_id_type& id )const { return id._hash[0]; }
+         };
+         typedef std::multimap< fc::time_point_sec, chain::transaction_id_type > expiration_index;
+
+         struct waiting_transaction
+         {
+            std::vector< callback_type > callbacks;
+            expiration_index::iterator   expiration;
+         };
+
+         void on_applied_block( const chain::signed_block& b );
+         void deliver();
+
+         chain::database&                                                             _db;
+         std::unordered_map< chain::transaction_id_type, waiting_transaction, id_hash > _waiting;
+         expiration_index                                                             _expirations;
+
+         /** confirmations not delivered yet, each with the callbacks waiting for it */
+         std::vector< std::pair< transaction_confirmation, std::vector< callback_type > > > _ready;
+         fc::future< void >                                                           _delivery_task;
+
+         boost::signals2::scoped_connection                                           _applied_block_connection;
+   };
+
+} } // muse::app
+
+FC_REFLECT( muse::app::transaction_confirmation, (id)(block_num)(trx_num)(expired) )
@@ -0,0 +1,92 @@
+#include <muse/app/response_cache.hpp>
+
+namespace muse { namespace app {
+
+response_cache::response_cache( chain::database& db, uint32_t max_entries )
+   : _db( db ), _max_entries( max_entries )
+{
+   _stats.max_entries = max_entries;
+   _applied_block_connection = _db.applied_block.connect( [this]( const chain::signed_block& ) {
+      std::lock_guard< std::mutex > lock( _mutex );
+      invalidate();
+      _head = _db.head_block_id();
+   } );
+}
+
+void response_cache::check_head()
+{
+   // pop_block() changes the head block without an applied_block notification
+   if( _db.head_block_id() != _head )
+   {
+      invalidate();
+      _head = _db.head_block_id();
+   }
+}
+
+void response_cache::invalidate()
+{
+   bool dropped = false;
+   for( auto itr = _entries.begin(); itr != _entries.end(); )
+   {
+      if( itr->second.immutable )
+      {
+         ++itr;
+         continue;
+      }
+      _lru.erase( itr->second.lru_position );
+      itr = _entries.erase( itr );
+      dropped = true;
+   }
+   if( dropped )
+      ++_stats.invalidations;
+}
+
+std::shared_ptr< const void > response_cache::find( const std::string& key )
+{
+   auto itr = _entries.find( key );
+   if( itr == _entries.end() )
+      return std::shared_ptr< const void >();
+   _lru.splice( _lru.begin(), _lru, itr->second.lru_position );
+   return itr->second.value;
+}
+
+void response_cache::insert( std::string key, std::shared_ptr< const void > value, bool immutable )
+{
+   // another session may have computed the same result meanwhile
+   if( _entries.find( key ) != _entries.end() )
+      return;
+   while( _entries.size() >= _max_entries )
+   {
+      _entries.erase( _lru.back() );
+      _lru.pop_back();
+      ++_stats.evictions;
+   }
+   _lru.push_front( key );
+   entry e;
+   e.value = std::move( value );
+   e.immutable = immutable;
+   e.lru_position = _lru.begin();
+   _entries.emplace( std::move( key ), std::move( e ) );
+}
+
+fc::variant response_cache::applied_block_header( const chain::signed_block& b )
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+   // the signature identifies the block without hashing it for every subscriber
+   if( b.witness_signature != _header_signature || _header.is_null() )
+   {
+      _header = fc::variant( chain::signed_block_header( b ), GRAPHENE_MAX_NESTED_OBJECTS );
+      _header_signature = b.witness_signature;
+   }
+   return _header;
+}
+
+response_cache_stats response_cache::get_stats()const
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+   response_cache_stats stats = _stats;
+   stats.entries = _entries.size();
+   return stats;
+}
+
+} } // muse::app
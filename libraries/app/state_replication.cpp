@@ -0,0 +1,130 @@
+#include <muse/app/state_replication.hpp>
+#include <muse/app/binary_rpc.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+
+namespace muse { namespace app {
+
+state_delta_feed::state_delta_feed( chain::database& db, uint32_t max_blocks )
+   : _max_blocks( max_blocks )
+{
+   _applied_state_delta_connection = db.applied_state_delta.connect( [this]( const chain::state_delta& delta ) {
+      on_applied_state_delta( delta );
+   } );
+}
+
+std::shared_ptr< const std::vector< char > > state_delta_feed::get( uint32_t block_num )const
+{
+   std::lock_guard< std::mutex > lock( _mutex );
+   if( block_num < _first_block_num || block_num - _first_block_num >= _deltas.size() )
+      return std::shared_ptr< const std::vector< char > >();
+   return _deltas[ block_num - _first_block_num ];
+}
+
+void state_delta_feed::on_applied_state_delta( const chain::state_delta& delta )
+{
+   std::shared_ptr< const std::vector< char > > packed = std::make_shared< std::vector< char > >( fc::raw::pack_to_vector( delta ) );
+   uint32_t block_num = delta.block.block_num();
+
+   std::lock_guard< std::mutex > lock( _mutex );
+   // a block applied again after a fork switch replaces the deltas from its number on, a gap
+   // (blocks applied without undo history) starts over
+   if( block_num < _first_block_num || block_num > _first_block_num + _deltas.size() )
+   {
+      _deltas.clear();
+      _first_block_num = block_num;
+   }
+   else
+      _deltas.resize( block_num - _first_block_num );
+   _deltas.push_back( std::move( packed ) );
+   while( _deltas.size() > _max_blocks )
+   {
+      _deltas.pop_front();
+      ++_first_block_num;
+   }
+}
+
+state_delta_follower::state_delta_follower( chain::database& db, const fc::ip::endpoint& primary )
+   : _db( db ), _primary( primary )
+{
+}
+
+state_delta_follower::~state_delta_follower()
+{
+   stop();
+}
+
+void state_delta_follower::start()
+{
+   _task = fc::async( [this]() { follow(); }, "state_delta_follower" );
+}
+
+void state_delta_follower::stop()
+{
+   if( _task.valid() && !_task.ready() )
+      _task.cancel_and_wait( __FUNCTION__ );
+}
+
+void state_delta_follower::follow()
+{
+   while( !_task.canceled() )
+   {
+      try
+      {
+         binary_rpc_client client;
+         client.connect( _primary );
+         ilog( "Following primary node ${ep} from block ${n}", ("ep",_primary)("n",_db.head_block_num()) );
+         while( !_task.canceled() )
+         {
+            // the primary's last irreversible block advances at most once per block interval
+            if( catch_up( client ) == 0 )
+               fc::usleep( fc::seconds( 1 ) );
+         }
+      }
+      catch( const fc::canceled_exception& )
+      {
+         throw;
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "Error following primary node ${ep}, retrying in 5 seconds: ${e}", ("ep",_primary)("e",e.to_detail_string()) );
+      }
+      fc::usleep( fc::seconds( 5 ) );
+   }
+}
+
+uint32_t state_delta_follower::catch_up( binary_rpc_client& client )
+{
+   uint32_t last_irreversible = client.get_dynamic_global_properties().last_irreversible_block_num;
+   uint32_t start = _db.head_block_num() + 1;
+   if( last_irreversible < start )
+      return 0;
+   uint32_t count = std::min< uint32_t >( last_irreversible - start + 1, 1000 );
+
+   uint32_t applied = 0;
+   try
+   {
+      applied = client.get_state_deltas( start, count, [this]( const chain::state_delta& delta ) {
+         _db.apply_state_delta( delta );
+      } );
+   }
+   catch( const fc::canceled_exception& )
+   {
+      throw;
+   }
+   catch( const fc::exception& e )
+   {
+      // the connection is still usable when the primary reported an error
+      if( _db.head_block_num() >= start )
+         throw;
+      wlog( "Primary node has no state delta for block ${n}, applying its blocks instead: ${e}", ("n",start)("e",e.to_string()) );
+      applied = client.get_blocks( start, count, [this]( const chain::signed_block& block ) {
+         _db.push_block( block, chain::database::skip_fork_db );
+      } );
+   }
+   return applied;
+}
+
+} } // muse::app
@@ -0,0 +1,204 @@
+#include <muse/app/subscription_manager.hpp>
+#include <muse/chain/account_object.hpp>
+#include <muse/chain/content_object.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <algorithm>
+
+namespace muse { namespace app {
+
+subscription_manager::subscription_manager( chain::database& db )
+   : _db( db )
+{
+   _changed_objects_connection = _db.changed_objects.connect( [this]( const std::vector< chain::object_id_type >& ids ) {
+      on_changed_objects( ids );
+   } );
+   _removed_objects_connection = _db.removed_objects.connect( [this]( const std::vector< const graphene::db::object* >& objects ) {
+      on_removed_objects( objects );
+   } );
+}
+
+subscription_manager::~subscription_manager()
+{
+   if( _delivery_task.valid() && !_delivery_task.ready() )
+      _delivery_task.cancel_and_wait( "subscription_manager destroyed" );
+}
+
+subscription_manager::session_id subscription_manager::add_session( callback_type callback )
+{
+   session_id id = _next_session++;
+   _sessions[ id ].callback = std::move( callback );
+   return id;
+}
+
+void subscription_manager::set_callback( session_id session, callback_type callback )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end(), "Subscription session ${s} is not registered", ("s",session) );
+   itr->second.callback = std::move( callback );
+}
+
+void subscription_manager::remove_session( session_id session )
+{
+   if( _sessions.find( session ) == _sessions.end() )
+      return;
+   forget_interests( session );
+   _sessions.erase( session );
+}
+
+void subscription_manager::subscribe( session_id session, const subscription_interests& interests )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end(), "Subscription session ${s} is not registered", ("s",session) );
+   for( const chain::object_id_type& id : interests.objects )
+      if( itr->second.objects.insert( id ).second )
+         _by_object[ id ].insert( session );
+   for( const std::string& name : interests.accounts )
+      if( itr->second.accounts.insert( name ).second )
+         _by_account[ name ].insert( session );
+   for( const std::string& url : interests.content )
+      if( itr->second.content.insert( url ).second )
+         _by_content[ url ].insert( session );
+}
+
+void subscription_manager::clear_interests( session_id session )
+{
+   if( _sessions.find( session ) != _sessions.end() )
+      forget_interests( session );
+}
+
+void subscription_manager::forget_interests( session_id session )
+{
+   struct helper
+   {
+      template< typename Index, typename Keys >
+      static void erase( Index& index, Keys& keys, session_id session )
+      {
+         for( const auto& key : keys )
+         {
+            auto itr = index.find( key );
+            if( itr == index.end() )
+               continue;
+            itr->second.erase( session );
+            if( itr->second.empty() )
+               index.erase( itr );
+         }
+         keys.clear();
+      }
+   };
+   session& s = _sessions.at( session );
+   helper::erase( _by_object, s.objects, session );
+   helper::erase( _by_account, s.accounts, session );
+   helper::erase( _by_content, s.content, session );
+}
+
+void subscription_manager::on_changed_objects( const std::vector< chain::object_id_type >& ids )
+{
+   if( _sessions.empty() )
+      return;
+   for( const chain::object_id_type& id : ids )
+      if( _changed_set.insert( id ).second )
+         _changed.push_back( id );
+   schedule_delivery();
+}
+
+void subscription_manager::on_removed_objects( const std::vector< const graphene::db::object* >& objects )
+{
+   // removed objects cannot be looked up at delivery time, so their name or url is matched now
+   if( _by_account.empty() && _by_content.empty() )
+      return;
+   std::vector< session_id > matched;
+   for( const graphene::db::object* obj : objects )
+   {
+      matched.clear();
+      match( obj, obj->id, matched );
+      if( !matched.empty() )
+      {
+         std::vector< session_id >& removed = _removed_matches[ obj->id ];
+         removed.insert( removed.end(), matched.begin(), matched.end() );
+      }
+   }
+}
+
+void subscription_manager::schedule_delivery()
+{
+   // runs once the chain thread is done with the block or transaction being pushed
+   if( !_delivery_task.valid() || _delivery_task.ready() )
+      _delivery_task = fc::async( [this]() { deliver(); }, "subscription_manager::deliver" );
+}
+
+void subscription_manager::match_key( const key_index& index, const std::string& key, std::vector< session_id >& result )const
+{
+   auto itr = index.find( key );
+   if( itr != index.end() )
+      result.insert( result.end(), itr->second.begin(), itr->second.end() );
+}
+
+void subscription_manager::match( const graphene::db::object* obj, chain::object_id_type id, std::vector< session_id >& result )const
+{
+   auto itr = _by_object.find( id );
+   if( itr != _by_object.end() )
+      result.insert( result.end(), itr->second.begin(), itr->second.end() );
+   if( obj == nullptr || id.space() != chain::account_object::space_id )
+      return;
+   if( id.type() == chain::account_object::type_id && !_by_account.empty() )
+      match_key( _by_account, static_cast< const chain::account_object* >( obj )->name, result );
+   else if( id.type() == chain::content_object::type_id && !_by_content.empty() )
+      match_key( _by_content, static_cast< const chain::content_object* >( obj )->url, result );
+}
+
+void subscription_manager::deliver()
+{
+   // callbacks may yield, changes reported meanwhile are delivered by the next round
+   while( !_changed.empty() )
+   {
+      std::vector< chain::object_id_type > changed;
+      std::swap( changed, _changed );
+      _changed_set.clear();
+      std::unordered_map< chain::object_id_type, std::vector< session_id > > removed;
+      std::swap( removed, _removed_matches );
+
+      std::unordered_map< session_id, fc::variants > batches;
+      std::vector< session_id > matched;
+      for( const chain::object_id_type& id : changed )
+      {
+         matched.clear();
+         const graphene::db::object* obj = _db.find_object( id );
+         match( obj, id, matched );
+         auto removed_itr = removed.find( id );
+         if( removed_itr != removed.end() )
+            matched.insert( matched.end(), removed_itr->second.begin(), removed_itr->second.end() );
+         if( matched.empty() )
+            continue;
+         std::sort( matched.begin(), matched.end() );
+         matched.erase( std::unique( matched.begin(), matched.end() ), matched.end() );
+
+         // one conversion per object, the sessions share the variant's object data
+         const fc::variant value = obj != nullptr ? obj->to_variant() : fc::variant( id );
+         for( session_id session : matched )
+            batches[ session ].push_back( value );
+      }
+
+      for( auto& batch : batches )
+      {
+         // a callback that yields can let its own or any other session be removed, so the session
+         // is looked up for every batch and the callback runs from a copy
+         auto itr = _sessions.find( batch.first );
+         if( itr == _sessions.end() || !itr->second.callback )
+            continue;
+         const callback_type callback = itr->second.callback;
+         try
+         {
+            callback( fc::variant( std::move( batch.second ) ) );
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Dropping subscription session ${s} after failed notification: ${e}", ("s",batch.first)("e",e.to_string()) );
+            remove_session( batch.first );
+         }
+      }
+   }
+}
+
+} } // muse::app
@@ -0,0 +1,133 @@
+#include <muse/app/transaction_admission_queue.hpp>
+
+#include <graphene/net/exceptions.hpp>
+
+#include <fc/thread/thread.hpp>
+
+namespace muse { namespace app {
+
+transaction_admission_queue::transaction_admission_queue( chain::database& db, uint32_t max_queue_depth, uint32_t thread_count )
+   : _db( db )
+{
+   _stats.max_queue_depth = max_queue_depth;
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.emplace_back( new fc::thread( "transaction_check_" + std::to_string( i ) ) );
+}
+
+transaction_admission_queue::~transaction_admission_queue()
+{
+   if( _push_task.valid() && !_push_task.ready() )
+      _push_task.cancel_and_wait( "transaction_admission_queue destroyed" );
+   for( auto* queue : { &_local_queue, &_network_queue } )
+      for( auto& checked : *queue )
+         checked.pushed->set_exception( std::make_shared< fc::canceled_exception >(
+               FC_LOG_MESSAGE( warn, "transaction_admission_queue destroyed" ) ) );
+}
+
+void transaction_admission_queue::push_transaction( const chain::signed_transaction& trx, bool local )
+{
+   if( !local && _stats.queue_depth >= _stats.max_queue_depth )
+   {
+      ++_stats.dropped;
+      FC_THROW_EXCEPTION( graphene::net::transaction_queue_full, "Transaction queue is full",
+                          ("queue_depth",_stats.queue_depth)("trx_id",trx.id()) );
+   }
+
+   // queue_depth counts the transaction until push_checked_transactions() is done with it
+   ++_stats.queue_depth;
+   checked_transaction checked;
+   try
+   {
+      checked.trx = std::make_shared< chain::signed_transaction >( trx );
+      checked.signature_keys = check_transaction( checked.trx );
+   }
+   catch( const fc::canceled_exception& )
+   {
+      --_stats.queue_depth;
+      throw;
+   }
+   catch( ... )
+   {
+      --_stats.queue_depth;
+      ++_stats.rejected;
+      throw;
+   }
+
+   checked.pushed = fc::promise< void >::ptr( new fc::promise< void >( "transaction_admission_queue::pushed" ) );
+   fc::future< void > pushed( checked.pushed );
+   ( local ? _local_queue : _network_queue ).push_back( std::move( checked ) );
+   if( !_push_task.valid() || _push_task.ready() )
+      _push_task = fc::async( [this]() { push_checked_transactions(); }, "push_checked_transactions" );
+
+   // a network transaction that fails to apply must not be relayed, so every caller waits
+   pushed.wait();
+}
+
+fc::flat_set< chain::public_key_type > transaction_admission_queue::check_transaction( const std::shared_ptr< const chain::signed_transaction >& trx )
+{
+   auto check = [trx]() {
+      trx->validate();
+      return trx->get_signature_keys( MUSE_CHAIN_ID );
+   };
+   if( _threads.empty() )
+      return check();
+   // waiting yields, so the chain thread keeps working while the transaction is checked
+   return _threads[ _next_thread++ % _threads.size() ]->async( check, "check_transaction" ).wait();
+}
+
+void transaction_admission_queue::push_checked_transactions()
+{
+   // everything queued while earlier transactions were being checked is pushed in one batch
+   while( !_local_queue.empty() || !_network_queue.empty() )
+   {
+      std::vector< checked_transaction > batch;
+      batch.reserve( _local_queue.size() + _network_queue.size() );
+      for( auto& checked : _local_queue )
+         batch.push_back( std::move( checked ) );
+      for( auto& checked : _network_queue )
+         batch.push_back( std::move( checked ) );
+      _local_queue.clear();
+      _network_queue.clear();
+
+      std::vector< chain::database::batched_transaction > trxs;
+      trxs.reserve( batch.size() );
+      for( const auto& checked : batch )
+         trxs.push_back( chain::database::batched_transaction{ checked.trx.get(), &checked.signature_keys } );
+
+      // validate() already ran in check_transaction()
+      std::vector< fc::exception_ptr > results;
+      try
+      {
+         results = _db.push_transactions( trxs, chain::database::skip_validate );
+      }
+      catch( const fc::exception& e )
+      {
+         results.assign( batch.size(), e.dynamic_copy_exception() );
+      }
+      catch( const std::exception& e )
+      {
+         results.assign( batch.size(), fc::unhandled_exception( FC_LOG_MESSAGE( warn, "${e}", ("e", e.what()) ) ).dynamic_copy_exception() );
+      }
+      catch( ... )
+      {
+         results.assign( batch.size(), fc::unhandled_exception( FC_LOG_MESSAGE( warn, "${e}", ("e", fc::except_str()) ) ).dynamic_copy_exception() );
+      }
+
+      for( size_t i = 0; i < batch.size(); ++i )
+      {
+         --_stats.queue_depth;
+         if( results[i] )
+         {
+            ++_stats.rejected;
+            batch[i].pushed->set_exception( results[i] );
+         }
+         else
+         {
+            ++_stats.admitted;
+            batch[i].pushed->set_value();
+         }
+      }
+   }
+}
+
+} } // muse::app
@@ -0,0 +1,95 @@
+#include <muse/app/transaction_confirmation_tracker.hpp>
+
+#include <fc/thread/thread.hpp>
+
+namespace muse { namespace app {
+
+transaction_confirmation_tracker::transaction_confirmation_tracker( chain::database& db )
+   : _db( db )
+{
+   _applied_block_connection = _db.applied_block.connect( [this]( const chain::signed_block& b ) {
+      on_applied_block( b );
+   } );
+}
+
+transaction_confirmation_tracker::~transaction_confirmation_tracker()
+{
+   if( _delivery_task.valid() && !_delivery_task.ready() )
+      _delivery_task.cancel_and_wait( "transaction_confirmation_tracker destroyed" );
+}
+
+void transaction_confirmation_tracker::watch( const chain::signed_transaction& trx, callback_type callback )
+{
+   chain::transaction_id_type id = trx.id();
+   auto itr = _waiting.find( id );
+   if( itr == _waiting.end() )
+   {
+      itr = _waiting.emplace( id, waiting_transaction() ).first;
+      itr->second.expiration = _expirations.emplace( trx.expiration, id );
+   }
+   itr->second.callbacks.push_back( std::move( callback ) );
+}
+
+void transaction_confirmation_tracker::on_applied_block( const chain::signed_block& b )
+{
+   if( _waiting.empty() )
+      return;
+   int32_t block_num = int32_t( b.block_num() );
+
+   const std::vector< chain::transaction_id_type >& ids = _db.applied_block_transaction_ids();
+   for( size_t trx_num = 0; trx_num < ids.size(); ++trx_num )
+   {
+      auto itr = _waiting.find( ids[ trx_num ] );
+      if( itr == _waiting.end() )
+         continue;
+      _ready.emplace_back( transaction_confirmation{ itr->first, block_num, int32_t( trx_num ), false },
+                           std::move( itr->second.callbacks ) );
+      _expirations.erase( itr->second.expiration );
+      _waiting.erase( itr );
+   }
+
+   auto end = _expirations.upper_bound( b.timestamp );
+   for( auto itr = _expirations.begin(); itr != end; ++itr )
+   {
+      auto waiting = _waiting.find( itr->second );
+      _ready.emplace_back( transaction_confirmation{ itr->second, block_num, -1, true }, std::move( waiting->second.callbacks ) );
+      _waiting.erase( waiting );
+   }
+   _expirations.erase( _expirations.begin(), end );
+
+   // runs once the chain thread is done with the block
+   if( !_ready.empty() && ( !_delivery_task.valid() || _delivery_task.ready() ) )
+      _delivery_task = fc::async( [this]() { deliver(); }, "transaction_confirmation_tracker::deliver" );
+}
+
+void transaction_confirmation_tracker::deliver()
+{
+   // callbacks may yield, confirmations of later blocks are delivered by the next round
+   while( !_ready.empty() )
+   {
+      std::vector< std::pair< transaction_confirmation, std::vector< callback_type > > > ready;
+      std::swap( ready, _ready );
+      for( const auto& entry : ready )
+      {
+         const fc::variant confirmation( entry.first, GRAPHENE_MAX_NESTED_OBJECTS );
+         for( const callback_type& callback : entry.second )
+         {
+            try
+            {
+               callback( confirmation );
+            }
+            catch( const fc::canceled_exception& )
+            {
+               throw;
+            }
+            catch( const fc::exception& e )
+            {
+               // the session that was waiting has gone away
+               dlog( "transaction confirmation callback failed: ${e}", ("e",e.to_string()) );
+            }
+         }
+      }
+   }
+}
+
+} } // muse::app
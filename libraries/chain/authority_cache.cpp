@@ -0,0 +1,82 @@
+#include <muse/chain/authority_cache.hpp>
+#include <muse/chain/database.hpp>
+
+namespace muse { namespace chain {
+
+namespace detail {
+
+   class account_removal_observer : public graphene::db::index_observer
+   {
+      public:
+         account_removal_observer( authority_cache& c ) : _cache( c ) {}
+
+         virtual void on_remove( const graphene::db::object& obj ) override
+         {
+            _cache.on_account_removed( static_cast< const account_object& >( obj ) );
+         }
+
+      private:
+         authority_cache& _cache;
+   };
+
+   class content_removal_observer : public graphene::db::index_observer
+   {
+      public:
+         content_removal_observer( authority_cache& c ) : _cache( c ) {}
+
+         virtual void on_remove( const graphene::db::object& obj ) override
+         {
+            _cache.on_content_removed( static_cast< const content_object& >( obj ) );
+         }
+
+      private:
+         authority_cache& _cache;
+   };
+
+} // detail
+
+const account_object& authority_cache::get_account( const string& name )
+{
+   auto itr = _accounts.find( name );
+   if( itr != _accounts.end() )
+   {
+      ++_hits;
+      return *itr->second;
+   }
+   ++_misses;
+   const account_object& result = _db.get_account( name );
+   _accounts.emplace( name, &result );
+   return result;
+}
+
+const content_object& authority_cache::get_content( const string& url )
+{
+   auto itr = _contents.find( url );
+   if( itr != _contents.end() )
+   {
+      ++_hits;
+      return *itr->second;
+   }
+   ++_misses;
+   const content_object& result = _db.get_content( url );
+   _contents.emplace( url, &result );
+   return result;
+}
+
+void authority_cache::clear()
+{
+   _accounts.clear();
+   _contents.clear();
+}
+
+std::shared_ptr< graphene::db::index_observer > authority_cache::make_account_observer()
+{
+   return std::make_shared< detail::account_removal_observer >( *this );
+}
+
+std::shared_ptr< graphene::db::index_observer > authority_cache::make_content_observer()
+{
+   return std::make_shared< detail::content_removal_observer >( *this );
+}
+
+} } // muse::chain
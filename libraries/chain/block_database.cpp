@@ -46,12 +46,14 @@ void block_database::close()
 
 void block_database::flush()
 {
+  std::lock_guard< std::mutex > lock( _io_mutex );
   _blocks.flush();
   _block_num_to_pos.flush();
 }
 
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
+   std::lock_guard< std::mutex > lock( _io_mutex );
    block_id_type id = _id;
    if( id == block_id_type() )
    {
@@ -72,6 +74,7 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
 
 void block_database::remove( const block_id_type& id )
 { try {
+   std::lock_guard< std::mutex > lock( _io_mutex );
    index_entry e;
    auto index_pos = sizeof(e)*block_header::num_from_id(id);
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -94,6 +97,7 @@ bool block_database::contains( const block_id_type& id )const
    if( id == block_id_type() )
       return false;
 
+   std::lock_guard< std::mutex > lock( _io_mutex );
    index_entry e;
    auto index_pos = sizeof(e)*block_header::num_from_id(id);
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -108,6 +112,7 @@ bool block_database::contains( const block_id_type& id )const
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
+   std::lock_guard< std::mutex > lock( _io_mutex );
    index_entry e;
    auto index_pos = sizeof(e)*block_num;
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
@@ -123,6 +128,7 @@ block_id_type block_database::fetch_block_id( uint32_t block_num )const
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
+   std::lock_guard< std::mutex > lock( _io_mutex );
    try
    {
       index_entry e;
@@ -155,6 +161,7 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
 
 optional<signed_block> block_database::fetch_by_number( uint32_t block_num )const
 {
+   std::lock_guard< std::mutex > lock( _io_mutex );
    try
    {
       index_entry e;
@@ -182,7 +189,56 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    return optional<signed_block>();
 }
 
+vector< vector<char> > block_database::fetch_range_packed( uint32_t start_num, uint32_t count )const
+{
+   vector< vector<char> > result;
+   if( start_num == 0 || count == 0 )
+      return result;
+
+   std::lock_guard< std::mutex > lock( _io_mutex );
+   const uint64_t index_pos = sizeof(index_entry) * uint64_t(start_num);
+   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
+   const uint64_t index_size = _block_num_to_pos.tellg();
+   if( index_size <= index_pos )
+      return result;
+   count = std::min< uint64_t >( count, ( index_size - index_pos ) / sizeof(index_entry) );
+
+   vector< index_entry > entries( count );
+   _block_num_to_pos.seekg( index_pos );
+   _block_num_to_pos.read( (char*)entries.data(), count * sizeof(index_entry) );
+   for( size_t i = 0; i < entries.size(); ++i )
+      if( entries[i].block_size == 0 || entries[i].block_id == block_id_type() )
+      {
+         entries.resize( i );
+         break;
+      }
+
+   result.reserve( entries.size() );
+   vector<char> chunk;
+   for( size_t first = 0; first < entries.size(); )
+   {
+      // blocks appended one after another are read with a single read()
+      size_t last = first;
+      while( last + 1 < entries.size()
+             && entries[last + 1].block_pos == entries[last].block_pos + entries[last].block_size )
+         ++last;
+      const uint64_t chunk_size = entries[last].block_pos + entries[last].block_size - entries[first].block_pos;
+      chunk.resize( chunk_size );
+      _blocks.seekg( entries[first].block_pos );
+      _blocks.read( chunk.data(), chunk_size );
+      FC_ASSERT( uint64_t(_blocks.gcount()) == chunk_size, "Block log is shorter than its index" );
+      for( size_t i = first; i <= last; ++i )
+      {
+         const char* begin = chunk.data() + ( entries[i].block_pos - entries[first].block_pos );
+         result.emplace_back( begin, begin + entries[i].block_size );
+      }
+      first = last + 1;
+   }
+   return result;
+}
+
 optional<index_entry> block_database::last_index_entry()const {
+   std::lock_guard< std::mutex > lock( _io_mutex );
    try
    {
       index_entry e;
@@ -0,0 +1,52 @@
+#include <muse/chain/block_prevalidation.hpp>
+
+#include <fc/log/logger.hpp>
+
+namespace muse { namespace chain {
+
+prevalidated_block prevalidate_block( const signed_block& b, const chain_id_type& chain_id,
+                                      bool recover_signature_keys )
+{
+   prevalidated_block result;
+   result.block_id = b.id();
+   result.transaction_merkle_root = b.calculate_merkle_root();
+
+   try
+   {
+      result.signee = public_key_type( b.signee() );
+   }
+   catch( const fc::exception& e )
+   {
+      dlog( "unable to recover signee of block ${id}: ${e}", ("id",result.block_id)("e",e.to_detail_string()) );
+   }
+
+   try
+   {
+      for( const auto& trx : b.transactions )
+         trx.validate();
+      result.transactions_valid = true;
+   }
+   catch( const fc::exception& e )
+   {
+      dlog( "transaction in block ${id} failed validation: ${e}", ("id",result.block_id)("e",e.to_detail_string()) );
+   }
+
+   if( recover_signature_keys )
+   {
+      try
+      {
+         result.signature_keys.reserve( b.transactions.size() );
+         for( const auto& trx : b.transactions )
+            result.signature_keys.push_back( trx.get_signature_keys( chain_id ) );
+      }
+      catch( const fc::exception& e )
+      {
+         result.signature_keys.clear();
+         dlog( "unable to recover signature keys in block ${id}: ${e}", ("id",result.block_id)("e",e.to_detail_string()) );
+      }
+   }
+
+   return result;
+}
+
+} } // muse::chain
@@ -0,0 +1,144 @@
+#include <muse/chain/block_profiler.hpp>
+#include <muse/chain/protocol/operations.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/log/logger.hpp>
+
+namespace muse { namespace chain {
+
+/** number of slow transaction records kept for get_slow_transactions */
+static const size_t max_slow_transactions = 100;
+
+void timing_histogram::record( uint64_t us )
+{
+   ++count;
+   total_us += us;
+   if( us > max_us )
+      max_us = us;
+
+   uint32_t bucket = 0;
+   while( us > 0 && bucket < bucket_count - 1 )
+   {
+      us >>= 1;
+      ++bucket;
+   }
+   ++buckets[bucket];
+}
+
+block_profiler::block_profiler()
+{
+   reset();
+}
+
+void block_profiler::open_trace_file( const fc::path& p )
+{ try {
+   close_trace_file();
+   _trace.open( p.generic_string().c_str(), std::ofstream::binary | std::ofstream::out | std::ofstream::app );
+   FC_ASSERT( _trace, "Unable to open block profiler trace file", ("path",p) );
+} FC_CAPTURE_AND_RETHROW( (p) ) }
+
+void block_profiler::close_trace_file()
+{
+   if( _trace.is_open() )
+      _trace.close();
+}
+
+void block_profiler::begin_block( uint32_t block_num )
+{
+   if( !_enabled )
+      return;
+
+   _block_start = fc::time_point::now();
+   _current.block_num = block_num;
+   _current.total_us = 0;
+   _current.phase_us.assign( APPLY_BLOCK_PHASE_COUNT, 0 );
+}
+
+void block_profiler::end_block()
+{
+   if( !_enabled || _block_start == fc::time_point() )
+      return;
+
+   _current.total_us = ( fc::time_point::now() - _block_start ).count();
+   _blocks.record( _current.total_us );
+   _block_start = fc::time_point();
+   // one sample per phase and block, a phase entered more than once in a block is summed up
+   for( uint32_t phase = 0; phase < APPLY_BLOCK_PHASE_COUNT; ++phase )
+      _phases[phase].record( _current.phase_us[phase] );
+
+   if( _trace.is_open() )
+   {
+      fc::raw::pack( _trace, _current );
+      _trace.flush();
+   }
+}
+
+void block_profiler::record_phase( apply_block_phase phase, uint64_t us )
+{
+   if( in_block() )
+      _current.phase_us[phase] += us;
+}
+
+void block_profiler::record_operation( int64_t which, uint64_t us, uint64_t objects_written, uint64_t bytes_allocated )
+{
+   if( which < 0 || uint64_t( which ) >= _operations.size() )
+      return;
+   operation_profile& profile = _operations[which];
+   profile.timing.record( us );
+   profile.objects_written += objects_written;
+   profile.bytes_allocated += bytes_allocated;
+}
+
+void block_profiler::record_transaction( const transaction_id_type& trx_id, uint32_t block_num, uint64_t us,
+                                         const std::vector< int64_t >& operations )
+{
+   if( !_slow_transaction_ids.insert( trx_id ).second )
+      return;
+   wlog( "Slow transaction ${id} in block ${b} took ${us} us, operations: ${ops}",
+         ("id",trx_id)("b",block_num)("us",us)("ops",operations) );
+
+   _slow_transactions.emplace_back();
+   slow_transaction_record& rec = _slow_transactions.back();
+   rec.trx_id = trx_id;
+   rec.block_num = block_num;
+   rec.when = fc::time_point::now();
+   rec.duration_us = us;
+   rec.operations = operations;
+   while( _slow_transactions.size() > max_slow_transactions )
+   {
+      _slow_transaction_ids.erase( _slow_transactions.front().trx_id );
+      _slow_transactions.pop_front();
+   }
+}
+
+void block_profiler::reset()
+{
+   _phases.assign( APPLY_BLOCK_PHASE_COUNT, timing_histogram() );
+   _operations.assign( operation::count(), operation_profile() );
+   _blocks = timing_histogram();
+   _slow_transactions.clear();
+   _slow_transaction_ids.clear();
+}
+
+void block_profiler::phase_timer::start( apply_block_phase phase )
+{
+   if( !_profiler.enabled() )
+      return;
+
+   fc::time_point now = fc::time_point::now();
+   if( _phase != APPLY_BLOCK_PHASE_COUNT )
+      _profiler.record_phase( _phase, ( now - _start ).count() );
+   _phase = phase;
+   _start = now;
+}
+
+void block_profiler::phase_timer::stop()
+{
+   if( _phase == APPLY_BLOCK_PHASE_COUNT )
+      return;
+
+   _profiler.record_phase( _phase, ( fc::time_point::now() - _start ).count() );
+   _phase = APPLY_BLOCK_PHASE_COUNT;
+}
+
+} } // muse::chain
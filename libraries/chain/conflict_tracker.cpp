@@ -0,0 +1,74 @@
+#include <muse/chain/conflict_tracker.hpp>
+
+namespace muse { namespace chain {
+
+namespace detail {
+
+   class conflict_observer : public graphene::db::index_observer
+   {
+      public:
+         conflict_observer( conflict_tracker& t ) : _tracker( t ) {}
+
+         virtual void on_add( const graphene::db::object& obj ) override    { _tracker.on_write( obj.id ); }
+         virtual void on_remove( const graphene::db::object& obj ) override { _tracker.on_write( obj.id ); }
+         virtual void on_modify( const graphene::db::object& obj ) override { _tracker.on_write( obj.id ); }
+
+      private:
+         conflict_tracker& _tracker;
+   };
+
+} // detail
+
+std::shared_ptr< graphene::db::index_observer > conflict_tracker::make_observer()
+{
+   return std::make_shared< detail::conflict_observer >( *this );
+}
+
+void conflict_tracker::begin_block()
+{
+   if( !_enabled )
+      return;
+   _in_transaction = false;
+   _block_writes.clear();
+}
+
+void conflict_tracker::begin_transaction()
+{
+   if( !_enabled )
+      return;
+   _trx_writes.clear();
+   _in_transaction = true;
+}
+
+void conflict_tracker::on_write( const object_id_type& id )
+{
+   if( _in_transaction )
+      _trx_writes.insert( id );
+}
+
+void conflict_tracker::end_transaction()
+{
+   if( !_in_transaction )
+      return;
+   _in_transaction = false;
+
+   bool conflicting = false;
+   for( const auto& id : _trx_writes )
+      if( !_block_writes.insert( id ).second )
+         conflicting = true;
+
+   ++_stats.transactions;
+   _stats.objects_written += _trx_writes.size();
+   if( conflicting )
+      ++_stats.write_conflicting_transactions;
+}
+
+void conflict_tracker::end_block()
+{
+   if( !_enabled )
+      return;
+
+   ++_stats.blocks;
+}
+
+} } // muse::chain
@@ -88,11 +88,20 @@ database::~database()
    clear_pending();
 }
 
+/** switches conflict tracking off when open() is done replaying, however it ends */
+struct conflict_tracking_guard
+{
+   explicit conflict_tracking_guard( conflict_tracker& t ) : tracker( t ) {}
+   ~conflict_tracking_guard() { tracker.set_enabled( false ); }
+   conflict_tracker& tracker;
+};
+
 void database::open( const fc::path& data_dir, const genesis_state_type& initial_allocation,
                      const std::string& db_version )
 {
    try
    {
+      conflict_tracking_guard conflict_guard( _conflict_tracker );
       bool wipe_object_db = false;
       if( !fc::exists( data_dir / "db_version" ) )
          wipe_object_db = true;
@@ -243,11 +252,24 @@ void database::reindex( fc::path data_dir )
 
       auto end = fc::time_point::now();
       ilog( "Done reindexing, elapsed time: ${t} sec", ("t",double((end-start).count())/1000000.0 ) );
+
+      if( _conflict_tracker.enabled() )
+         ilog( "Transaction write conflicts during replay, reads not counted: ${s}", ("s", _conflict_tracker.get_stats()) );
    }
    FC_CAPTURE_AND_RETHROW( (data_dir) )
 
 }
 
+void database::enable_conflict_tracking()
+{
+   if( !_conflict_observer_added )
+   {
+      add_index_observer( _conflict_tracker.make_observer() );
+      _conflict_observer_added = true;
+   }
+   _conflict_tracker.set_enabled( true );
+}
+
 void database::wipe(const fc::path& data_dir, bool include_blocks)
 {
    ilog("Wiping database", ("include_blocks", include_blocks));
@@ -259,12 +281,39 @@ void database::wipe(const fc::path& data_dir, bool include_blocks)
       fc::remove_all( data_dir / "database" );
 }
 
+void database::lock_state_for_write()
+{
+   // the owner is another fiber of this thread, blocking on the mutex would keep it from finishing
+   while( _state_write_locked )
+   {
+      if( !_state_write_released )
+         _state_write_released = fc::promise< void >::ptr( new fc::promise< void >( "database::state_write_released" ) );
+      fc::future< void >( _state_write_released ).wait();
+   }
+   // only readers on other threads can hold it now, they don't wait for this thread
+   _state_mutex.lock();
+   _state_write_locked = true;
+}
+
+void database::unlock_state_for_write()
+{
+   _state_write_locked = false;
+   _state_mutex.unlock();
+   if( _state_write_released )
+   {
+      fc::promise< void >::ptr released = _state_write_released;
+      _state_write_released.reset();
+      released->set_value();
+   }
+}
+
 void database::close(bool rewind)
 {
    try
    {
       if( !_block_id_to_block.is_open() ) return;
       ilog( "Closing database" );
+      state_write_lock write_lock( *this );
 
       // pop all of the blocks that we can given our undo history, this should
       // throw when there is no more undo history to pop
@@ -349,6 +398,15 @@ optional<signed_block> database::fetch_block_by_number( uint32_t num )const
    return optional<signed_block>();
 }
 
+vector< vector<char> > database::fetch_block_range_packed( uint32_t start_num, uint32_t count )const
+{
+   // blocks popped without being replaced are still in the block log
+   if( start_num > head_block_num() )
+      return vector< vector<char> >();
+   count = std::min( count, head_block_num() - start_num + 1 );
+   return _block_id_to_block.fetch_range_packed( start_num, count );
+}
+
 const signed_transaction& database::get_recent_transaction(const transaction_id_type& trx_id) const
 {
    auto& index = get_index_type<transaction_index>().indices().get<by_trx_id>();
@@ -586,9 +644,11 @@ bool database::before_last_checkpoint()const
  *
  * @return true if we switched forks as a result of this push.
  */
-bool database::push_block(const signed_block& new_block, uint32_t skip)
+bool database::push_block(const signed_block& new_block, uint32_t skip, const prevalidated_block* pre)
 {
+   state_write_lock write_lock( *this );
    bool result;
+   detail::pointer_restorer< prevalidated_block > restorer( _pushed_prevalidated_block, pre );
    detail::with_skip_flags( *this, skip, [&]()
    {
       detail::without_pending_transactions( *this, std::move(_pending_tx),
@@ -697,13 +757,16 @@ bool database::_push_block(const signed_block& new_block)
  * queues full as well, it will be kept in the queue to be propagated later when a new block flushes out the pending
  * queues.
  */
-void database::push_transaction( const signed_transaction& trx, uint32_t skip )
+void database::push_transaction( const signed_transaction& trx, uint32_t skip,
+                                 const flat_set< public_key_type >* signature_keys )
 {
    try
    {
       try
       {
+         state_write_lock write_lock( *this );
          FC_ASSERT( fc::raw::pack_size(trx) <= (get_dynamic_global_properties().maximum_block_size - 256) );
+         detail::pointer_restorer< flat_set< public_key_type > > restorer( _pushed_signature_keys, signature_keys );
          set_producing( true );
          detail::with_skip_flags( *this, skip, [&]() { _push_transaction( trx ); } );
          set_producing(false);
@@ -717,6 +780,56 @@ void database::push_transaction( const signed_transaction& trx, uint32_t skip )
    FC_CAPTURE_AND_RETHROW( (trx) )
 }
 
+vector< fc::exception_ptr > database::push_transactions( const vector< batched_transaction >& trxs, uint32_t skip )
+{
+   vector< fc::exception_ptr > results( trxs.size() );
+   state_write_lock write_lock( *this );
+   try
+   {
+      set_producing( true );
+      detail::with_skip_flags( *this, skip, [&]()
+      {
+         if( !_pending_tx_session.valid() )
+            _pending_tx_session = _undo_db.start_undo_session();
+
+         auto batch_session = _undo_db.start_undo_session();
+         const uint32_t max_trx_size = get_dynamic_global_properties().maximum_block_size - 256;
+         for( size_t i = 0; i < trxs.size(); ++i )
+         {
+            const signed_transaction& trx = *trxs[i].trx;
+            try
+            {
+               FC_ASSERT( fc::raw::pack_size(trx) <= max_trx_size );
+               detail::pointer_restorer< flat_set< public_key_type > > restorer( _pushed_signature_keys, trxs[i].signature_keys );
+               auto trx_session = _undo_db.start_undo_session();
+               _apply_transaction( trx );
+               _pending_tx.push_back( trx );
+               trx_session.merge();
+               on_pending_transaction( trx );
+            }
+            catch( const fc::exception& e )
+            {
+               results[i] = e.dynamic_copy_exception();
+            }
+            catch( const std::exception& e )
+            {
+               results[i] = fc::unhandled_exception( FC_LOG_MESSAGE( warn, "${e}", ("e", e.what()) ) ).dynamic_copy_exception();
+            }
+         }
+
+         notify_changed_objects();
+         batch_session.merge();
+      } );
+      set_producing( false );
+   }
+   catch( ... )
+   {
+      set_producing( false );
+      throw;
+   }
+   return results;
+}
+
 void database::_push_transaction( const signed_transaction& trx )
 {
    // If this is the first transaction pushed after applying a block, start a new undo session.
@@ -748,6 +861,7 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 {
+   state_write_lock write_lock( *this );
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -892,6 +1006,7 @@ void database::pop_block()
 {
    try
    {
+      state_write_lock write_lock( *this );
       _pending_tx_session.reset();
       auto head_id = head_block_id();
 
@@ -912,6 +1027,7 @@ void database::clear_pending()
 {
    try
    {
+      state_write_lock write_lock( *this );
       assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
       _pending_tx.clear();
       _pending_tx_session.reset();
@@ -1109,6 +1225,8 @@ vector<string> database::get_voted_streaming_platforms()
 void database::update_witness_schedule4()
 {
    vector<string> active_witnesses;
+   active_witnesses.reserve( MUSE_MAX_MINERS );
+   const bool skip_unsigned = has_hardfork( MUSE_HARDFORK_0_3 );
 
    /// Add the highest voted witnesses
    flat_set<witness_id_type> selected_voted;
@@ -1118,7 +1236,7 @@ void database::update_witness_schedule4()
         itr != widx.end() && selected_voted.size() <  MUSE_MAX_VOTED_WITNESSES;
         ++itr )
    {
-      if( has_hardfork( MUSE_HARDFORK_0_3 ) && (itr->signing_key == public_key_type()) )
+      if( skip_unsigned && (itr->signing_key == public_key_type()) )
          continue; // skip witnesses without a valid block signing key
       selected_voted.insert(itr->get_id());
       active_witnesses.push_back(itr->owner);
@@ -1130,13 +1248,14 @@ void database::update_witness_schedule4()
    const auto& schedule_idx = get_index_type<witness_index>().indices().get<by_schedule_time>();
    auto sitr = schedule_idx.begin();
    vector<decltype(sitr)> processed_witnesses;
+   processed_witnesses.reserve( MUSE_MAX_MINERS );
    for( auto witness_count = selected_voted.size();
         sitr != schedule_idx.end() && witness_count < MUSE_MAX_MINERS;
         ++sitr )
    {
       new_virtual_time = sitr->virtual_scheduled_time; /// everyone advances to at least this time
       processed_witnesses.push_back(sitr);
-      if( has_hardfork( MUSE_HARDFORK_0_3 ) && sitr->signing_key == public_key_type() )
+      if( skip_unsigned && sitr->signing_key == public_key_type() )
          continue; // skip witnesses without a valid block signing key
       if( selected_voted.find(sitr->get_id()) == selected_voted.end() )
       {
@@ -1176,19 +1295,14 @@ void database::update_witness_schedule4()
    flat_map< version, uint32_t, std::greater< version > > witness_versions;
    flat_map< std::tuple< hardfork_version, time_point_sec >, uint32_t > hardfork_version_votes;
 
-   for( uint32_t i = 0; i < wso.current_shuffled_witnesses.size(); i++ )
-   {
-      auto witness = get_witness( wso.current_shuffled_witnesses[ i ] );
-      if( witness_versions.find( witness.running_version ) == witness_versions.end() )
-         witness_versions[ witness.running_version ] = 1;
-      else
-         witness_versions[ witness.running_version ] += 1;
+   witness_versions.reserve( wso.current_shuffled_witnesses.size() );
+   hardfork_version_votes.reserve( wso.current_shuffled_witnesses.size() );
 
-      auto version_vote = std::make_tuple( witness.hardfork_version_vote, witness.hardfork_time_vote );
-      if( hardfork_version_votes.find( version_vote ) == hardfork_version_votes.end() )
-         hardfork_version_votes[ version_vote ] = 1;
-      else
-         hardfork_version_votes[ version_vote ] += 1;
+   for( const auto& wname : wso.current_shuffled_witnesses )
+   {
+      const witness_object& witness = get_witness( wname );
+      ++witness_versions[ witness.running_version ];
+      ++hardfork_version_votes[ std::make_tuple( witness.hardfork_version_vote, witness.hardfork_time_vote ) ];
    }
 
    int witnesses_on_version = 0;
@@ -1210,15 +1324,20 @@ void database::update_witness_schedule4()
 
    auto hf_itr = hardfork_version_votes.begin();
 
+   const hardfork_property_object& hardforks = hardfork_property_id_type()( *this );
+
    while( hf_itr != hardfork_version_votes.end() )
    {
       if( hf_itr->second >= MUSE_HARDFORK_REQUIRED_WITNESSES )
       {
-         modify( hardfork_property_id_type()( *this ), [&]( hardfork_property_object& hpo )
-         {
-            hpo.next_hardfork = std::get<0>( hf_itr->first );
-            hpo.next_hardfork_time = std::get<1>( hf_itr->first );
-         } );
+         const hardfork_version& next_hardfork = std::get<0>( hf_itr->first );
+         const time_point_sec& next_hardfork_time = std::get<1>( hf_itr->first );
+         if( hardforks.next_hardfork != next_hardfork || hardforks.next_hardfork_time != next_hardfork_time )
+            modify( hardforks, [&]( hardfork_property_object& hpo )
+            {
+               hpo.next_hardfork = next_hardfork;
+               hpo.next_hardfork_time = next_hardfork_time;
+            } );
 
          break;
       }
@@ -1227,9 +1346,9 @@ void database::update_witness_schedule4()
    }
 
    // We no longer have a majority
-   if( hf_itr == hardfork_version_votes.end() )
+   if( hf_itr == hardfork_version_votes.end() && hardforks.next_hardfork != hardforks.current_hardfork_version )
    {
-      modify( hardfork_property_id_type()( *this ), [&]( hardfork_property_object& hpo )
+      modify( hardforks, [&]( hardfork_property_object& hpo )
       {
          hpo.next_hardfork = hpo.current_hardfork_version;
       });
@@ -1290,49 +1409,43 @@ void database::update_median_witness_props()
       active.push_back(&get_witness(wname));
    }
 
-   /// sort them by account_creation_fee
-   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
-   {
-      return a->props.account_creation_fee.amount < b->props.account_creation_fee.amount;
-   } );
+   /// only the median of each property is needed, so partition around it instead of sorting
+   auto median = active.begin() + active.size()/2;
 
-   modify( wso, [&]( witness_schedule_object& _wso )
+   std::nth_element( active.begin(), median, active.end(), [&]( const witness_object* a, const witness_object* b )
    {
-     _wso.median_props.account_creation_fee = active[active.size()/2]->props.account_creation_fee;
+      return a->props.account_creation_fee.amount < b->props.account_creation_fee.amount;
    } );
+   asset account_creation_fee = (*median)->props.account_creation_fee;
 
-   /// sort them by streaming_platform_update_fee
-   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
+   std::nth_element( active.begin(), median, active.end(), [&]( const witness_object* a, const witness_object* b )
    {
-        return a->props.streaming_platform_update_fee.amount < b->props.streaming_platform_update_fee.amount;
+      return a->props.streaming_platform_update_fee.amount < b->props.streaming_platform_update_fee.amount;
    } );
+   asset streaming_platform_update_fee = (*median)->props.streaming_platform_update_fee;
 
    modify( wso, [&]( witness_schedule_object& _wso )
    {
-        _wso.median_props.streaming_platform_update_fee = active[active.size()/2]->props.streaming_platform_update_fee;
+      _wso.median_props.account_creation_fee = account_creation_fee;
+      _wso.median_props.streaming_platform_update_fee = streaming_platform_update_fee;
    } );
 
-   /// sort them by maximum_block_size
-   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
+   std::nth_element( active.begin(), median, active.end(), [&]( const witness_object* a, const witness_object* b )
    {
       return a->props.maximum_block_size < b->props.maximum_block_size;
    } );
+   auto maximum_block_size = (*median)->props.maximum_block_size;
 
-   modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& p )
-   {
-         p.maximum_block_size = active[active.size()/2]->props.maximum_block_size;
-   } );
-
-
-   /// sort them by mbd_interest_rate
-   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
+   std::nth_element( active.begin(), median, active.end(), [&]( const witness_object* a, const witness_object* b )
    {
       return a->props.mbd_interest_rate < b->props.mbd_interest_rate;
    } );
+   auto mbd_interest_rate = (*median)->props.mbd_interest_rate;
 
    modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& p )
    {
-         p.mbd_interest_rate = active[active.size()/2]->props.mbd_interest_rate;
+      p.maximum_block_size = maximum_block_size;
+      p.mbd_interest_rate = mbd_interest_rate;
    } );
 }
 
@@ -2108,8 +2221,10 @@ void database::initialize_indexes()
    _undo_db.set_max_size( MUSE_MIN_UNDO_HISTORY );
 
    //Protocol object indexes
+   _authority_cache.clear();
    auto acnt_index = add_index< primary_index<account_index> >();
    acnt_index->add_secondary_index<account_member_index>();
+   acnt_index->add_observer( _authority_cache.make_account_observer() );
 
    add_index< primary_index< streaming_platform_index > >();
    add_index< primary_index< report_index > >();
@@ -2120,7 +2235,8 @@ void database::initialize_indexes()
    add_index< primary_index< liquidity_reward_index > >();
    add_index< primary_index< limit_order_index > >();
    add_index< primary_index< escrow_index > >();
-   add_index< primary_index< content_index > >();
+   auto content_idx = add_index< primary_index< content_index > >();
+   content_idx->add_observer( _authority_cache.make_content_observer() );
    add_index< primary_index< content_approve_index> >();
 
    //Implementation object indexes
@@ -2371,10 +2487,96 @@ void database::notify_changed_objects()
          changed_ids.push_back( item.first );
          removed.emplace_back( item.second.get() );
       }
+      if( !removed.empty() )
+         removed_objects(removed);
       changed_objects(changed_ids);
    }
 } FC_CAPTURE_AND_RETHROW() }
 
+state_delta database::make_state_delta( const signed_block& block )const
+{ try {
+   const auto& head_undo = _undo_db.head();
+   state_delta result;
+   result.block = block;
+
+   vector<object_id_type> ids;
+   ids.reserve( head_undo.old_values.size() + head_undo.new_ids.size() );
+   for( const auto& item : head_undo.old_values ) ids.push_back( item.first );
+   for( const auto& item : head_undo.new_ids ) ids.push_back( item );
+   std::sort( ids.begin(), ids.end() );
+   result.upserted.resize( ids.size() );
+   for( size_t i = 0; i < ids.size(); ++i )
+   {
+      result.upserted[i].id = ids[i];
+      result.upserted[i].data = get_object( ids[i] ).pack();
+   }
+
+   result.removed.reserve( head_undo.removed.size() );
+   for( const auto& item : head_undo.removed ) result.removed.push_back( item.first );
+   std::sort( result.removed.begin(), result.removed.end() );
+
+   result.next_ids.reserve( head_undo.old_index_next_ids.size() );
+   for( const auto& item : head_undo.old_index_next_ids )
+      result.next_ids.push_back( get_index( item.first ).get_next_id() );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (block.block_num()) ) }
+
+void database::apply_state_delta( const state_delta& delta )
+{ try {
+   state_write_lock write_lock( *this );
+   detail::without_pending_transactions( *this, std::move(_pending_tx), [&]()
+   {
+      FC_ASSERT( delta.block.previous == head_block_id(), "State delta does not build on the head block",
+                 ("previous",delta.block.previous)("head",head_block_id()) );
+
+      auto session = _undo_db.start_undo_session();
+      for( const auto& id : delta.removed )
+      {
+         if( find_index( id.space(), id.type() ) != nullptr )
+            remove( get_object( id ) );
+      }
+      // modified objects are removed first and created again, so that objects of the block may
+      // exchange unique keys; the undo state records an object removed and created again as modified
+      for( const auto& item : delta.upserted )
+      {
+         if( find_index( item.id.space(), item.id.type() ) == nullptr )
+            continue;
+         const object* obj = find_object( item.id );
+         if( obj != nullptr )
+            remove( *obj );
+      }
+      flat_map< object_id_type, object_id_type > old_next_ids;
+      for( const auto& item : delta.upserted )
+      {
+         if( find_index( item.id.space(), item.id.type() ) == nullptr )
+            continue;
+         graphene::db::index& idx = get_mutable_index( item.id );
+         old_next_ids.emplace( object_id_type( item.id.space(), item.id.type(), 0 ), idx.get_next_id() );
+         // create() assigns the next id of the index, make that the id the object has on the primary
+         idx.set_next_id( item.id );
+         idx.create( [&idx,&item]( object& o ) { idx.object_from_packed( item.data, o ); } );
+      }
+      for( const auto& next_id : old_next_ids )
+         get_mutable_index( next_id.second ).set_next_id( next_id.second );
+      for( const auto& next_id : delta.next_ids )
+      {
+         if( find_index( next_id.space(), next_id.type() ) != nullptr )
+            get_mutable_index( next_id ).set_next_id( next_id );
+      }
+      _block_id_to_block.store( delta.block.id(), delta.block );
+
+      _applied_block_trx_ids.clear();
+      _applied_block_trx_ids.reserve( delta.block.transactions.size() );
+      for( const auto& trx : delta.block.transactions )
+         _applied_block_trx_ids.push_back( trx.id() );
+      applied_block( delta.block );
+      notify_changed_objects();
+      if( !applied_state_delta.empty() )
+         applied_state_delta( delta );
+      session.commit();
+   });
+} FC_CAPTURE_AND_RETHROW( (delta.block.block_num()) ) }
+
 //////////////////// private methods ////////////////////
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
@@ -2413,7 +2615,28 @@ void database::_apply_block( const signed_block& next_block )
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = get_node_properties().skip_flags;
 
-   FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "mysterious place...", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
+   _block_profiler.begin_block( next_block_num );
+   block_profiler::phase_timer timer( _block_profiler );
+   timer.start( phase_validate_header );
+
+   // the block id covers the header root, so prevalidated transactions that hash to it are the block's
+   // transactions whenever this block's transactions hash to it as well
+   const prevalidated_block* pre = _pushed_prevalidated_block;
+   if( pre != nullptr && ( pre->block_id != next_block.id() || pre->transaction_merkle_root != next_block.transaction_merkle_root ) )
+      pre = nullptr;
+
+   if( !(skip & skip_merkle_check) || pre != nullptr )
+   {
+      const checksum_type merkle_root = next_block.calculate_merkle_root();
+      if( skip & skip_merkle_check )
+      {
+         if( next_block.transaction_merkle_root != merkle_root )
+            pre = nullptr;
+      }
+      else
+         FC_ASSERT( next_block.transaction_merkle_root == merkle_root, "mysterious place...", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",merkle_root)("next_block",next_block)("id",next_block.id()) );
+   }
+   detail::pointer_restorer< prevalidated_block > restorer( _applying_prevalidated_block, pre );
 
    const witness_object& signing_witness = validate_block_header(skip, next_block);
 
@@ -2432,11 +2655,16 @@ void database::_apply_block( const signed_block& next_block )
    });
 
    /// parse witness version reporting
+   timer.start( phase_header_extensions );
    process_header_extensions( next_block );
 
    FC_ASSERT( get_witness( next_block.witness ).running_version >= hardfork_property_id_type()( *this ).current_hardfork_version,
          "Block produced by witness that is not running current hardfork" );
 
+   timer.start( phase_transactions );
+   _conflict_tracker.begin_block();
+   _applied_block_trx_ids.clear();
+   _applied_block_trx_ids.reserve( next_block.transactions.size() );
    for( const auto& trx : next_block.transactions )
    {
       /* We do not need to push the undo state for each transaction
@@ -2445,44 +2673,72 @@ void database::_apply_block( const signed_block& next_block )
        * for transactions when validating broadcast transactions or
        * when building a block.
        */
-      apply_transaction( trx, skip );
+      _conflict_tracker.begin_transaction();
+      detail::with_skip_flags( *this, skip, [&]() { _applied_block_trx_ids.push_back( _apply_transaction( trx ) ); } );
+      _conflict_tracker.end_transaction();
       ++_current_trx_in_block;
    }
+   _conflict_tracker.end_block();
 
+   timer.start( phase_update_global_dynamic_data );
    update_global_dynamic_data(next_block);
+   timer.start( phase_update_signing_witness );
    update_signing_witness(signing_witness, next_block);
 
+   timer.start( phase_update_last_irreversible_block );
    update_last_irreversible_block();
 
+   timer.start( phase_create_block_summary );
    create_block_summary(next_block);
+   timer.start( phase_clear_expired );
    clear_expired_transactions();
    clear_expired_proposals();
    clear_expired_orders();
+   timer.start( phase_update_witness_schedule );
    update_witness_schedule();
 
+   timer.start( phase_update_median_feed );
    update_median_feed();
+   timer.start( phase_update_virtual_supply );
    update_virtual_supply();
 
+   timer.start( phase_process_funds );
    const auto content_reward = get_content_reward();
    const auto witness_pay = get_producer_reward();
    const auto vesting_reward = head_block_num() < MUSE_START_VESTING_BLOCK ? asset( 0, MUSE_SYMBOL )
                                                                            : get_vesting_reward();
 
    process_funds( content_reward, witness_pay, vesting_reward );
+   timer.start( phase_process_conversions );
    process_conversions();
+   timer.start( phase_process_content_cashout );
    asset paid_for_content = process_content_cashout( content_reward );
    adjust_funds( content_reward, paid_for_content );
+   timer.start( phase_process_vesting_withdrawals );
    process_vesting_withdrawals();
+   timer.start( phase_update_virtual_supply );
    update_virtual_supply();
 
+   timer.start( phase_account_recovery_processing );
    account_recovery_processing();
 
+   timer.start( phase_process_hardforks );
    process_hardforks();
 
    // notify observers that the block has been applied
+   timer.start( phase_applied_block_signal );
    applied_block( next_block ); //emit
 
+   timer.start( phase_notify_changed_objects );
    notify_changed_objects();
+   if( _undo_db.enabled() && !applied_state_delta.empty() )
+   {
+      timer.start( phase_state_delta );
+      applied_state_delta( make_state_delta( next_block ) );
+   }
+   timer.stop();
+
+   _block_profiler.end_block();
 }
 FC_LOG_AND_RETHROW() }
 
@@ -2579,17 +2835,19 @@ void database::apply_transaction(const signed_transaction& trx, uint32_t skip)
    detail::with_skip_flags( *this, skip, [&]() { _apply_transaction(trx); });
 }
 
-void database::_apply_transaction(const signed_transaction& trx)
+transaction_id_type database::_apply_transaction(const signed_transaction& trx)
 { try {
-   _current_trx_id = trx.id();
+   block_profiler::transaction_timer timer( _block_profiler );
+   const transaction_id_type trx_id = trx.id();
+   _current_trx_id = trx_id;
    uint32_t skip = get_node_properties().skip_flags;
+   const prevalidated_block* pre = _applying_prevalidated_block;
 
-   if( !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
+   if( !(skip&skip_validate) && !(pre != nullptr && pre->transactions_valid) )   /* issue #505 explains why this skip_flag is disabled */
       trx.validate();
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = MUSE_CHAIN_ID;
-   auto trx_id = trx.id();
    FC_ASSERT( (skip & skip_transaction_dupe_check) ||
               trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
    transaction_evaluation_state eval_state(this);
@@ -2597,14 +2855,22 @@ void database::_apply_transaction(const signed_transaction& trx)
 
    if( !(skip & (skip_transaction_signatures | skip_authority_check) ) )
    {
-      auto get_active  = [&]( const string& name ) { return &get_account(name).active; };
-      auto get_owner   = [&]( const string& name ) { return &get_account(name).owner;  };
-      auto get_basic = [&]( const string& name ) { return &get_account(name).basic;  };
-      auto get_master_cont = [&]( const string& url ) { return &get_content(url).manage_master; };
-      auto get_comp_cont = [&]( const string& url ) { return &get_content(url).manage_comp; };
-
-      trx.verify_authority( chain_id, get_active, get_owner, get_basic, get_master_cont, get_comp_cont,
-                            !has_hardfork( MUSE_HARDFORK_0_3 ) ? 1 : 2 );
+      auto get_active  = [&]( const string& name ) { return _authority_cache.get_active(name); };
+      auto get_owner   = [&]( const string& name ) { return _authority_cache.get_owner(name);  };
+      auto get_basic = [&]( const string& name ) { return _authority_cache.get_basic(name);  };
+      auto get_master_cont = [&]( const string& url ) { return _authority_cache.get_master_content(url); };
+      auto get_comp_cont = [&]( const string& url ) { return _authority_cache.get_comp_content(url); };
+
+      uint32_t version = !has_hardfork( MUSE_HARDFORK_0_3 ) ? 1 : 2;
+      if( pre != nullptr && _current_trx_in_block < pre->signature_keys.size() )
+         trx.verify_authority( pre->signature_keys[_current_trx_in_block], get_active, get_owner, get_basic,
+                               get_master_cont, get_comp_cont, version );
+      else if( pre == nullptr && _pushed_signature_keys != nullptr )
+         trx.verify_authority( *_pushed_signature_keys, get_active, get_owner, get_basic,
+                               get_master_cont, get_comp_cont, version );
+      else
+         trx.verify_authority( chain_id, get_active, get_owner, get_basic, get_master_cont, get_comp_cont,
+                               version );
    }
    flat_set<string> required; vector<authority> other;
    flat_set<string> required_content;
@@ -2612,13 +2878,13 @@ void database::_apply_transaction(const signed_transaction& trx)
    auto trx_size = fc::raw::pack_size(trx);
 
    for( const auto& auth : required ) {
-      const auto& acnt = get_account(auth);
+      const auto& acnt = _authority_cache.get_account(auth);
 
       update_account_bandwidth( acnt, trx_size );
       for( const auto& op : trx.operations ) {
          if( is_market_operation( op ) )
          {
-            update_account_market_bandwidth( get_account(auth), trx_size );
+            update_account_market_bandwidth( acnt, trx_size );
             break;
          }
       }
@@ -2664,6 +2930,9 @@ void database::_apply_transaction(const signed_transaction& trx)
    }
    _current_trx_id = transaction_id_type();
 
+   timer.done( trx_id, head_block_num() + 1, trx );
+   return trx_id;
+
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
 
 void database::apply_operation(transaction_evaluation_state& eval_state, const operation& op)
@@ -2675,7 +2944,10 @@ void database::apply_operation(transaction_evaluation_state& eval_state, const o
    unique_ptr<op_evaluator>& eval = _operation_evaluators[ u_which ];
    FC_ASSERT( eval, "No registered evaluator for operation ${op}", ("op",op) );
    push_applied_operation( op );
-   eval->evaluate( eval_state, op, true );
+   {
+      block_profiler::operation_timer timer( _block_profiler, *this, i_which );
+      eval->evaluate( eval_state, op, true );
+   }
    notify_post_apply_operation( op );
 } FC_CAPTURE_AND_RETHROW(  ) }
 
@@ -2686,7 +2958,12 @@ const witness_object& database::validate_block_header( uint32_t skip, const sign
    const witness_object& witness = get_witness( next_block.witness ); //(*this);
 
    if( !(skip&skip_witness_signature) )
-      FC_ASSERT( next_block.validate_signee( witness.signing_key ) );
+   {
+      if( _applying_prevalidated_block != nullptr && _applying_prevalidated_block->signee.valid() )
+         FC_ASSERT( *_applying_prevalidated_block->signee == witness.signing_key );
+      else
+         FC_ASSERT( next_block.validate_signee( witness.signing_key ) );
+   }
 
    if( !(skip&skip_witness_schedule_check) )
    {
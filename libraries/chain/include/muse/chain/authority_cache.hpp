@@ -0,0 +1,57 @@
+#pragma once
+#include <muse/chain/account_object.hpp>
+#include <muse/chain/content_object.hpp>
+
+#include <unordered_map>
+
+namespace muse { namespace chain {
+
+   class database;
+
+   /**
+    *  @class authority_cache
+    *  @brief remembers the account and content objects resolved during authority checks
+    *
+    *  Authority getters are called several times per transaction, for every signer and
+    *  recursively for every account named in an authority. The cache maps a name or url
+    *  to its object, so each (name, authority kind) pair is one hash lookup after the
+    *  first string search of the by_name / by_url index.
+    *
+    *  Objects are modified in place, so cached pointers stay valid until the object is
+    *  removed. Removal, including the removal of newly created objects when a block or
+    *  pending transaction is undone, is observed on the primary index and drops the entry.
+    */
+   class authority_cache
+   {
+      public:
+         authority_cache( const database& db ) : _db( db ) {}
+
+         const account_object& get_account( const string& name );
+         const content_object& get_content( const string& url );
+
+         const authority* get_active( const string& name )         { return &get_account( name ).active; }
+         const authority* get_owner( const string& name )          { return &get_account( name ).owner; }
+         const authority* get_basic( const string& name )          { return &get_account( name ).basic; }
+         const authority* get_master_content( const string& url )  { return &get_content( url ).manage_master; }
+         const authority* get_comp_content( const string& url )    { return &get_content( url ).manage_comp; }
+
+         void on_account_removed( const account_object& a ) { _accounts.erase( a.name ); }
+         void on_content_removed( const content_object& c ) { _contents.erase( c.url ); }
+         void clear();
+
+         uint64_t hits()const { return _hits; }
+         uint64_t misses()const { return _misses; }
+
+         /** observers that keep the cache consistent, registered on account_index and content_index */
+         std::shared_ptr< graphene::db::index_observer > make_account_observer();
+         std::shared_ptr< graphene::db::index_observer > make_content_observer();
+
+      private:
+         const database&                                         _db;
+         std::unordered_map< string, const account_object* >     _accounts;
+         std::unordered_map< string, const content_object* >     _contents;
+         uint64_t                                                _hits = 0;
+         uint64_t                                                _misses = 0;
+   };
+
+} } // muse::chain
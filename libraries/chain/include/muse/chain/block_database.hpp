@@ -1,10 +1,15 @@
 #pragma once
 #include <fstream>
+#include <mutex>
 #include <muse/chain/protocol/block.hpp>
 
 namespace muse { namespace chain {
    class index_entry;
 
+   /**
+    *  All methods may be called from several threads at once, the files are accessed
+    *  under a mutex because reads share the stream positions.
+    */
    class block_database
    {
       public:
@@ -20,6 +25,12 @@ namespace muse { namespace chain {
          block_id_type          fetch_block_id( uint32_t block_num )const;
          optional<signed_block> fetch_optional( const block_id_type& id )const;
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
+         /**
+          *  Returns the packed blocks start_num, start_num + 1, ... up to count blocks, stopping at
+          *  the first block that is not stored.  Index entries are read in one go and blocks stored
+          *  next to each other are read together.
+          */
+         vector< vector<char> > fetch_range_packed( uint32_t start_num, uint32_t count )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
       private:
@@ -27,5 +38,6 @@ namespace muse { namespace chain {
          fc::path _index_filename;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+         mutable std::mutex   _io_mutex;
    };
 } }
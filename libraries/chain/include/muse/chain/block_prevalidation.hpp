@@ -0,0 +1,39 @@
+#pragma once
+#include <muse/chain/protocol/block.hpp>
+
+#include <fc/optional.hpp>
+
+#include <vector>
+
+namespace muse { namespace chain {
+
+   /**
+    *  Results of the checks on a block that don't depend on chain state: the witness signature
+    *  and transaction signatures, and transaction validate().
+    *
+    *  These can be computed on any thread ahead of push_block.  The block id only covers the
+    *  header, so the results are bound to the transactions they were computed from by their
+    *  merkle root: _apply_block uses them only when the id matches, the computed root equals
+    *  the header root and the transactions of the block being applied hash to that root too.  Anything that failed is left
+    *  unset, so the regular check runs and reports the error.
+    */
+   struct prevalidated_block
+   {
+      block_id_type                                  block_id;
+      /** merkle root of the transactions that were checked, not the one in the header */
+      checksum_type                                  transaction_merkle_root;
+      fc::optional< public_key_type >                signee;
+      /** true when every transaction passed validate() */
+      bool                                           transactions_valid = false;
+      /** keys recovered from each transaction's signatures, empty when not recovered */
+      std::vector< flat_set< public_key_type > >     signature_keys;
+   };
+
+   /**
+    *  @param recover_signature_keys whether to recover transaction signature keys, only
+    *         worth doing when the block will be pushed without skip_transaction_signatures
+    */
+   prevalidated_block prevalidate_block( const signed_block& b, const chain_id_type& chain_id,
+                                         bool recover_signature_keys );
+
+} } // muse::chain
@@ -0,0 +1,272 @@
+#pragma once
+#include <muse/chain/protocol/types.hpp>
+
+#include <graphene/db/object_database.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <deque>
+#include <fstream>
+#include <unordered_set>
+#include <vector>
+
+namespace muse { namespace chain {
+
+   /**
+    *  The steps performed by database::_apply_block, in the order in which they are executed.
+    */
+   enum apply_block_phase
+   {
+      phase_validate_header,
+      phase_header_extensions,
+      phase_transactions,
+      phase_update_global_dynamic_data,
+      phase_update_signing_witness,
+      phase_update_last_irreversible_block,
+      phase_create_block_summary,
+      phase_clear_expired,
+      phase_update_witness_schedule,
+      phase_update_median_feed,
+      phase_update_virtual_supply,
+      phase_process_funds,
+      phase_process_conversions,
+      phase_process_content_cashout,
+      phase_process_vesting_withdrawals,
+      phase_account_recovery_processing,
+      phase_process_hardforks,
+      phase_applied_block_signal,
+      phase_notify_changed_objects,
+      phase_state_delta,
+      APPLY_BLOCK_PHASE_COUNT
+   };
+
+   /**
+    *  Aggregates durations (in microseconds) into power-of-two buckets, bucket i
+    *  counts samples in [2^(i-1), 2^i). The last bucket collects everything larger.
+    */
+   struct timing_histogram
+   {
+      static const uint32_t bucket_count = 24;
+
+      uint64_t                count    = 0;
+      uint64_t                total_us = 0;
+      uint64_t                max_us   = 0;
+      std::vector< uint64_t > buckets  = std::vector< uint64_t >( bucket_count );
+
+      void record( uint64_t us );
+   };
+
+   /**
+    *  Cost of one operation type: wall time plus the object writes and bytes allocated
+    *  through the primary indexes while its evaluator ran.
+    */
+   struct operation_profile
+   {
+      timing_histogram timing;
+      uint64_t         objects_written = 0;
+      uint64_t         bytes_allocated = 0;
+   };
+
+   /**
+    *  A transaction whose application took longer than the configured threshold.
+    */
+   struct slow_transaction_record
+   {
+      transaction_id_type     trx_id;
+      uint32_t                block_num   = 0;
+      fc::time_point          when;
+      uint64_t                duration_us = 0;
+      std::vector< int64_t >  operations;
+   };
+
+   /**
+    *  One entry of the optional binary trace file, written once per applied block.
+    */
+   struct block_trace_record
+   {
+      uint32_t                block_num = 0;
+      uint64_t                total_us  = 0;
+      std::vector< uint64_t > phase_us;
+   };
+
+   /**
+    *  @class block_profiler
+    *  @brief collects per-phase and per-evaluator timings of block application
+    *
+    *  The profiler is disabled by default, in which case the timers below do not
+    *  even read the clock.
+    *
+    *  Everything is counted once per applied block: phase timings are summed over the block
+    *  and recorded when it ends, and operations are only recorded while a block is applied,
+    *  not when the same transactions are applied as pending ones.  Nothing of a block that
+    *  fails to apply is recorded, apart from operations evaluated before it failed.
+    */
+   class block_profiler
+   {
+      public:
+         block_profiler();
+
+         bool enabled()const { return _enabled; }
+         void set_enabled( bool e ) { _enabled = e; }
+
+         /** appends one packed block_trace_record per applied block to the given file */
+         void open_trace_file( const fc::path& p );
+         void close_trace_file();
+
+         void begin_block( uint32_t block_num );
+         void end_block();
+         /** forgets the current block without recording it, after end_block() it does nothing */
+         void abandon_block() { _block_start = fc::time_point(); }
+         bool in_block()const { return _block_start != fc::time_point(); }
+
+         /** transactions taking at least this long are logged, 0 disables the slow transaction log */
+         void     set_slow_transaction_threshold( uint64_t us ) { _slow_trx_threshold_us = us; }
+         uint64_t get_slow_transaction_threshold()const { return _slow_trx_threshold_us; }
+
+         void record_phase( apply_block_phase phase, uint64_t us );
+         void record_operation( int64_t which, uint64_t us, uint64_t objects_written, uint64_t bytes_allocated );
+         /**
+          *  Pending and popped transactions are applied again with every block, a transaction that
+          *  is still among the recorded ones is not logged or recorded again.
+          */
+         void record_transaction( const transaction_id_type& trx_id, uint32_t block_num, uint64_t us,
+                                  const std::vector< int64_t >& operations );
+
+         const std::vector< timing_histogram >&        get_phase_timings()const { return _phases; }
+         const std::vector< operation_profile >&       get_operation_profiles()const { return _operations; }
+         const timing_histogram&                       get_block_timing()const { return _blocks; }
+         const std::deque< slow_transaction_record >&  get_slow_transactions()const { return _slow_transactions; }
+
+         void reset();
+
+         /**
+          *  Measures consecutive phases with one clock read per phase boundary. Starting
+          *  a phase ends the previous one; the last phase ends with stop() or destruction.
+          */
+         class phase_timer
+         {
+            public:
+               phase_timer( block_profiler& p ) : _profiler( p ) {}
+               /** also abandons the block when it is left by an exception, before end_block() */
+               ~phase_timer() { stop(); _profiler.abandon_block(); }
+
+               void start( apply_block_phase phase );
+               void stop();
+
+            private:
+               block_profiler&  _profiler;
+               apply_block_phase _phase = APPLY_BLOCK_PHASE_COUNT;
+               fc::time_point   _start;
+         };
+
+         /**
+          *  Measures the evaluation of a single operation of a block being applied.
+          */
+         class operation_timer
+         {
+            public:
+               operation_timer( block_profiler& p, const graphene::db::object_database& db, int64_t which )
+               : _profiler( p ), _db( db ), _which( which )
+               {
+                  if( _profiler.enabled() && _profiler.in_block() )
+                  {
+                     _counters = _db.get_write_counters();
+                     _start = fc::time_point::now();
+                  }
+               }
+               ~operation_timer()
+               {
+                  if( _start == fc::time_point() )
+                     return;
+                  const graphene::db::write_counters& now = _db.get_write_counters();
+                  _profiler.record_operation( _which, ( fc::time_point::now() - _start ).count(),
+                                              now.objects_written - _counters.objects_written,
+                                              now.bytes_allocated - _counters.bytes_allocated );
+               }
+
+            private:
+               block_profiler&                      _profiler;
+               const graphene::db::object_database& _db;
+               int64_t                              _which;
+               graphene::db::write_counters         _counters;
+               fc::time_point                       _start;
+         };
+
+         /**
+          *  Measures the application of a whole transaction for the slow transaction log.
+          */
+         class transaction_timer
+         {
+            public:
+               transaction_timer( block_profiler& p ) : _profiler( p )
+               {
+                  if( _profiler.enabled() && _profiler.get_slow_transaction_threshold() > 0 )
+                     _start = fc::time_point::now();
+               }
+
+               /** called only when the transaction applied successfully */
+               template< typename Transaction >
+               void done( const transaction_id_type& trx_id, uint32_t block_num, const Transaction& trx )
+               {
+                  if( _start == fc::time_point() )
+                     return;
+                  uint64_t us = ( fc::time_point::now() - _start ).count();
+                  if( us < _profiler.get_slow_transaction_threshold() )
+                     return;
+                  std::vector< int64_t > ops;
+                  ops.reserve( trx.operations.size() );
+                  for( const auto& op : trx.operations )
+                     ops.push_back( op.which() );
+                  _profiler.record_transaction( trx_id, block_num, us, ops );
+               }
+
+            private:
+               block_profiler& _profiler;
+               fc::time_point  _start;
+         };
+
+      private:
+         bool                                  _enabled = false;
+         uint64_t                              _slow_trx_threshold_us = 0;
+         std::vector< timing_histogram >       _phases;
+         std::vector< operation_profile >      _operations;
+         timing_histogram                      _blocks;
+         std::deque< slow_transaction_record > _slow_transactions;
+         std::unordered_set< transaction_id_type > _slow_transaction_ids;
+
+         fc::time_point                        _block_start;
+         block_trace_record                    _current;
+         std::ofstream                         _trace;
+   };
+
+} } // muse::chain
+
+FC_REFLECT_ENUM( muse::chain::apply_block_phase,
+                 (phase_validate_header)
+                 (phase_header_extensions)
+                 (phase_transactions)
+                 (phase_update_global_dynamic_data)
+                 (phase_update_signing_witness)
+                 (phase_update_last_irreversible_block)
+                 (phase_create_block_summary)
+                 (phase_clear_expired)
+                 (phase_update_witness_schedule)
+                 (phase_update_median_feed)
+                 (phase_update_virtual_supply)
+                 (phase_process_funds)
+                 (phase_process_conversions)
+                 (phase_process_content_cashout)
+                 (phase_process_vesting_withdrawals)
+                 (phase_account_recovery_processing)
+                 (phase_process_hardforks)
+                 (phase_applied_block_signal)
+                 (phase_notify_changed_objects)
+                 (phase_state_delta)
+                 (APPLY_BLOCK_PHASE_COUNT) )
+
+FC_REFLECT( muse::chain::timing_histogram, (count)(total_us)(max_us)(buckets) )
+FC_REFLECT( muse::chain::operation_profile, (timing)(objects_written)(bytes_allocated) )
+FC_REFLECT( muse::chain::slow_transaction_record, (trx_id)(block_num)(when)(duration_us)(operations) )
+FC_REFLECT( muse::chain::block_trace_record, (block_num)(total_us)(phase_us) )
@@ -0,0 +1,67 @@
+#pragma once
+#include <graphene/db/index.hpp>
+
+#include <fc/reflect/reflect.hpp>
+
+#include <unordered_set>
+
+namespace muse { namespace chain {
+
+   using graphene::db::object_id_type;
+
+   /**
+    *  Totals collected by conflict_tracker.  A transaction counts as write conflicting when it
+    *  writes an object that an earlier transaction of the same block already wrote.
+    *
+    *  Only writes are recorded, a transaction that reads what an earlier one wrote is not
+    *  counted.
+    */
+   struct conflict_stats
+   {
+      uint64_t blocks                         = 0;
+      uint64_t transactions                   = 0;
+      uint64_t write_conflicting_transactions = 0;
+      uint64_t objects_written                = 0;
+   };
+
+   /**
+    *  @class conflict_tracker
+    *  @brief records the set of objects written by each transaction of a block
+    *
+    *  It observes every primary index and counts the transactions of a block whose write
+    *  sets overlap.  How blocks are applied does not change.
+    *
+    *  Reads are not recorded because the indexes are read through boost::multi_index
+    *  directly, see conflict_stats.
+    */
+   class conflict_tracker
+   {
+      public:
+         bool enabled()const { return _enabled; }
+
+         void begin_block();
+         void begin_transaction();
+         void end_transaction();
+         void end_block();
+
+         void on_write( const object_id_type& id );
+
+         const conflict_stats& get_stats()const { return _stats; }
+         void reset() { _stats = conflict_stats(); }
+
+         /** observes every index of the database; called once by database::enable_conflict_tracking */
+         std::shared_ptr< graphene::db::index_observer > make_observer();
+         void set_enabled( bool e ) { _enabled = e; }
+
+      private:
+         bool                                           _enabled = false;
+         bool                                           _in_transaction = false;
+         std::unordered_set< object_id_type >           _trx_writes;
+         std::unordered_set< object_id_type >           _block_writes;
+         conflict_stats                                 _stats;
+   };
+
+} } // muse::chain
+
+FC_REFLECT( muse::chain::conflict_stats,
+            (blocks)(transactions)(write_conflicting_transactions)(objects_written) )
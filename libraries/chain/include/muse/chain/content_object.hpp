@@ -155,7 +155,12 @@ namespace muse { namespace chain {
       indexed_by<
          ordered_unique< tag< by_id >, member< object, object_id_type, &object::id > >,
          ordered_unique< tag< by_url >, member< content_object, string, &content_object::url> >,
-         ordered_non_unique< tag< by_title >, member< content_object, string, &content_object::track_title > >,
+         ordered_unique< tag< by_title >,
+            composite_key< content_object,
+               member< content_object, string, &content_object::track_title >,
+               member< object, object_id_type, &object::id >
+            >
+         >,
          ordered_unique< tag< by_uploader_url >,
             composite_key< content_object, 
                member< content_object, string, &content_object::uploader>,
@@ -7,6 +7,11 @@
 #include <muse/chain/node_property_object.hpp>
 #include <muse/chain/fork_database.hpp>
 #include <muse/chain/block_database.hpp>
+#include <muse/chain/block_profiler.hpp>
+#include <muse/chain/conflict_tracker.hpp>
+#include <muse/chain/authority_cache.hpp>
+#include <muse/chain/block_prevalidation.hpp>
+#include <muse/chain/state_delta.hpp>
 #include <muse/chain/asset_object.hpp>
 #include <muse/chain/balance_object.hpp>
 
@@ -20,6 +25,11 @@
 #include <fc/signals.hpp>
 
 #include <fc/log/logger.hpp>
+#include <fc/thread/future.hpp>
+#include <fc/thread/thread_specific.hpp>
+
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
 
 #include <map>
 
@@ -90,6 +100,33 @@ namespace muse { namespace chain {
          void wipe(const fc::path& data_dir, bool include_blocks);
          void close(bool rewind = true);
 
+         /**
+          *  Calls callback while no block or transaction is being applied.  Any number of threads may
+          *  read at the same time; push_block(), push_transaction(), generate_block(), pop_block(),
+          *  clear_pending() and close() wait until running readers are done, and readers started
+          *  meanwhile wait for the write to finish.
+          *
+          *  Must not be called from the thread that applies blocks while it is applying one.
+          */
+         template< typename Lambda >
+         auto with_read_lock( Lambda&& callback )const -> decltype( callback() )
+         {
+            boost::shared_lock< boost::shared_mutex > lock( _state_mutex );
+            return callback();
+         }
+
+         /**
+          *  Calls callback with the state locked for writing, as the write entry points listed for
+          *  with_read_lock() do, so that readers never see its changes half done.  Must be called on
+          *  the thread that applies blocks, it may nest in any of these calls.
+          */
+         template< typename Lambda >
+         auto with_write_lock( Lambda&& callback ) -> decltype( callback() )
+         {
+            state_write_lock lock( *this );
+            return callback();
+         }
+
          //////////////////// db_block.cpp ////////////////////
 
          /**
@@ -102,6 +139,8 @@ namespace muse { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
+         /** packed blocks start_num ... up to count blocks, not beyond the head block */
+         vector< vector<char> >     fetch_block_range_packed( uint32_t start_num, uint32_t count )const;
          const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
@@ -137,8 +176,33 @@ namespace muse { namespace chain {
          const flat_map<uint32_t,block_id_type> get_checkpoints()const { return _checkpoints; }
          bool                                   before_last_checkpoint()const;
 
-         bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
-         void push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
+         /**
+          *  @param pre optional results of prevalidate_block() for b, used in place of the
+          *         corresponding checks when b is applied
+          */
+         bool push_block( const signed_block& b, uint32_t skip = skip_nothing, const prevalidated_block* pre = nullptr );
+         /**
+          *  @param signature_keys optional keys already recovered from trx's signatures with
+          *         get_signature_keys(), used in place of recovering them again
+          */
+         void push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing,
+                                const flat_set< public_key_type >* signature_keys = nullptr );
+
+         /** a transaction for push_transactions(), signature_keys as for push_transaction() */
+         struct batched_transaction
+         {
+            const signed_transaction*           trx;
+            const flat_set< public_key_type >*  signature_keys;
+         };
+
+         /**
+          *  Pushes trxs in order as push_transaction() would, under one write lock and one undo
+          *  session.  Each transaction is applied in a nested session, so one that fails is undone
+          *  alone and the others are still pushed.  Changed objects are notified once for the batch.
+          *
+          *  @return one entry per transaction, null if it was pushed, the reason it failed otherwise
+          */
+         vector< fc::exception_ptr > push_transactions( const vector< batched_transaction >& trxs, uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
          void _push_transaction( const signed_transaction& trx );
          void push_proposal( const proposal_object& proposal );
@@ -157,6 +221,18 @@ namespace muse { namespace chain {
          void pop_block();
          void clear_pending();
 
+         /**
+          *  Brings the state to the end of delta.block, which must build on the head block,
+          *  without evaluating the block: the objects in the delta are written as they are and
+          *  the block is stored in the block database.  applied_block and the object change
+          *  signals are emitted as when a block is pushed, so plugins that write to the database
+          *  from them must not run on a node that follows a primary this way; their objects
+          *  arrive with the delta.  Indexes the primary has and this node lacks are skipped.
+          *  Modified objects are replaced rather than modified in place, so objects may exchange
+          *  unique keys within the block.
+          */
+         void apply_state_delta( const state_delta& delta );
+
          /**
           *  This method is used to track appied operations during the evaluation of a block, these
           *  operations should include any operation actually included in a transaction as well
@@ -186,6 +262,12 @@ namespace muse { namespace chain {
           */
          fc::signal<void(const signed_block&)>           applied_block;
 
+         /**
+          *  The ids of the transactions of the block being applied, in block order.  Valid while
+          *  applied_block is emitted, so that receivers do not need to hash the transactions again.
+          */
+         const vector<transaction_id_type>& applied_block_transaction_ids()const { return _applied_block_trx_ids; }
+
          /**
           * This signal is emitted any time a new transaction is added to the pending
           * block state.
@@ -203,6 +285,13 @@ namespace muse { namespace chain {
           */
          fc::signal<void(const vector<const object*>&)>  removed_objects;
 
+         /**
+          *  Emitted after a block has been applied, with the changes the block made to the
+          *  objects, when the undo history is enabled.  The delta is only built while there are
+          *  receivers.  The same restrictions as for applied_block apply.
+          */
+         fc::signal<void(const state_delta&)>            applied_state_delta;
+
          //////////////////// db_witness_schedule.cpp ////////////////////
 
          /**
@@ -346,6 +435,19 @@ namespace muse { namespace chain {
 
          node_property_object& node_properties();
 
+         block_profiler&       get_block_profiler() { return _block_profiler; }
+         const block_profiler& get_block_profiler()const { return _block_profiler; }
+
+         /**
+          *  Start recording which objects each transaction in a block writes, see conflict_tracker.
+          *  Measurement only.  Called before open(), it covers the replay, and tracking is
+          *  switched off again when open() returns or throws.
+          */
+         void                    enable_conflict_tracking();
+         const conflict_tracker& get_conflict_tracker()const { return _conflict_tracker; }
+
+         const authority_cache&  get_authority_cache()const { return _authority_cache; }
+
          uint32_t last_non_undoable_block_num() const;
          //////////////////// db_init.cpp ////////////////////
 
@@ -397,8 +499,43 @@ namespace muse { namespace chain {
          //Mark pop_undo() as protected -- we do not want outside calling pop_undo(); it should call pop_block() instead
          void pop_undo() { object_database::pop_undo(); }
          void notify_changed_objects();
+         /** builds the state delta of block from the head undo state, while the block is applied */
+         state_delta make_state_delta( const signed_block& block )const;
 
       private:
+         /**
+          *  Holds _state_mutex exclusively for the outermost of nested write entry points,
+          *  e.g. generate_block() calling push_block().  Only the chain thread writes, but several
+          *  of its fibers may, so the nesting depth is counted per fiber: another fiber yields
+          *  until the owner is done instead of entering its write or blocking the thread.
+          */
+         class state_write_lock
+         {
+            public:
+               state_write_lock( database& db ) : _db( db )
+               {
+                  uint32_t* depth = _db._state_write_depth.get();
+                  if( depth == nullptr )
+                  {
+                     depth = new uint32_t( 0 );
+                     _db._state_write_depth.reset( depth );
+                  }
+                  if( (*depth)++ == 0 )
+                     _db.lock_state_for_write();
+               }
+               ~state_write_lock()
+               {
+                  if( --*_db._state_write_depth.get() == 0 )
+                     _db.unlock_state_for_write();
+               }
+
+            private:
+               database& _db;
+         };
+
+         void lock_state_for_write();
+         void unlock_state_for_write();
+
          optional<undo_database::session>       _pending_tx_session;
          vector< unique_ptr<op_evaluator> >     _operation_evaluators;
 
@@ -406,7 +543,8 @@ namespace muse { namespace chain {
          void apply_block( const signed_block& next_block, uint32_t skip = skip_nothing );
          void apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          void _apply_block( const signed_block& next_block );
-         void _apply_transaction( const signed_transaction& trx );
+         /** @return the id of trx */
+         transaction_id_type _apply_transaction( const signed_transaction& trx );
          void apply_operation( transaction_evaluation_state& eval_state, const operation& op );
 
 
@@ -458,6 +596,7 @@ namespace muse { namespace chain {
          block_database   _block_id_to_block;
 
          transaction_id_type               _current_trx_id;
+         vector<transaction_id_type>       _applied_block_trx_ids;
          uint32_t                          _current_block_num    = 0;
          uint16_t                          _current_trx_in_block = 0;
          uint16_t                          _current_op_in_trx    = 0;
@@ -467,6 +606,18 @@ namespace muse { namespace chain {
 
          node_property_object              _node_property_object;
 
+         block_profiler                    _block_profiler;
+         conflict_tracker                  _conflict_tracker;
+         bool                              _conflict_observer_added = false;
+         authority_cache                   _authority_cache{ *this };
+
+         /** set by push_block for the duration of the push */
+         const prevalidated_block*         _pushed_prevalidated_block   = nullptr;
+         /** set by _apply_block while applying the block _pushed_prevalidated_block refers to */
+         const prevalidated_block*         _applying_prevalidated_block = nullptr;
+         /** set by push_transaction for the duration of the push */
+         const flat_set< public_key_type >* _pushed_signature_keys      = nullptr;
+
          /**
           * Whether database is successfully opened or not.
           *
@@ -475,5 +626,12 @@ namespace muse { namespace chain {
           * database::close() has not been called, or failed during execution.
           */
          bool                              _opened = false;
+
+         mutable boost::shared_mutex       _state_mutex;
+         /** how many state_write_locks the current fiber holds */
+         fc::task_specific_ptr< uint32_t > _state_write_depth;
+         /** whether a fiber holds _state_mutex for writing, and the promise others wait on */
+         bool                              _state_write_locked = false;
+         fc::promise< void >::ptr          _state_write_released;
    };
 } }
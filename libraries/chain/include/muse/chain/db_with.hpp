@@ -89,6 +89,28 @@ struct pending_transactions_restorer
    std::vector< signed_transaction > _pending_transactions;
 };
 
+/**
+ * Class used to set one of the database's prevalidated_block or
+ * signature key pointers for the duration of a scope.
+ */
+template< typename T >
+struct pointer_restorer
+{
+   pointer_restorer( const T*& slot, const T* value )
+      : _slot( slot ), _old_value( slot )
+   {
+      _slot = value;
+   }
+
+   ~pointer_restorer()
+   {
+      _slot = _old_value;
+   }
+
+   const T*& _slot;
+   const T*  _old_value;
+};
+
 /**
  * Set the skip_flags to the given value, call callback,
  * then reset skip_flags to their previous value after
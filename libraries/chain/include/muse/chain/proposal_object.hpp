@@ -63,23 +63,24 @@ class proposal_object : public abstract_object<proposal_object>
 
 /**
  *  @brief tracks all of the proposal objects that requrie approval of
- *  an individual account.   
+ *  an individual account or content.
  *
  *  @ingroup object
  *  @ingroup protocol
  *
- *  This is a secondary index on the proposal_index
- *
- *  @note the set of required approvals is constant
+ *  This is a secondary index on the proposal_index.  Besides the required
+ *  account and content approvals, which are constant, it tracks the accounts
+ *  that have given their active approval.
  */
 class required_approval_index : public secondary_index
 {
    public:
       virtual void object_inserted( const object& obj ) override;
       virtual void object_removed( const object& obj ) override;
-      virtual void about_to_modify( const object& before ) override{};
-      virtual void object_modified( const object& after  ) override{};
+      virtual void about_to_modify( const object& before ) override;
+      virtual void object_modified( const object& after  ) override;
 
+      /** @param account an account name or content url */
       const set<proposal_id_type>& lookup( const string& account )const;
 
    private:
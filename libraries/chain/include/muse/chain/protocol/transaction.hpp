@@ -80,6 +80,17 @@ namespace muse { namespace chain {
          uint32_t version,
          uint32_t max_recursion = MUSE_MAX_SIG_CHECK_DEPTH)const;
 
+      /** as above, with keys already recovered from the signatures by get_signature_keys() */
+      void verify_authority(
+         const flat_set<public_key_type>& signature_keys,
+         const authority_getter& get_active,
+         const authority_getter& get_owner,
+         const authority_getter& get_basic,
+         const authority_getter& get_master_content,
+         const authority_getter& get_comp_content,
+         uint32_t version,
+         uint32_t max_recursion = MUSE_MAX_SIG_CHECK_DEPTH)const;
+
       set<public_key_type> minimize_required_signatures(
          const chain_id_type& chain_id,
          const flat_set<public_key_type>& available_keys,
@@ -0,0 +1,40 @@
+#pragma once
+#include <muse/chain/protocol/block.hpp>
+
+#include <graphene/db/object_id.hpp>
+
+#include <vector>
+
+namespace muse { namespace chain {
+
+   using graphene::db::object_id_type;
+
+   struct state_delta_object
+   {
+      object_id_type         id;
+      /** the object packed as its type, as by object::pack() */
+      std::vector< char >    data;
+   };
+
+   /**
+    *  The changes a block made to the object database, taken from the undo state of the block.
+    *  Applying it to the state before the block yields the state after the block without
+    *  evaluating the block.
+    *
+    *  Objects created or modified by the block are carried with their new value, removed
+    *  objects by id.  next_ids holds the next id of every index that allocated ids in the block.
+    *  The block itself comes along so that it can be stored and served like an applied block.
+    */
+   struct state_delta
+   {
+      signed_block                          block;
+      /** ordered by id */
+      std::vector< state_delta_object >     upserted;
+      std::vector< object_id_type >         removed;
+      std::vector< object_id_type >         next_ids;
+   };
+
+} } // muse::chain
+
+FC_REFLECT( muse::chain::state_delta_object, (id)(data) )
+FC_REFLECT( muse::chain::state_delta, (block)(upserted)(removed)(next_ids) )
@@ -78,6 +78,12 @@ void required_approval_index::object_inserted( const object& obj )
       _account_to_proposals[a].insert( p.id );
    for( const auto& a : p.required_basic_approvals )
       _account_to_proposals[a].insert( p.id );
+   for( const auto& a : p.required_master_content_approvals )
+      _account_to_proposals[a].insert( p.id );
+   for( const auto& a : p.required_comp_content_approvals )
+      _account_to_proposals[a].insert( p.id );
+   for( const auto& a : p.available_active_approvals )
+      _account_to_proposals[a].insert( p.id );
 }
 
 void required_approval_index::remove( string a, proposal_id_type p )
@@ -102,6 +108,23 @@ void required_approval_index::object_removed( const object& obj )
        remove( a, p.id );
     for( const auto& a : p.required_basic_approvals )
        remove( a, p.id );
+    for( const auto& a : p.required_master_content_approvals )
+       remove( a, p.id );
+    for( const auto& a : p.required_comp_content_approvals )
+       remove( a, p.id );
+    for( const auto& a : p.available_active_approvals )
+       remove( a, p.id );
+}
+
+void required_approval_index::about_to_modify( const object& before )
+{
+    // available approvals change, the entries are rebuilt from the modified object
+    object_removed( before );
+}
+
+void required_approval_index::object_modified( const object& after )
+{
+    object_inserted( after );
 }
 
 const set<proposal_id_type>& required_approval_index::lookup( const string& account )const
@@ -409,16 +409,30 @@ void signed_transaction::verify_authority(
    const authority_getter& get_comp_content,
    uint32_t version,
    uint32_t max_recursion)const
+{ try {
+   verify_authority( get_signature_keys( chain_id ), get_active, get_owner, get_basic,
+                     get_master_content, get_comp_content, version, max_recursion );
+} FC_CAPTURE_AND_RETHROW( (*this) ) }
+
+void signed_transaction::verify_authority(
+   const flat_set<public_key_type>& signature_keys,
+   const authority_getter& get_active,
+   const authority_getter& get_owner,
+   const authority_getter& get_basic,
+   const authority_getter& get_master_content,
+   const authority_getter& get_comp_content,
+   uint32_t version,
+   uint32_t max_recursion)const
 { try {
    switch( version ) {
       case 1:
-         muse::chain::verify_authority_v1( operations, get_signature_keys( chain_id ),
+         muse::chain::verify_authority_v1( operations, signature_keys,
                                            get_active, get_owner, get_basic,
                                            get_master_content, get_comp_content,
                                            max_recursion );
          break;
       case 2:
-         muse::chain::verify_authority_v2( operations, get_signature_keys( chain_id ),
+         muse::chain::verify_authority_v2( operations, signature_keys,
                                            get_active, get_owner, get_basic,
                                            get_master_content, get_comp_content,
                                            false, max_recursion );
@@ -131,6 +131,8 @@ namespace graphene { namespace db {
          virtual void               add_observer( const shared_ptr<index_observer>& ) = 0;
 
          virtual void               object_from_variant( const fc::variant& var, object& obj, uint32_t max_depth )const = 0;
+         /** unpacks data as produced by object::pack() into obj, which must be of the type of this index */
+         virtual void               object_from_packed( const std::vector<char>& data, object& obj )const = 0;
          virtual void               object_default( object& obj )const = 0;
    };
 
@@ -164,6 +166,9 @@ namespace graphene { namespace db {
          /** called just after obj is modified */
          void on_modify( const object& obj );
 
+         /** called when a new object of the given size has been allocated */
+         void on_allocate( size_t bytes );
+
          template<typename T>
          void add_secondary_index()
          {
@@ -270,6 +275,17 @@ namespace graphene { namespace db {
          virtual const object&  create(const std::function<void(object&)>& constructor )override
          {
             const auto& result = DerivedIndex::create( constructor );
+            for( const auto& item : _sindex )
+               item->object_inserted( result );
+            on_allocate( sizeof( object_type ) );
+            on_add( result );
+            return result;
+         }
+
+         /** used by undo to restore removed objects, they are indexed again like created ones */
+         virtual const object& insert( object&& obj ) override
+         {
+            const auto& result = DerivedIndex::insert( std::move( obj ) );
             for( const auto& item : _sindex )
                item->object_inserted( result );
             on_add( result );
@@ -309,6 +325,14 @@ namespace graphene { namespace db {
             obj.id = id;
          }
 
+         virtual void object_from_packed( const std::vector<char>& data, object& obj )const override
+         {
+            object_type* result = dynamic_cast<object_type*>( &obj );
+            FC_ASSERT( result != nullptr );
+            fc::datastream<const char*> ds( data.data(), data.size() );
+            fc::raw::unpack( ds, *result );
+         }
+
          virtual void object_default( object& obj )const override
          {
             object_id_type id = obj.id;
@@ -32,6 +32,16 @@
 
 namespace graphene { namespace db {
 
+   /**
+    *  Running totals of the writes performed through the primary indexes. They are
+    *  never reset and are not part of the undo state; callers take differences.
+    */
+   struct write_counters
+   {
+      uint64_t objects_written = 0;
+      uint64_t bytes_allocated = 0;
+   };
+
    /**
     *   @class object_database
     *   @brief maintains a set of indexed objects that can be modified with multi-level rollback support
@@ -75,6 +85,8 @@ namespace graphene { namespace db {
          const index&  get_index()const { return get_index(T::space_id,T::type_id); }
          const index&  get_index(uint8_t space_id, uint8_t type_id)const;
          const index&  get_index(object_id_type id)const { return get_index(id.space(),id.type()); }
+         /** @return the index or nullptr if no index is registered for the space and type */
+         const index*  find_index(uint8_t space_id, uint8_t type_id)const;
          /// @}
 
          const object& get_object( object_id_type id )const;
@@ -140,10 +152,15 @@ namespace graphene { namespace db {
             return static_cast<IndexType*>(_index[ObjectType::space_id][ObjectType::type_id].get());
          }
 
+         /** adds the observer to every index registered so far */
+         void add_index_observer( const shared_ptr<index_observer>& o );
+
          void pop_undo();
 
          fc::path get_data_dir()const { return _data_dir; }
 
+         const write_counters& get_write_counters()const { return _write_counters; }
+
          /** public for testing purposes only... should be private in practice. */
          undo_database                          _undo_db;
      protected:
@@ -167,6 +184,7 @@ namespace graphene { namespace db {
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         write_counters                                            _write_counters;
    };
 
 } } // graphene::db
@@ -40,4 +40,7 @@ namespace graphene { namespace db {
 
    void base_primary_index::on_modify( const object& obj )
    {for( auto ob : _observers ) ob->on_modify(  obj ); }
+
+   void base_primary_index::on_allocate( size_t bytes )
+   { _db._write_counters.bytes_allocated += bytes; }
 } } // graphene::chain
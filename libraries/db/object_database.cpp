@@ -60,6 +60,12 @@ const index& object_database::get_index(uint8_t space_id, uint8_t type_id)const
    FC_ASSERT( tmp, "unkown index" );
    return *tmp;
 }
+const index* object_database::find_index(uint8_t space_id, uint8_t type_id)const
+{
+   if( _index.size() <= space_id || _index[space_id].size() <= type_id )
+      return nullptr;
+   return _index[space_id][type_id].get();
+}
 index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
 {
    FC_ASSERT( _index.size() > space_id, "", ("space_id",space_id)("type_id",type_id)("index.size",_index.size()) );
@@ -69,6 +75,14 @@ index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
    return *idx;
 }
 
+void object_database::add_index_observer( const shared_ptr<index_observer>& o )
+{
+   for( auto& space : _index )
+      for( auto& idx : space )
+         if( idx )
+            idx->add_observer( o );
+}
+
 void object_database::flush()
 {
    fc::create_directories( _data_dir / "object_database.tmp" / "lock" );
@@ -118,16 +132,19 @@ void object_database::pop_undo()
 
 void object_database::save_undo( const object& obj )
 {
+   ++_write_counters.objects_written;
    _undo_db.on_modify( obj );
 }
 
 void object_database::save_undo_add( const object& obj )
 {
+   ++_write_counters.objects_written;
    _undo_db.on_create( obj );
 }
 
 void object_database::save_undo_remove(const object& obj)
 {
+   ++_write_counters.objects_written;
    _undo_db.on_remove( obj );
 }
 
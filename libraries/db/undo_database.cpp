@@ -51,6 +51,14 @@ void undo_database::on_create( const object& obj )
    if( _stack.empty() )
       _stack.emplace_back();
    auto& state = _stack.back();
+   auto removed = state.removed.find( obj.id );
+   if( removed != state.removed.end() )
+   {
+      // removed and created again with the same id, i.e. modified
+      state.old_values[obj.id] = std::move( removed->second );
+      state.removed.erase( removed );
+      return;
+   }
    auto index_id = object_id_type( obj.id.space(), obj.id.type(), 0 );
    auto itr = state.old_index_next_ids.find( index_id );
    if( itr == state.old_index_next_ids.end() )
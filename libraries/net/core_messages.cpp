@@ -45,6 +45,17 @@ namespace graphene { namespace net {
   const core_message_type_enum check_firewall_reply_message::type            = core_message_type_enum::check_firewall_reply_message_type;
   const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
   const core_message_type_enum get_current_connections_reply_message::type   = core_message_type_enum::get_current_connections_reply_message_type;
+  const core_message_type_enum compact_block_message::type                   = core_message_type_enum::compact_block_message_type;
+
+  compact_block_message::compact_block_message(const block_message& full_block, const message_hash_type& block_message_hash) :
+    header(full_block.block),
+    block_id(full_block.block_id),
+    block_message_hash(block_message_hash)
+  {
+    transaction_message_hashes.reserve(full_block.block.transactions.size());
+    for (const signed_transaction& trx : full_block.block.transactions)
+      transaction_message_hashes.push_back(message(trx_message(trx)).id());
+  }
 
 } } // graphene::net
 
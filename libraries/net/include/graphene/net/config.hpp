@@ -25,6 +25,12 @@
 
 #define GRAPHENE_NET_PROTOCOL_VERSION                        106
 
+/**
+ * Version of the compact block relay we speak, advertised in the hello message's
+ * user data.  Peers that don't advertise it are always sent full blocks.
+ */
+#define GRAPHENE_NET_COMPACT_BLOCK_RELAY_VERSION             1
+
 /**
  * Define this to enable debugging code in the p2p network interface.
  * This is code that would never be executed in normal operation, but is
@@ -57,6 +63,12 @@
 
 #define GRAPHENE_NET_MAXIMUM_QUEUED_MESSAGES_IN_BYTES        (1024 * 1024)
 
+/**
+ * Messages waiting in a peer's send queue are packed into one encrypted write
+ * of up to this many bytes (a single larger message is always sent whole).
+ */
+#define GRAPHENE_NET_MAX_COALESCED_SEND_SIZE                 (64 * 1024)
+
 /**
  * When we receive a message from the network, we advertise it to
  * our peers and save a copy in a cache were we will find it if
@@ -79,8 +91,41 @@
 
 #define GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES           2
 
+/**
+ * Each peer's inventory lists are expired in bulk, in generations spanning this
+ * fraction of GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES.  Items are kept for
+ * up to one generation longer than the inventory window.
+ */
+#define GRAPHENE_NET_INVENTORY_GENERATIONS                   4
+
+/**
+ * Number of threads used to hash incoming messages, so that the p2p thread can
+ * keep servicing other connections while a large message (a block) is hashed.
+ * Messages smaller than GRAPHENE_NET_MIN_OFFLOADED_HASH_SIZE are hashed in place,
+ * because switching threads costs more than hashing them.  Setting the thread
+ * count to 0 hashes everything on the p2p thread.
+ */
+#define GRAPHENE_NET_MESSAGE_HASHING_THREADS                 2
+#define GRAPHENE_NET_MIN_OFFLOADED_HASH_SIZE                 (16 * 1024)
+
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * Each peer's sync request window starts at this many blocks.  It doubles every
+ * time the peer delivers a whole batch, up to maximum_blocks_per_peer_during_syncing,
+ * and halves when the peer's requests become overdue.
+ */
+#define GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING      10
+
+/**
+ * A peer's sync requests are overdue when it hasn't delivered a block for this many
+ * times its average time between blocks, and at least
+ * GRAPHENE_NET_MIN_SYNC_REQUEST_OVERDUE_MS.  The earliest overdue blocks are then
+ * requested from a faster peer as well, and whichever copy arrives first is used.
+ */
+#define GRAPHENE_NET_SYNC_REQUEST_OVERDUE_MULTIPLE           4
+#define GRAPHENE_NET_MIN_SYNC_REQUEST_OVERDUE_MS             2000
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -104,6 +149,28 @@
 
 #define GRAPHENE_NET_MAX_TRX_PER_SECOND                      1000
 
+/**
+ * When the client refuses a transaction because its transaction queue is
+ * full, we stop fetching transactions from the peer that sent it for this
+ * many seconds.
+ */
+#define GRAPHENE_NET_TRANSACTION_QUEUE_FULL_BACKOFF_SEC      2
+
 #define GRAPHENE_NET_MAX_NESTED_OBJECTS                      (250)
 
 #define MAXIMUM_PEERDB_SIZE 1000
+
+/**
+ * Peers in the same address bucket (the same /16 for IPv4) may fill at most
+ * this many peer database records, so one address range advertising many
+ * addresses cannot push everyone else out of the database.
+ */
+#define MAXIMUM_PEERDB_RECORDS_PER_ADDRESS_BUCKET 100
+
+/**
+ * Changes to the peer database are written to its file once this many are
+ * buffered, or with the next change after the oldest buffered one is this many
+ * seconds old.  A crash loses at most those, a cut off entry is skipped on load.
+ */
+#define MAXIMUM_PEERDB_UNFLUSHED_ENTRIES 64
+#define MAXIMUM_PEERDB_FLUSH_DELAY_SEC 10
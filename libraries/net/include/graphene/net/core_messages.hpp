@@ -24,6 +24,7 @@
 #pragma once
 
 #include <graphene/net/config.hpp>
+#include <graphene/net/message.hpp>
 #include <muse/chain/protocol/block.hpp>
 
 #include <fc/crypto/ripemd160.hpp>
@@ -44,6 +45,7 @@ namespace graphene { namespace net {
   using muse::chain::block_id_type;
   using muse::chain::transaction_id_type;
   using muse::chain::signed_block;
+  using muse::chain::signed_block_header;
 
   typedef fc::ecc::public_key_data node_id_t;
   typedef fc::ripemd160 item_hash_t;
@@ -86,6 +88,7 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
     core_message_type_last                       = 5099
   };
 
@@ -115,6 +118,25 @@ namespace graphene { namespace net {
 
    };
 
+   /**
+    *  A block sent as its header plus the message hashes of its transactions, which
+    *  the receiver has usually seen already as trx_messages.  It is sent in reply to
+    *  a fetch_items_message of item type compact_block_message_type, whose item hashes
+    *  are the hashes of the corresponding block_messages.
+    */
+   struct compact_block_message
+   {
+      static const core_message_type_enum type;
+
+      compact_block_message(){}
+      compact_block_message(const block_message& full_block, const message_hash_type& block_message_hash);
+
+      signed_block_header            header;
+      block_id_type                  block_id;
+      message_hash_type              block_message_hash; /// the item the receiver asked for, to fall back to if reconstruction fails
+      std::vector<message_hash_type> transaction_message_hashes;
+   };
+
   struct item_ids_inventory_message
   {
     static const core_message_type_enum type;
@@ -422,10 +444,12 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
                  (core_message_type_last) )
 
 FC_REFLECT( graphene::net::trx_message, (trx) )
 FC_REFLECT( graphene::net::block_message, (block)(block_id) )
+FC_REFLECT( graphene::net::compact_block_message, (header)(block_id)(block_message_hash)(transaction_message_hashes) )
 
 FC_REFLECT( graphene::net::item_id, (item_type)
                                (item_hash) )
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+namespace graphene { namespace net {
+
+  /**
+   * A set whose items expire in bulk.  Items are added to the current generation, and
+   * advance() starts a new one, dropping the oldest generation in one step instead of
+   * searching for expired items one at a time.  An item lives for between
+   * generation_count - 1 and generation_count calls to advance().
+   *
+   * Lookups probe every generation, so keep generation_count small.
+   */
+  template<typename Key, typename Hash = std::hash<Key> >
+  class generational_set
+  {
+  public:
+    explicit generational_set(uint32_t generation_count) :
+      _generations(generation_count > 0 ? generation_count : 1)
+    {}
+
+    bool contains(const Key& key) const
+    {
+      for (const generation_type& generation : _generations)
+        if (generation.find(key) != generation.end())
+          return true;
+      return false;
+    }
+
+    /** @return false if the item was already in the set, in which case its age is unchanged */
+    bool insert(const Key& key)
+    {
+      if (contains(key))
+        return false;
+      _generations[_current].insert(key);
+      ++_size;
+      return true;
+    }
+
+    bool erase(const Key& key)
+    {
+      for (generation_type& generation : _generations)
+        if (generation.erase(key))
+        {
+          --_size;
+          return true;
+        }
+      return false;
+    }
+
+    /**
+     * Starts count new generations, expiring the oldest ones
+     * @return the number of items expired
+     */
+    size_t advance(uint32_t count = 1)
+    {
+      size_t expired = 0;
+      for (uint32_t i = 0; i < count && i < _generations.size(); ++i)
+      {
+        _current = (_current + 1) % _generations.size();
+        expired += _generations[_current].size();
+        // clear() keeps the bucket array, so the generation is refilled without rehashing
+        _generations[_current].clear();
+      }
+      _size -= expired;
+      return expired;
+    }
+
+    void clear()
+    {
+      for (generation_type& generation : _generations)
+        generation.clear();
+      _size = 0;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+  private:
+    typedef std::unordered_set<Key, Hash> generation_type;
+
+    std::vector<generation_type> _generations;
+    uint32_t                     _current = 0;
+    size_t                       _size = 0;
+  };
+
+} } // end namespace graphene::net
@@ -35,7 +35,9 @@ namespace graphene { namespace net {
   class message_oriented_connection_delegate 
   {
   public:
-    virtual void on_message(message_oriented_connection* originating_connection, const message& received_message) = 0;
+    /** @param message_hash the id() of received_message, computed by the connection while reading it */
+    virtual void on_message(message_oriented_connection* originating_connection, const message& received_message,
+                            const message_hash_type& message_hash) = 0;
     virtual void on_connection_closed(message_oriented_connection* originating_connection) = 0;
   };
 
@@ -52,6 +54,8 @@ namespace graphene { namespace net {
        void connect_to(const fc::ip::endpoint& remote_endpoint);
 
        void send_message(const message& message_to_send);
+       /** sends all of the messages with a single write to the socket */
+       void send_messages(const std::vector<message>& messages_to_send);
        void close_connection();
        void destroy_connection();
 
@@ -80,6 +80,16 @@ namespace graphene { namespace net {
          virtual bool handle_block( const graphene::net::block_message& blk_msg, bool sync_mode,
                                     std::vector<fc::uint160_t>& contained_transaction_message_ids ) = 0;
 
+         /**
+          *  @brief Called when a sync block is queued, ahead of the handle_block() call for it
+          *
+          *  Gives the client a chance to start the checks that don't depend on chain
+          *  state while earlier blocks are still being applied.  Unlike the other
+          *  methods this is called directly on the p2p thread, so it must be
+          *  thread-safe and must not block.
+          */
+         virtual void prevalidate_block( const graphene::net::block_message& blk_msg ) = 0;
+
          /**
           *  @brief Called when a new transaction comes in from the network
           *
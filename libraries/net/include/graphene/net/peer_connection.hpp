@@ -28,6 +28,7 @@
 #include <graphene/net/message_oriented_connection.hpp>
 #include <graphene/net/stcp_socket.hpp>
 #include <graphene/net/config.hpp>
+#include <graphene/net/generational_set.hpp>
 
 #include <boost/tuple/tuple.hpp>
 
@@ -41,6 +42,8 @@
 #include <boost/multi_index/hashed_index.hpp>
 
 #include <queue>
+#include <list>
+#include <map>
 #include <boost/container/deque.hpp>
 #include <fc/thread/future.hpp>
 
@@ -66,7 +69,8 @@ namespace graphene { namespace net
     {
     public:
       virtual void on_message(peer_connection* originating_peer,
-                              const message& received_message) = 0;
+                              const message& received_message,
+                              const message_hash_type& message_hash) = 0;
       virtual void on_connection_closed(peer_connection* originating_peer) = 0;
       virtual message get_message_for_item(const item_id& item) = 0;
     };
@@ -167,7 +171,7 @@ namespace graphene { namespace net
 
 
       size_t _total_queued_messages_size;
-      std::queue<std::unique_ptr<queued_message>, std::list<std::unique_ptr<queued_message> > > _queued_messages;
+      std::list<std::unique_ptr<queued_message> > _queued_messages;
       fc::future<void> _send_queued_messages_done;
     public:
       fc::time_point connection_initiation_time;
@@ -207,6 +211,7 @@ namespace graphene { namespace net
       fc::optional<fc::time_point_sec> fc_git_revision_unix_timestamp;
       fc::optional<std::string> platform;
       fc::optional<uint32_t> bitness;
+      fc::optional<uint32_t> compact_block_relay_version;
 
       // for inbound connections, these fields record what the peer sent us in
       // its hello message.  For outbound, they record what we sent the peer
@@ -227,12 +232,23 @@ namespace graphene { namespace net
       bool we_need_sync_items_from_peer;
       fc::optional<boost::tuple<std::vector<item_hash_t>, fc::time_point> > item_ids_requested_from_peer; /// we check this to detect a timed-out request and in busy()
       fc::time_point last_sync_item_received_time; /// the time we received the last sync item or the time we sent the last batch of sync item requests to this peer
-      std::set<item_hash_t> sync_items_requested_from_peer; /// ids of blocks we've requested from this peer during sync.  fetch from another peer if this peer disconnects
+      std::map<item_hash_t, fc::time_point> sync_items_requested_from_peer; /// ids of blocks we've requested from this peer during sync, and when.  fetch from another peer if this peer disconnects
       item_hash_t last_block_delegate_has_seen; /// the hash of the last block  this peer has told us about that the peer knows
       fc::time_point_sec last_block_time_delegate_has_seen;
       bool inhibit_fetching_sync_blocks;
       /// @}
 
+      /// sync performance, used to order and size sync requests and to pick the peer to
+      /// re-request overdue blocks from
+      /// @{
+      fc::microseconds sync_block_latency; /// moving average of the time from requesting a sync block to receiving it
+      fc::microseconds sync_block_interval; /// moving average of the time between sync blocks while requests are outstanding
+      uint32_t sync_request_window; /// number of sync blocks we ask this peer for at once
+      uint64_t sync_blocks_received;
+      uint32_t sync_requests_overdue; /// number of times this peer's sync requests were re-sent to a faster peer
+      fc::time_point last_sync_requests_overdue_time; /// when this peer's sync requests were last found overdue
+      /// @}
+
       /// non-synchronization state data
       /// @{
       struct timestamped_item_id
@@ -250,8 +266,10 @@ namespace graphene { namespace net
                                                                                                             std::hash<item_id> >,
                                                                           boost::multi_index::ordered_non_unique<boost::multi_index::tag<timestamp_index>,
                                                                                                                  boost::multi_index::member<timestamped_item_id, fc::time_point_sec, &timestamped_item_id::timestamp> > > > timestamped_items_set_type;
-      timestamped_items_set_type inventory_peer_advertised_to_us;
-      timestamped_items_set_type inventory_advertised_to_peer;
+      typedef generational_set<item_id> item_id_set_type;
+      item_id_set_type inventory_peer_advertised_to_us;
+      item_id_set_type inventory_advertised_to_peer;
+      uint32_t inventory_generation; /// the inventory generation that items are currently added to, see clear_old_inventory()
 
       item_to_time_map_type items_requested_from_peer;  /// items we've requested from this peer during normal operation.  fetch from another peer if this peer disconnects
       /// @}
@@ -282,7 +300,8 @@ namespace graphene { namespace net
       void accept_connection();
       void connect_to(const fc::ip::endpoint& remote_endpoint, fc::optional<fc::ip::endpoint> local_endpoint = fc::optional<fc::ip::endpoint>());
 
-      void on_message(message_oriented_connection* originating_connection, const message& received_message) override;
+      void on_message(message_oriented_connection* originating_connection, const message& received_message,
+                      const message_hash_type& message_hash) override;
       void on_connection_closed(message_oriented_connection* originating_connection) override;
 
       void send_queueable_message(std::unique_ptr<queued_message>&& message_to_send);
@@ -308,6 +327,12 @@ namespace graphene { namespace net
       bool is_transaction_fetching_inhibited() const;
       fc::sha512 get_shared_secret() const;
       void clear_old_inventory();
+      /** the inventory generation of the current time, see clear_old_inventory() */
+      static uint32_t current_inventory_generation();
+      /** updates the sync performance averages for a block requested at request_time */
+      void record_sync_block_received(const fc::time_point& request_time);
+      /** @return the time after which this peer's outstanding sync requests are overdue */
+      fc::time_point get_sync_requests_overdue_time() const;
       bool is_inventory_advertised_to_us_list_full_for_transactions() const;
       bool is_inventory_advertised_to_us_list_full() const;
       bool performing_firewall_check() const;
@@ -32,6 +32,10 @@
 #include <fc/exception/exception.hpp>
 #include <fc/io/raw.hpp>
 
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
 namespace graphene { namespace net {
 
   enum potential_peer_last_connection_disposition
@@ -92,12 +96,23 @@ namespace graphene { namespace net {
   }
 
 
+  /**
+   * The peer database is kept in memory, indexed by endpoint, last seen time, connection
+   * health and address bucket.  On disk it is a compact binary log: every change is appended
+   * as it happens and flushed in batches (see MAXIMUM_PEERDB_UNFLUSHED_ENTRIES), and the log
+   * is rewritten as a snapshot when it is opened, closed, or has grown well past the number
+   * of records.  A JSON file from older versions (the same name with a .json extension) is
+   * imported when no binary file exists yet.
+   */
   class peer_database
   {
   public:
     peer_database();
     ~peer_database();
 
+    /** peers in the same bucket (the /16 for IPv4) are likely run by the same operator */
+    static uint32_t get_address_bucket(const fc::ip::endpoint& endpoint);
+
     void open(const fc::path& databaseFilename);
     void close();
     void clear();
@@ -108,6 +123,24 @@ namespace graphene { namespace net {
     potential_peer_record lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
     fc::optional<potential_peer_record> lookup_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
 
+    /**
+     * Returns up to max_count peers we may try to connect to now, without visiting peers that
+     * are still backing off.  Peers whose last connection succeeded come first, then peers we
+     * never tried, then peers by increasing number of failed attempts; the least recently
+     * tried peer comes first within each group.  Peers from address buckets that are neither
+     * in buckets_in_use nor taken by an earlier candidate are preferred over the rest.
+     *
+     * @param retry_timeout a peer whose last connection failed is retried after
+     *                      (number_of_failed_connection_attempts + 1) * retry_timeout seconds
+     * @param is_excluded   returns true for endpoints that must not be returned, e.g. those
+     *                      we are already connected to
+     */
+    std::vector<potential_peer_record> get_connection_candidates(fc::time_point_sec now,
+                                                                 uint32_t retry_timeout,
+                                                                 size_t max_count,
+                                                                 const std::function<bool(const fc::ip::endpoint&)>& is_excluded,
+                                                                 const std::unordered_set<uint32_t>& buckets_in_use) const;
+
     typedef detail::peer_database_iterator iterator;
     iterator begin() const;
     iterator end() const;
@@ -68,6 +68,10 @@ class stcp_socket : public virtual fc::iostream
     fc::aes_decoder      _recv_aes;
     std::shared_ptr<char> _read_buffer;
     std::shared_ptr<char> _write_buffer;
+    /// decrypted bytes read ahead of the caller, [_plaintext_begin, _plaintext_end) is still unread
+    std::unique_ptr<char[]> _plaintext_buffer;
+    size_t               _plaintext_begin = 0;
+    size_t               _plaintext_end = 0;
 #ifndef NDEBUG
     bool _read_buffer_in_use;
     bool _write_buffer_in_use;
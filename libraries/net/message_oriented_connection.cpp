@@ -27,6 +27,11 @@
 #include <fc/thread/future.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/enum_type.hpp>
+#include <fc/string.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 #include <graphene/net/message_oriented_connection.hpp>
 #include <graphene/net/stcp_socket.hpp>
@@ -46,6 +51,50 @@
 namespace graphene { namespace net {
   namespace detail
   {
+    /**
+     *  Threads shared by all connections for hashing large incoming messages.  The read_loop
+     *  waits on the result, which yields the p2p thread to other connections meanwhile.
+     *
+     *  The connections hold the pool, it is created with the first one and its threads are
+     *  quit when the last one is destroyed, not during static destruction.
+     */
+    class message_hashing_pool
+    {
+    public:
+      static std::shared_ptr< message_hashing_pool > acquire()
+      {
+        static std::mutex pool_mutex;
+        static std::weak_ptr< message_hashing_pool > current_pool;
+        std::lock_guard< std::mutex > lock( pool_mutex );
+        std::shared_ptr< message_hashing_pool > pool = current_pool.lock();
+        if( !pool )
+        {
+          pool.reset( new message_hashing_pool() );
+          current_pool = pool;
+        }
+        return pool;
+      }
+
+      /** the task shares ownership of the message, it stays valid if the wait is canceled */
+      message_hash_type hash( const std::shared_ptr< const message >& m )
+      {
+        if( _threads.empty() || m->data.size() < GRAPHENE_NET_MIN_OFFLOADED_HASH_SIZE )
+          return m->id();
+        fc::thread& worker = *_threads[_next_thread++ % _threads.size()];
+        return worker.async( [m](){ return m->id(); }, "hash message" ).wait();
+      }
+
+    private:
+      message_hashing_pool()
+      {
+        for( uint32_t i = 0; i < GRAPHENE_NET_MESSAGE_HASHING_THREADS; ++i )
+          _threads.emplace_back( new fc::thread( "p2p_hash_" + fc::to_string( uint64_t( i ) ) ) );
+      }
+
+      std::vector< std::unique_ptr< fc::thread > > _threads;
+      std::atomic< uint32_t >                      _next_thread{ 0 };
+    };
+
     class message_oriented_connection_impl
     {
     private:
@@ -61,6 +110,8 @@ namespace graphene { namespace net {
       fc::time_point _last_message_sent_time;
 
       bool _send_message_in_progress;
+      std::vector<char> _send_buffer; /// padded plaintext of the messages being sent, reused between sends
+      std::shared_ptr<message_hashing_pool> _hashing_pool;
 
 #ifndef NDEBUG
       fc::thread* _thread;
@@ -68,6 +119,8 @@ namespace graphene { namespace net {
 
       void read_loop();
       void start_read_loop();
+      void append_to_send_buffer(const message& message_to_send);
+      void write_send_buffer();
     public:
       fc::tcp_socket& get_socket();
       void accept();
@@ -79,6 +132,7 @@ namespace graphene { namespace net {
       ~message_oriented_connection_impl();
 
       void send_message(const message& message_to_send);
+      void send_messages(const std::vector<message>& messages_to_send);
       void close_connection();
       void destroy_connection();
 
@@ -97,7 +151,8 @@ namespace graphene { namespace net {
       _delegate(delegate),
       _bytes_received(0),
       _bytes_sent(0),
-      _send_message_in_progress(false)
+      _send_message_in_progress(false),
+      _hashing_pool(message_hashing_pool::acquire())
 #ifndef NDEBUG
       ,_thread(&fc::thread::current())
 #endif
@@ -152,9 +207,11 @@ namespace graphene { namespace net {
 
       try
       {
-        message m;
         while( true )
         {
+          // a message is shared with the hashing task, so each one gets its own
+          std::shared_ptr<message> received = std::make_shared<message>();
+          message& m = *received;
           char buffer[BUFFER_SIZE];
           _sock.read(buffer, BUFFER_SIZE);
           _bytes_received += BUFFER_SIZE;
@@ -174,10 +231,12 @@ namespace graphene { namespace net {
 
           _last_message_received_time = fc::time_point::now();
 
+          message_hash_type message_hash = _hashing_pool->hash(received);
+
           try
           {
             // message handling errors are warnings...
-            _delegate->on_message(_self, m);
+            _delegate->on_message(_self, m, message_hash);
           }
           /// Dedicated catches needed to distinguish from general fc::exception
           catch ( const fc::canceled_exception& e ) { throw; }
@@ -255,21 +314,61 @@ namespace graphene { namespace net {
 
       try
       {
-        size_t size_of_message_and_header = sizeof(message_header) + message_to_send.size;
-        if( message_to_send.size > MAX_MESSAGE_SIZE )
-           elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
-        //pad the message we send to a multiple of 16 bytes
-        size_t size_with_padding = 16 * ((size_of_message_and_header + 15) / 16);
-        std::unique_ptr<char[]> padded_message(new char[size_with_padding]);
-        memcpy(padded_message.get(), (char*)&message_to_send, sizeof(message_header));
-        memcpy(padded_message.get() + sizeof(message_header), message_to_send.data.data(), message_to_send.size );
-        _sock.write(padded_message.get(), size_with_padding);
-        _sock.flush();
-        _bytes_sent += size_with_padding;
-        _last_message_sent_time = fc::time_point::now();
+        _send_buffer.clear();
+        append_to_send_buffer(message_to_send);
+        write_send_buffer();
       } FC_RETHROW_EXCEPTIONS( warn, "unable to send message" );
     }
 
+    void message_oriented_connection_impl::send_messages(const std::vector<message>& messages_to_send)
+    {
+      VERIFY_CORRECT_THREAD();
+      struct verify_no_send_in_progress {
+        bool& var;
+        verify_no_send_in_progress(bool& var) : var(var)
+        {
+          if (var)
+            elog("Error: two tasks are calling message_oriented_connection::send_messages() at the same time");
+          assert(!var);
+          var = true;
+        }
+        ~verify_no_send_in_progress() { var = false; }
+      } _verify_no_send_in_progress(_send_message_in_progress);
+
+      try
+      {
+        _send_buffer.clear();
+        for (const message& message_to_send : messages_to_send)
+          append_to_send_buffer(message_to_send);
+        write_send_buffer();
+      } FC_RETHROW_EXCEPTIONS( warn, "unable to send ${count} messages", ("count", messages_to_send.size()) );
+    }
+
+    void message_oriented_connection_impl::append_to_send_buffer(const message& message_to_send)
+    {
+      size_t size_of_message_and_header = sizeof(message_header) + message_to_send.size;
+      if( message_to_send.size > MAX_MESSAGE_SIZE )
+         elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
+      //pad the message we send to a multiple of 16 bytes
+      size_t size_with_padding = 16 * ((size_of_message_and_header + 15) / 16);
+      size_t offset = _send_buffer.size();
+      _send_buffer.resize(offset + size_with_padding);
+      memcpy(&_send_buffer[offset], (char*)&message_to_send, sizeof(message_header));
+      memcpy(&_send_buffer[offset + sizeof(message_header)], message_to_send.data.data(), message_to_send.size );
+    }
+
+    void message_oriented_connection_impl::write_send_buffer()
+    {
+      _sock.write(_send_buffer.data(), _send_buffer.size());
+      _sock.flush();
+      _bytes_sent += _send_buffer.size();
+      _last_message_sent_time = fc::time_point::now();
+
+      // don't hold on to the memory of an occasional large block
+      if (_send_buffer.capacity() > 2 * GRAPHENE_NET_MAX_COALESCED_SEND_SIZE)
+        std::vector<char>().swap(_send_buffer);
+    }
+
     void message_oriented_connection_impl::close_connection()
     {
       VERIFY_CORRECT_THREAD();
@@ -371,6 +470,11 @@ namespace graphene { namespace net {
     my->send_message(message_to_send);
   }
 
+  void message_oriented_connection::send_messages(const std::vector<message>& messages_to_send)
+  {
+    my->send_messages(messages_to_send);
+  }
+
   void message_oriented_connection::close_connection()
   {
     my->close_connection();
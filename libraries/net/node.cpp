@@ -130,12 +130,10 @@ namespace graphene { namespace net {
 
       struct message_hash_index{};
       struct message_contents_hash_index{};
-      struct block_clock_index{};
       struct message_info
       {
         message_hash_type message_hash;
         message           message_body;
-        uint32_t          block_clock_when_received;
 
         // for network performance stats
         message_propagation_data propagation_data;
@@ -143,32 +141,35 @@ namespace graphene { namespace net {
 
         message_info( const message_hash_type& message_hash,
                       const message&           message_body,
-                      uint32_t                 block_clock_when_received,
                       const message_propagation_data& propagation_data,
                       fc::uint160_t            message_contents_hash ) :
           message_hash( message_hash ),
           message_body( message_body ),
-          block_clock_when_received( block_clock_when_received ),
           propagation_data( propagation_data ),
           message_contents_hash( message_contents_hash )
         {}
       };
       typedef boost::multi_index_container
         < message_info,
-            bmi::indexed_by< bmi::ordered_unique< bmi::tag<message_hash_index>,
-                                                  bmi::member<message_info, message_hash_type, &message_info::message_hash> >,
-                             bmi::ordered_non_unique< bmi::tag<message_contents_hash_index>,
-                                                      bmi::member<message_info, fc::uint160_t, &message_info::message_contents_hash> >,
-                             bmi::ordered_non_unique< bmi::tag<block_clock_index>,
-                                                      bmi::member<message_info, uint32_t, &message_info::block_clock_when_received> > >
+            bmi::indexed_by< bmi::hashed_unique< bmi::tag<message_hash_index>,
+                                                 bmi::member<message_info, message_hash_type, &message_info::message_hash>,
+                                                 std::hash<message_hash_type> >,
+                             bmi::hashed_non_unique< bmi::tag<message_contents_hash_index>,
+                                                     bmi::member<message_info, fc::uint160_t, &message_info::message_contents_hash>,
+                                                     std::hash<fc::uint160_t> > >
         > message_cache_container;
 
       message_cache_container _message_cache;
 
+      /// hashes of the messages cached at each block clock, a ring indexed by block_clock % the ring size.
+      /// Messages are kept for cache_duration_in_blocks blocks after the one they were received in.
+      std::vector<std::vector<message_hash_type> > _message_hashes_by_block_clock;
+
       uint32_t block_clock;
 
     public:
       blockchain_tied_message_cache() :
+        _message_hashes_by_block_clock( cache_duration_in_blocks + 1 ),
         block_clock( 0 )
       {}
       void block_accepted();
@@ -182,9 +183,11 @@ namespace graphene { namespace net {
     void blockchain_tied_message_cache::block_accepted()
     {
       ++block_clock;
-      if( block_clock > cache_duration_in_blocks )
-        _message_cache.get<block_clock_index>().erase(_message_cache.get<block_clock_index>().begin(),
-                                                      _message_cache.get<block_clock_index>().lower_bound(block_clock - cache_duration_in_blocks ) );
+      // the slot being reused holds the messages received cache_duration_in_blocks + 1 blocks ago
+      std::vector<message_hash_type>& expired_hashes = _message_hashes_by_block_clock[block_clock % _message_hashes_by_block_clock.size()];
+      for( const message_hash_type& expired_hash : expired_hashes )
+        _message_cache.get<message_hash_index>().erase( expired_hash );
+      expired_hashes.clear();
     }
 
     void blockchain_tied_message_cache::cache_message( const message& message_to_cache,
@@ -192,11 +195,11 @@ namespace graphene { namespace net {
                                                      const message_propagation_data& propagation_data,
                                                      const fc::uint160_t& message_content_hash )
     {
-      _message_cache.insert( message_info(hash_of_message_to_cache,
-                                         message_to_cache,
-                                         block_clock,
-                                         propagation_data,
-                                         message_content_hash ) );
+      if( _message_cache.insert( message_info(hash_of_message_to_cache,
+                                              message_to_cache,
+                                              propagation_data,
+                                              message_content_hash ) ).second )
+        _message_hashes_by_block_clock[block_clock % _message_hashes_by_block_clock.size()].push_back( hash_of_message_to_cache );
     }
 
     message blockchain_tied_message_cache::get_message( const message_hash_type& hash_of_message_to_lookup )
@@ -381,6 +384,7 @@ namespace graphene { namespace net { namespace detail {
       bool has_item( const net::item_id& id ) override;
       void handle_message( const message& ) override;
       bool handle_block( const graphene::net::block_message& block_message, bool sync_mode, std::vector<fc::uint160_t>& contained_transaction_message_ids ) override;
+      void prevalidate_block( const graphene::net::block_message& block_message ) override;
       void handle_transaction( const graphene::net::trx_message& transaction_message ) override;
       std::vector<item_hash_t> get_block_ids(const std::vector<item_hash_t>& blockchain_synopsis,
                                              uint32_t& remaining_item_count,
@@ -409,7 +413,7 @@ namespace graphene { namespace net { namespace detail {
       std::unique_ptr<statistics_gathering_node_delegate_wrapper> _delegate;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat"
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
@@ -443,8 +447,33 @@ namespace graphene { namespace net { namespace detail {
       typedef std::unordered_map<graphene::net::block_id_type, fc::time_point> active_sync_requests_map;
 
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
-      std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
-      std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      std::unordered_map<graphene::net::block_id_type, uint32_t> _hedged_sync_requests; /// sync blocks re-requested from a faster peer, and how many peers the request is still outstanding at
+
+      struct received_sync_item
+      {
+        graphene::net::block_message block;
+        uint32_t                     block_num;
+        /// set once it's passed to the delegate, it stays here until accepted or rejected so it's not fetched again
+        mutable bool                 handed_to_delegate = false;
+
+        received_sync_item( const graphene::net::block_message& block_message ) :
+          block( block_message ),
+          block_num( muse::chain::block_header::num_from_id( block_message.block_id ) )
+        {}
+        const block_id_type& block_id() const { return block.block_id; }
+      };
+      struct sync_item_id_index{};
+      struct sync_item_num_index{};
+      typedef boost::multi_index_container
+        < received_sync_item,
+            bmi::indexed_by< bmi::hashed_unique< bmi::tag<sync_item_id_index>,
+                                                 bmi::const_mem_fun<received_sync_item, const block_id_type&, &received_sync_item::block_id>,
+                                                 std::hash<block_id_type> >,
+                             bmi::ordered_non_unique< bmi::tag<sync_item_num_index>,
+                                                      bmi::member<received_sync_item, uint32_t, &received_sync_item::block_num> > >
+        > received_sync_items_set_type;
+      received_sync_items_set_type _received_sync_items; /// sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain, or that are being pushed
+      uint32_t                     _next_sync_block_num; /// number of the block following the last one handed to the delegate, 0 before the first
       // @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -584,6 +613,8 @@ namespace graphene { namespace net { namespace detail {
       bool have_already_received_sync_item( const item_hash_t& item_hash );
       void request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request );
       void request_sync_items_from_peer( const peer_connection_ptr& peer, const std::vector<item_hash_t>& items_to_request );
+      fc::time_point schedule_overdue_sync_requests( std::map<peer_connection_ptr, std::vector<item_hash_t> >& sync_item_requests_to_send );
+      bool release_sync_request( const item_hash_t& item_hash );
       void fetch_sync_items_loop();
       void trigger_fetch_sync_items_loop();
 
@@ -617,11 +648,15 @@ namespace graphene { namespace net { namespace detail {
       void parse_hello_user_data_for_peer( peer_connection* originating_peer, const fc::variant_object& user_data );
 
       void on_message( peer_connection* originating_peer,
-                       const message& received_message ) override;
+                       const message& received_message,
+                       const message_hash_type& message_hash ) override;
 
       void on_hello_message( peer_connection* originating_peer,
                              const hello_message& hello_message_received );
 
+      void on_compact_block_message( peer_connection* originating_peer,
+                                     const compact_block_message& compact_block_message_received );
+
       void on_connection_accepted_message( peer_connection* originating_peer,
                                            const connection_accepted_message& connection_accepted_message_received );
 
@@ -794,6 +829,7 @@ namespace graphene { namespace net { namespace detail {
       _is_firewalled(firewalled_state::unknown),
       _potential_peer_database_updated(false),
       _sync_items_to_fetch_updated(false),
+      _next_sync_block_num(0),
       _suspend_fetching_sync_blocks(false),
       _items_to_fetch_updated(false),
       _items_to_fetch_sequence_counter(0),
@@ -915,21 +951,27 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_database_updated = false;
 
-            for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
-                 ++iter)
+            // the database hands out the healthiest peers that are due for a retry, preferring
+            // address buckets we aren't connected to yet
+            std::unordered_set<uint32_t> buckets_in_use;
+            for (const peer_connection_ptr& peer : _active_connections)
+              if (peer->get_remote_endpoint())
+                buckets_in_use.insert(peer_database::get_address_bucket(*peer->get_remote_endpoint()));
+            for (const peer_connection_ptr& peer : _handshaking_connections)
+              if (peer->get_remote_endpoint())
+                buckets_in_use.insert(peer_database::get_address_bucket(*peer->get_remote_endpoint()));
+
+            std::vector<potential_peer_record> candidates =
+              _potential_peer_db.get_connection_candidates(fc::time_point::now(), _peer_connection_retry_timeout,
+                                                           _desired_number_of_connections - get_number_of_connections(),
+                                                           [this](const fc::ip::endpoint& endpoint) { return is_connection_to_endpoint_in_progress(endpoint); },
+                                                           buckets_in_use);
+            for (const potential_peer_record& candidate : candidates)
             {
-              fc::microseconds delay_until_retry = fc::seconds((iter->number_of_failed_connection_attempts + 1) * _peer_connection_retry_timeout);
-
-              if (!is_connection_to_endpoint_in_progress(iter->endpoint) &&
-                  ((iter->last_connection_disposition != last_connection_failed &&
-                    iter->last_connection_disposition != last_connection_rejected &&
-                    iter->last_connection_disposition != last_connection_handshaking_failed) ||
-                   (fc::time_point::now() - iter->last_connection_attempt_time) > delay_until_retry))
-              {
-                connect_to_endpoint(iter->endpoint);
-                initiated_connection_this_pass = true;
-              }
+              if (!is_wanting_new_connections())
+                break;
+              connect_to_endpoint(candidate.endpoint);
+              initiated_connection_this_pass = true;
             }
 
             if (!initiated_connection_this_pass && !_potential_peer_database_updated)
@@ -988,10 +1030,8 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
-             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+      const auto& received_by_id = _received_sync_items.get<sync_item_id_index>();
+      return received_by_id.find(item_hash) != received_by_id.end();
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -1001,7 +1041,7 @@ namespace graphene { namespace net { namespace detail {
       item_id item_id_to_request( graphene::net::block_message_type, item_to_request );
       _active_sync_requests.insert( active_sync_requests_map::value_type(item_to_request, fc::time_point::now() ) );
       peer->last_sync_item_received_time = fc::time_point::now();
-      peer->sync_items_requested_from_peer.insert(item_to_request);
+      peer->sync_items_requested_from_peer.insert(std::make_pair(item_to_request, fc::time_point::now()));
       peer->send_message( fetch_items_message(item_id_to_request.item_type, std::vector<item_hash_t>{item_id_to_request.item_hash} ) );
     }
 
@@ -1014,11 +1054,96 @@ namespace graphene { namespace net { namespace detail {
       {
         _active_sync_requests.insert( active_sync_requests_map::value_type(item_to_request, fc::time_point::now() ) );
         peer->last_sync_item_received_time = fc::time_point::now();
-        peer->sync_items_requested_from_peer.insert(item_to_request);
+        peer->sync_items_requested_from_peer.insert(std::make_pair(item_to_request, fc::time_point::now()));
       }
       peer->send_message(fetch_items_message(graphene::net::block_message_type, items_to_request));
     }
 
+    // Finds peers whose sync requests are overdue and schedules their earliest outstanding blocks to also be
+    // requested from the fastest other peer that has them.  Returns when the next busy peer becomes overdue.
+    fc::time_point node_impl::schedule_overdue_sync_requests( std::map<peer_connection_ptr, std::vector<item_hash_t> >& sync_item_requests_to_send )
+    {
+      VERIFY_CORRECT_THREAD();
+      ASSERT_TASK_NOT_PREEMPTED();
+      fc::time_point now = fc::time_point::now();
+      fc::time_point next_overdue_time = fc::time_point::maximum();
+
+      for( const peer_connection_ptr& slow_peer : _active_connections )
+      {
+        if( slow_peer->sync_items_requested_from_peer.empty() )
+          continue;
+        fc::time_point overdue_time = slow_peer->get_sync_requests_overdue_time();
+        if( overdue_time > now )
+        {
+          next_overdue_time = std::min( next_overdue_time, overdue_time );
+          continue;
+        }
+
+        // block ids sort by block number, so these are the blocks holding up the rest of the sync
+        unsigned hedged_count = 0;
+        for( const auto& request : slow_peer->sync_items_requested_from_peer )
+        {
+          if( hedged_count >= GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING )
+            break;
+          const item_hash_t& item_hash = request.first;
+          if( _hedged_sync_requests.find( item_hash ) != _hedged_sync_requests.end() )
+            continue;
+
+          peer_connection_ptr fastest_peer;
+          for( const peer_connection_ptr& peer : _active_connections )
+          {
+            if( peer == slow_peer || !peer->we_need_sync_items_from_peer || peer->inhibit_fetching_sync_blocks ||
+                peer->sync_items_requested_from_peer.size() + sync_item_requests_to_send[peer].size() >= peer->sync_request_window ||
+                ( peer->sync_blocks_received > 0 && peer->sync_block_interval >= slow_peer->sync_block_interval ) ||
+                std::find( peer->ids_of_items_to_get.begin(), peer->ids_of_items_to_get.end(), item_hash ) == peer->ids_of_items_to_get.end() )
+              continue;
+            if( !fastest_peer || peer->sync_block_interval < fastest_peer->sync_block_interval )
+              fastest_peer = peer;
+          }
+          if( !fastest_peer )
+            continue;
+
+          sync_item_requests_to_send[fastest_peer].push_back( item_hash );
+          _hedged_sync_requests[item_hash] = 2;
+          ++hedged_count;
+        }
+
+        if( hedged_count > 0 )
+        {
+          wlog( "sync requests to peer ${peer} are overdue, re-requested ${count} block(s) from faster peers",
+                ("peer", slow_peer->get_remote_endpoint())("count", hedged_count) );
+          ++slow_peer->sync_requests_overdue;
+          slow_peer->sync_request_window = std::max<uint32_t>( slow_peer->sync_request_window / 2, GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING );
+        }
+        // give the slow peer another interval before checking on it again
+        slow_peer->last_sync_requests_overdue_time = now;
+        next_overdue_time = std::min( next_overdue_time, slow_peer->get_sync_requests_overdue_time() );
+      }
+
+      // drop entries for peers that had nothing valid to request
+      for( auto iter = sync_item_requests_to_send.begin(); iter != sync_item_requests_to_send.end(); )
+        if( iter->second.empty() )
+          iter = sync_item_requests_to_send.erase( iter );
+        else
+          ++iter;
+
+      return next_overdue_time;
+    }
+
+    // Called when a sync block request to one peer will not be answered.  Returns true if the block
+    // is still outstanding at another peer because the request was hedged.
+    bool node_impl::release_sync_request( const item_hash_t& item_hash )
+    {
+      VERIFY_CORRECT_THREAD();
+      auto hedge_iter = _hedged_sync_requests.find( item_hash );
+      if( hedge_iter == _hedged_sync_requests.end() )
+        return false;
+      if( --hedge_iter->second > 0 )
+        return true;
+      _hedged_sync_requests.erase( hedge_iter );
+      return false;
+    }
+
     void node_impl::fetch_sync_items_loop()
     {
       VERIFY_CORRECT_THREAD();
@@ -1026,6 +1151,7 @@ namespace graphene { namespace net { namespace detail {
       {
         _sync_items_to_fetch_updated = false;
         dlog( "beginning another iteration of the sync items loop" );
+        fc::time_point next_overdue_time = fc::time_point::maximum();
 
         if (!_suspend_fetching_sync_blocks)
         {
@@ -1035,8 +1161,18 @@ namespace graphene { namespace net { namespace detail {
             ASSERT_TASK_NOT_PREEMPTED();
             std::set<item_hash_t> sync_items_to_request;
 
+            // offer the items to the peers that delivered sync blocks fastest first.  Peers we haven't
+            // measured yet go first, so that every peer gets a chance to show how fast it is
+            std::vector<peer_connection_ptr> peers_by_speed(_active_connections.begin(), _active_connections.end());
+            std::stable_sort(peers_by_speed.begin(), peers_by_speed.end(),
+                             [](const peer_connection_ptr& a, const peer_connection_ptr& b) {
+                               if ((a->sync_blocks_received == 0) != (b->sync_blocks_received == 0))
+                                 return a->sync_blocks_received == 0;
+                               return a->sync_block_interval < b->sync_block_interval;
+                             });
+
             // for each idle peer that we're syncing with
-            for( const peer_connection_ptr& peer : _active_connections )
+            for( const peer_connection_ptr& peer : peers_by_speed )
             {
               if( peer->we_need_sync_items_from_peer &&
                   sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
@@ -1056,13 +1192,15 @@ namespace graphene { namespace net { namespace detail {
                       // then schedule a request from this peer
                       sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
                       sync_items_to_request.insert( item_to_potentially_request );
-                      if (sync_item_requests_to_send[peer].size() >= _maximum_blocks_per_peer_during_syncing)
+                      if (sync_item_requests_to_send[peer].size() >= std::min<uint32_t>(peer->sync_request_window, _maximum_blocks_per_peer_during_syncing))
                         break;
                     }
                   }
                 }
               }
             }
+
+            next_overdue_time = schedule_overdue_sync_requests(sync_item_requests_to_send);
           } // end non-preemptable section
 
           // make all the requests we scheduled in the loop above
@@ -1077,7 +1215,17 @@ namespace graphene { namespace net { namespace detail {
         {
           dlog( "no sync items to fetch right now, going to sleep" );
           _retrigger_fetch_sync_items_loop_promise = fc::promise<void>::ptr( new fc::promise<void>("graphene::net::retrigger_fetch_sync_items_loop") );
-          _retrigger_fetch_sync_items_loop_promise->wait();
+          try
+          {
+            if (next_overdue_time == fc::time_point::maximum())
+              _retrigger_fetch_sync_items_loop_promise->wait();
+            else if (next_overdue_time > fc::time_point::now())
+              _retrigger_fetch_sync_items_loop_promise->wait_until(next_overdue_time);
+          }
+          catch (const fc::timeout_exception&)
+          {
+            dlog("Resuming fetch_sync_items_loop to check for overdue sync requests");
+          }
           _retrigger_fetch_sync_items_loop_promise.reset();
         }
       } // while( !canceled )
@@ -1096,7 +1244,7 @@ namespace graphene { namespace net { namespace detail {
     {
       for( const peer_connection_ptr& peer : _active_connections )
       {
-        if (peer->inventory_peer_advertised_to_us.find(item) != peer->inventory_peer_advertised_to_us.end() )
+        if (peer->inventory_peer_advertised_to_us.contains(item))
           return true;
       }
       return false;
@@ -1157,7 +1305,7 @@ namespace graphene { namespace net { namespace detail {
               const peer_connection_ptr& peer = peer_iter->peer;
               // if they have the item and we haven't already decided to ask them for too many other items
               if (peer_iter->item_ids.size() < GRAPHENE_NET_MAX_ITEMS_PER_PEER_DURING_NORMAL_OPERATION &&
-                  peer->inventory_peer_advertised_to_us.find(item_iter->item) != peer->inventory_peer_advertised_to_us.end())
+                  peer->inventory_peer_advertised_to_us.contains(item_iter->item))
               {
                 if (item_iter->item.item_type == graphene::net::trx_message_type && peer->is_transaction_fetching_inhibited())
                   next_peer_unblocked_time = std::min(peer->transaction_fetching_inhibited_until, next_peer_unblocked_time);
@@ -1191,11 +1339,18 @@ namespace graphene { namespace net { namespace detail {
             items_to_fetch_by_type[item.item_type].push_back(item.item_hash);
           for (auto& items_by_type : items_to_fetch_by_type)
           {
+            // peers that support it send us blocks in compact form; items_requested_from_peer still
+            // records the block_message, which is what we get once the block is reconstructed
+            uint32_t item_type_to_request = items_by_type.first;
+            if (item_type_to_request == block_message_type &&
+                peer_and_items.peer->compact_block_relay_version &&
+                *peer_and_items.peer->compact_block_relay_version >= GRAPHENE_NET_COMPACT_BLOCK_RELAY_VERSION)
+              item_type_to_request = compact_block_message_type;
             dlog("requesting ${count} items of type ${type} from peer ${endpoint}: ${hashes}",
-                 ("count", items_by_type.second.size())("type", (uint32_t)items_by_type.first)
+                 ("count", items_by_type.second.size())("type", item_type_to_request)
                  ("endpoint", peer_and_items.peer->get_remote_endpoint())
                  ("hashes", items_by_type.second));
-            peer_and_items.peer->send_message(fetch_items_message(items_by_type.first,
+            peer_and_items.peer->send_message(fetch_items_message(item_type_to_request,
                                                                   items_by_type.second));
           }
         }
@@ -1258,16 +1413,11 @@ namespace graphene { namespace net { namespace detail {
             wdump((inventory_to_advertise));
             for (const item_id& item_to_advertise : inventory_to_advertise)
             {
-              if (peer->inventory_advertised_to_peer.find(item_to_advertise) != peer->inventory_advertised_to_peer.end() )
-                 wdump((*peer->inventory_advertised_to_peer.find(item_to_advertise)));
-              if (peer->inventory_peer_advertised_to_us.find(item_to_advertise) != peer->inventory_peer_advertised_to_us.end() )
-                 wdump((*peer->inventory_peer_advertised_to_us.find(item_to_advertise)));
-
-              if (peer->inventory_advertised_to_peer.find(item_to_advertise) == peer->inventory_advertised_to_peer.end() &&
-                  peer->inventory_peer_advertised_to_us.find(item_to_advertise) == peer->inventory_peer_advertised_to_us.end())
+              if (!peer->inventory_advertised_to_peer.contains(item_to_advertise) &&
+                  !peer->inventory_peer_advertised_to_us.contains(item_to_advertise))
               {
                 items_to_advertise_by_type[item_to_advertise.item_type].push_back(item_to_advertise.item_hash);
-                peer->inventory_advertised_to_peer.insert(peer_connection::timestamped_item_id(item_to_advertise, fc::time_point::now()));
+                peer->inventory_advertised_to_peer.insert(item_to_advertise);
                 ++total_items_to_send_to_this_peer;
                 if (item_to_advertise.item_type == trx_message_type)
                   testnetlog("advertising transaction ${id} to peer ${endpoint}", ("id", item_to_advertise.item_hash)("endpoint", peer->get_remote_endpoint()));
@@ -1751,10 +1901,10 @@ namespace graphene { namespace net { namespace detail {
       }
     }
 
-    void node_impl::on_message( peer_connection* originating_peer, const message& received_message )
+    void node_impl::on_message( peer_connection* originating_peer, const message& received_message,
+                                const message_hash_type& message_hash )
     {
       VERIFY_CORRECT_THREAD();
-      message_hash_type message_hash = received_message.id();
       dlog("handling message ${type} ${hash} size ${size} from peer ${endpoint}",
            ("type", graphene::net::core_message_type_enum(received_message.msg_type))("hash", message_hash)
            ("size", received_message.size)
@@ -1797,6 +1947,9 @@ namespace graphene { namespace net { namespace detail {
       case core_message_type_enum::block_message_type:
         process_block_message(originating_peer, received_message, message_hash);
         break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
       case core_message_type_enum::current_time_request_message_type:
         on_current_time_request_message(originating_peer, received_message.as<current_time_request_message>());
         break;
@@ -1859,6 +2012,7 @@ namespace graphene { namespace net { namespace detail {
         user_data["last_known_fork_block_number"] = _hard_fork_block_numbers.back();
 
       user_data["chain_id"] = MUSE_CHAIN_ID;
+      user_data["compact_block_relay_version"] = GRAPHENE_NET_COMPACT_BLOCK_RELAY_VERSION;
 
       return user_data;
     }
@@ -1882,6 +2036,8 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->node_id = user_data["node_id"].as<node_id_t>(1);
       if (user_data.contains("last_known_fork_block_number"))
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>(1);
+      if (user_data.contains("compact_block_relay_version"))
+        originating_peer->compact_block_relay_version = user_data["compact_block_relay_version"].as<uint32_t>(1);
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -2758,9 +2914,26 @@ namespace graphene { namespace net { namespace detail {
 
       fc::optional<message> last_block_message_sent;
 
+      // compact blocks are built from the full block and sent right away
+      bool send_compact_blocks = fetch_items_message_received.item_type == compact_block_message_type;
+      uint32_t item_type = send_compact_blocks ? (uint32_t)block_message_type : fetch_items_message_received.item_type;
+
       std::list<message> reply_messages;
       for (const item_hash_t& item_hash : fetch_items_message_received.items_to_fetch)
       {
+        if (send_compact_blocks)
+        {
+          message block_message_to_send = get_message_for_item(item_id(block_message_type, item_hash));
+          if (block_message_to_send.msg_type == block_message_type)
+          {
+            reply_messages.push_back(compact_block_message(block_message_to_send.as<graphene::net::block_message>(), item_hash));
+            last_block_message_sent = block_message_to_send;
+          }
+          else
+            reply_messages.push_back(block_message_to_send); // item_not_available_message
+          continue;
+        }
+
         try
         {
           message requested_message = _message_cache.get_message(item_hash);
@@ -2768,7 +2941,7 @@ namespace graphene { namespace net { namespace detail {
                ("endpoint", originating_peer->get_remote_endpoint())
                ("id", requested_message.id()));
           reply_messages.push_back(requested_message);
-          if (fetch_items_message_received.item_type == block_message_type)
+          if (item_type == block_message_type)
             last_block_message_sent = requested_message;
           continue;
         }
@@ -2777,7 +2950,7 @@ namespace graphene { namespace net { namespace detail {
            // it wasn't in our local cache, that's ok ask the client
         }
 
-        item_id item_to_fetch(fetch_items_message_received.item_type, item_hash);
+        item_id item_to_fetch(item_type, item_hash);
         try
         {
           message requested_message = _delegate->get_item(item_to_fetch);
@@ -2786,7 +2959,7 @@ namespace graphene { namespace net { namespace detail {
                ("size", requested_message.size)
                ("endpoint", originating_peer->get_remote_endpoint()));
           reply_messages.push_back(requested_message);
-          if (fetch_items_message_received.item_type == block_message_type)
+          if (item_type == block_message_type)
             last_block_message_sent = requested_message;
           continue;
         }
@@ -2815,6 +2988,73 @@ namespace graphene { namespace net { namespace detail {
       }
     }
 
+    void node_impl::on_compact_block_message( peer_connection* originating_peer,
+                                              const compact_block_message& compact_block_message_received )
+    {
+      VERIFY_CORRECT_THREAD();
+      // we only ask for compact blocks in place of blocks we fetch, anything else would make us
+      // rebuild blocks and fetch ones nobody asked us to handle
+      item_id block_item(block_message_type, compact_block_message_received.block_message_hash);
+      if (originating_peer->items_requested_from_peer.find(block_item) == originating_peer->items_requested_from_peer.end())
+      {
+        if (originating_peer->inventory_peer_advertised_to_us.contains(block_item))
+        {
+          dlog("ignoring compact block ${id} from peer ${endpoint}, it was advertised but we didn't request it",
+               ("id", compact_block_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+          return;
+        }
+        wlog("received a compact block ${block_id} I didn't ask for from peer ${endpoint}, disconnecting from peer",
+             ("endpoint", originating_peer->get_remote_endpoint())
+             ("block_id", compact_block_message_received.block_id));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me a compact block that I didn't ask for, block_id: ${block_id}",
+                                                    ("block_id", compact_block_message_received.block_id)));
+        disconnect_from_peer(originating_peer, "You sent me a compact block that I didn't ask for", true, detailed_error);
+        return;
+      }
+
+      // rebuild the block from transactions we've already received and relayed
+      signed_block reconstructed_block;
+      static_cast<signed_block_header&>(reconstructed_block) = compact_block_message_received.header;
+      reconstructed_block.transactions.reserve(compact_block_message_received.transaction_message_hashes.size());
+      bool have_all_transactions = true;
+      for (const message_hash_type& transaction_message_hash : compact_block_message_received.transaction_message_hashes)
+      {
+        try
+        {
+          reconstructed_block.transactions.push_back(_message_cache.get_message(transaction_message_hash).as<trx_message>().trx);
+        }
+        catch (fc::key_not_found_exception&)
+        {
+          have_all_transactions = false;
+          break;
+        }
+      }
+
+      if (have_all_transactions)
+      {
+        message full_block_message(graphene::net::block_message(std::move(reconstructed_block)));
+        message_hash_type full_block_message_hash = full_block_message.id();
+        if (full_block_message_hash == compact_block_message_received.block_message_hash)
+        {
+          dlog("reconstructed compact block ${id} with ${count} transactions from peer ${endpoint}",
+               ("id", compact_block_message_received.block_id)
+               ("count", compact_block_message_received.transaction_message_hashes.size())
+               ("endpoint", originating_peer->get_remote_endpoint()));
+          process_block_message(originating_peer, full_block_message, full_block_message_hash);
+          return;
+        }
+        wlog("compact block ${id} from peer ${endpoint} did not reconstruct to the block we asked for",
+             ("id", compact_block_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+      }
+
+      // we're missing some of its transactions, ask for the full block.  It is still
+      // in items_requested_from_peer, so it will be handled like any other block we fetched
+      dlog("missing transactions for compact block ${id}, requesting the full block from peer ${endpoint}",
+           ("id", compact_block_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+      originating_peer->send_message(fetch_items_message(block_message_type,
+                                                         std::vector<item_hash_t>{compact_block_message_received.block_message_hash}));
+    }
+
     void node_impl::on_item_not_available_message( peer_connection* originating_peer, const item_not_available_message& item_not_available_message_received )
     {
       VERIFY_CORRECT_THREAD();
@@ -2835,6 +3075,8 @@ namespace graphene { namespace net { namespace detail {
       if (sync_item_iter != originating_peer->sync_items_requested_from_peer.end())
       {
         originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
+        if (!release_sync_request(requested_item.item_hash))
+          _active_sync_requests.erase(requested_item.item_hash);
 
         if (originating_peer->peer_needs_sync_items_from_us)
           originating_peer->inhibit_fetching_sync_blocks = true;
@@ -2866,7 +3108,7 @@ namespace graphene { namespace net { namespace detail {
         bool we_requested_this_item_from_a_peer = false;
         for (const peer_connection_ptr peer : _active_connections)
         {
-          if (peer->inventory_advertised_to_peer.find(advertised_item_id) != peer->inventory_advertised_to_peer.end())
+          if (peer->inventory_advertised_to_peer.contains(advertised_item_id))
           {
             we_advertised_this_item_to_a_peer = true;
             break;
@@ -2885,7 +3127,7 @@ namespace graphene { namespace net { namespace detail {
                originating_peer->is_inventory_advertised_to_us_list_full_for_transactions()) ||
               originating_peer->is_inventory_advertised_to_us_list_full())
             break;
-          originating_peer->inventory_peer_advertised_to_us.insert(peer_connection::timestamped_item_id(advertised_item_id, fc::time_point::now()));
+          originating_peer->inventory_peer_advertised_to_us.insert(advertised_item_id);
           if (!we_requested_this_item_from_a_peer)
           {
             if (_recently_failed_items.find(item_id(item_ids_inventory_message_received.item_type, item_hash)) != _recently_failed_items.end())
@@ -3019,8 +3261,9 @@ namespace graphene { namespace net { namespace detail {
       // received yet, reschedule them to be fetched from another peer
       if (!originating_peer->sync_items_requested_from_peer.empty())
       {
-        for (auto sync_item : originating_peer->sync_items_requested_from_peer)
-          _active_sync_requests.erase(sync_item);
+        for (const auto& sync_item : originating_peer->sync_items_requested_from_peer)
+          if (!release_sync_request(sync_item.first))
+            _active_sync_requests.erase(sync_item.first);
         trigger_fetch_sync_items_loop();
       }
 
@@ -3079,6 +3322,9 @@ namespace graphene { namespace net { namespace detail {
         handle_message_exception = e;
       }
 
+      // the block stayed in the backlog while it was pushed so that it wasn't fetched again meanwhile
+      _received_sync_items.get<sync_item_id_index>().erase(block_message_to_send.block_id);
+
       // build up lists for any potentially-blocking operations we need to do, then do them
       // at the end of this function
       std::set<peer_connection_ptr> peers_with_newly_empty_item_lists;
@@ -3250,86 +3496,100 @@ namespace graphene { namespace net { namespace detail {
       std::set<peer_connection_ptr> peers_we_need_to_sync_to;
       std::map<peer_connection_ptr, fc::oexception> peers_with_rejected_block;
 
+      auto& received_by_id = _received_sync_items.get<sync_item_id_index>();
       do
       {
-        std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                  std::make_move_iterator(_new_received_sync_items.end()),
-                  std::front_inserter(_received_sync_items));
-        _new_received_sync_items.clear();
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
 
         block_processed_this_iteration = false;
-        for (auto received_block_iter = _received_sync_items.begin();
-             received_block_iter != _received_sync_items.end();
-             ++received_block_iter)
+
+        // the next block to push is one at the front of some peer's list of items to get.  Look up
+        // each peer's front in the backlog instead of checking every received block against every
+        // peer.  Usually it's the block following the last one we pushed; if there's none
+        // (the first block, or peers on other forks), take the lowest-numbered block we already have
+        auto next_block_iter = received_by_id.end();
+        for (const peer_connection_ptr& peer : _active_connections)
+        {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (peer->ids_of_items_to_get.empty())
+            continue;
+          auto received_block_iter = received_by_id.find(peer->ids_of_items_to_get.front());
+          if (received_block_iter == received_by_id.end() || received_block_iter->handed_to_delegate)
+            continue;
+          if (received_block_iter->block_num == _next_sync_block_num)
+          {
+            next_block_iter = received_block_iter;
+            break;
+          }
+          if (next_block_iter == received_by_id.end() || received_block_iter->block_num < next_block_iter->block_num)
+            next_block_iter = received_block_iter;
+        }
+
+        if (next_block_iter != received_by_id.end())
         {
+          const block_id_type next_block_id = next_block_iter->block_id();
 
-          // find out if this block is the next block on the active chain or one of the forks
-          bool potential_first_block = false;
+          // remove it from all sync peers lists
           for (const peer_connection_ptr& peer : _active_connections)
           {
             ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
             if (!peer->ids_of_items_to_get.empty() &&
-                peer->ids_of_items_to_get.front() == received_block_iter->block_id)
+                peer->ids_of_items_to_get.front() == next_block_id)
             {
-              potential_first_block = true;
               peer->ids_of_items_to_get.pop_front();
-              peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
+              peer->ids_of_items_being_processed.insert(next_block_id);
             }
           }
 
-          // if it is, process it, remove it from all sync peers lists
-          if (potential_first_block)
+          // we can get into an interesting situation near the end of synchronization.  We can be in
+          // sync with one peer who is sending us the last block on the chain via a regular inventory
+          // message, while at the same time still be synchronizing with a peer who is sending us the
+          // block through the sync mechanism.  Further, we must request both blocks because
+          // we don't know they're the same (for the peer in normal operation, it has only told us the
+          // message id, for the peer in the sync case we only known the block_id).
+          if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                        next_block_id) == _most_recent_blocks_accepted.end())
           {
-            // we can get into an interesting situation near the end of synchronization.  We can be in
-            // sync with one peer who is sending us the last block on the chain via a regular inventory
-            // message, while at the same time still be synchronizing with a peer who is sending us the
-            // block through the sync mechanism.  Further, we must request both blocks because
-            // we don't know they're the same (for the peer in normal operation, it has only told us the
-            // message id, for the peer in the sync case we only known the block_id).
-            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
-            {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
-              _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
-              ++blocks_processed;
-              block_processed_this_iteration = true;
-            }
-            else
+            graphene::net::block_message block_message_to_process = next_block_iter->block;
+            next_block_iter->handed_to_delegate = true;
+            _next_sync_block_num = next_block_iter->block_num + 1;
+            _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
+              send_sync_block_to_node_delegate(block_message_to_process);
+            }, "send_sync_block_to_node_delegate"));
+            ++blocks_processed;
+            block_processed_this_iteration = true;
+          }
+          else
+          {
+            dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+            _next_sync_block_num = next_block_iter->block_num + 1;
+            received_by_id.erase(next_block_iter);
+            std::vector< peer_connection_ptr > peers_needing_next_batch;
+            for (const peer_connection_ptr& peer : _active_connections)
             {
-              dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
-              std::vector< peer_connection_ptr > peers_needing_next_batch;
-              for (const peer_connection_ptr& peer : _active_connections)
+              auto items_being_processed_iter = peer->ids_of_items_being_processed.find(next_block_id);
+              if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
               {
-                auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
-                if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
+                peer->ids_of_items_being_processed.erase(items_being_processed_iter);
+                dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
+                     ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
+
+                // if we just processed the last item in our list from this peer, we will want to
+                // send another request to find out if we are now in sync (this is normally handled in
+                // send_sync_block_to_node_delegate)
+                if (peer->ids_of_items_to_get.empty() &&
+                    peer->number_of_unfetched_item_ids == 0 &&
+                    peer->ids_of_items_being_processed.empty())
                 {
-                  peer->ids_of_items_being_processed.erase(items_being_processed_iter);
-                  dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
-                       ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
-
-                  // if we just processed the last item in our list from this peer, we will want to
-                  // send another request to find out if we are now in sync (this is normally handled in
-                  // send_sync_block_to_node_delegate)
-                  if (peer->ids_of_items_to_get.empty() &&
-                      peer->number_of_unfetched_item_ids == 0 &&
-                      peer->ids_of_items_being_processed.empty())
-                  {
-                    dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
-                    peers_needing_next_batch.push_back( peer );
-                  }
+                  dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
+                  peers_needing_next_batch.push_back( peer );
                 }
               }
-              for( const peer_connection_ptr& peer : peers_needing_next_batch )
-                fetch_next_batch_of_item_ids_from_peer(peer.get());
             }
-
-            break; // start iterating _received_sync_items from the beginning
-          } // end if potential_first_block
-        } // end for each block in _received_sync_items
+            for( const peer_connection_ptr& peer : peers_needing_next_batch )
+              fetch_next_batch_of_item_ids_from_peer(peer.get());
+          }
+        }
 
         if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
         {
@@ -3362,9 +3622,10 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       dlog( "received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint() ) );
 
-      // add it to the front of _received_sync_items, then process _received_sync_items to try to
+      // add it to _received_sync_items, then process _received_sync_items to try to
       // pass as many messages as possible to the client.
-      _new_received_sync_items.push_front( block_message_to_process );
+      if( _received_sync_items.insert( received_sync_item( block_message_to_process ) ).second )
+        _delegate->prevalidate_block( block_message_to_process );
       trigger_process_backlog_of_sync_blocks();
     }
 
@@ -3430,8 +3691,7 @@ namespace graphene { namespace net { namespace detail {
         {
           ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
 
-          auto iter = peer->inventory_peer_advertised_to_us.find(block_message_item_id);
-          if (iter != peer->inventory_peer_advertised_to_us.end())
+          if (peer->inventory_peer_advertised_to_us.contains(block_message_item_id))
           {
             // this peer offered us the item.  It will eventually expire from the peer's
             // inventory_peer_advertised_to_us list after some time has passed (currently 2 minutes).
@@ -3539,17 +3799,37 @@ namespace graphene { namespace net { namespace detail {
         auto sync_item_iter = originating_peer->sync_items_requested_from_peer.find( block_message_to_process.block_id);
         if (sync_item_iter != originating_peer->sync_items_requested_from_peer.end())
         {
+          fc::time_point request_time = sync_item_iter->second;
           originating_peer->sync_items_requested_from_peer.erase(sync_item_iter);
           // if exceptions are throw here after removing the sync item from the list (above),
           // it could leave our sync in a stalled state.  Wrap a try/catch around the rest
           // of the function so we can log if this ever happens.
           try
           {
+            originating_peer->record_sync_block_received(request_time);
             originating_peer->last_sync_item_received_time = fc::time_point::now();
+
+            // a block we also requested from another peer is only processed the first time it arrives
+            bool already_received_from_another_peer = false;
+            auto hedge_iter = _hedged_sync_requests.find(block_message_to_process.block_id);
+            if (hedge_iter != _hedged_sync_requests.end())
+            {
+              already_received_from_another_peer = _active_sync_requests.find(block_message_to_process.block_id) == _active_sync_requests.end();
+              if (--hedge_iter->second == 0)
+                _hedged_sync_requests.erase(hedge_iter);
+            }
+
             _active_sync_requests.erase(block_message_to_process.block_id);
-            process_block_during_sync(originating_peer, block_message_to_process, message_hash);
+            if (already_received_from_another_peer)
+              dlog("dropping the second copy of sync block ${id} from peer ${endpoint}",
+                   ("id", block_message_to_process.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+            else
+              process_block_during_sync(originating_peer, block_message_to_process, message_hash);
             if (originating_peer->idle())
             {
+              // the peer delivered its whole batch, it can be trusted with a bigger one
+              originating_peer->sync_request_window = std::min<uint32_t>(originating_peer->sync_request_window * 2,
+                                                                         _maximum_blocks_per_peer_during_syncing);
               // we have finished fetching a batch of items, so we either need to grab another batch of items
               // or we need to get another list of item ids.
               if (originating_peer->number_of_unfetched_item_ids > 0 &&
@@ -3899,6 +4179,19 @@ namespace graphene { namespace net { namespace detail {
         {
           throw;
         }
+        catch ( const transaction_queue_full& )
+        {
+          // the client is backed up, the transaction itself may well be valid.  Stop fetching transactions from this
+          // peer for a while, and fetch this one again later from whoever has it
+          dlog( "client's transaction queue is full, inhibiting transaction fetching from peer ${peer}",
+                ("peer", originating_peer->get_remote_endpoint() ) );
+          originating_peer->transaction_fetching_inhibited_until = fc::time_point::now() + fc::seconds(GRAPHENE_NET_TRANSACTION_QUEUE_FULL_BACKOFF_SEC);
+          item_id refused_item( message_to_process.msg_type, message_hash );
+          if (is_item_in_any_peers_inventory(refused_item))
+            _items_to_fetch.insert(prioritized_item_id(refused_item, _items_to_fetch_sequence_counter++));
+          trigger_fetch_items_loop();
+          return;
+        }
         catch ( const fc::exception& e )
         {
           wlog( "client rejected message sent by peer ${peer}, ${e}", ("peer", originating_peer->get_remote_endpoint() )("e", e) );
@@ -4754,7 +5047,12 @@ namespace graphene { namespace net { namespace detail {
       ilog( "--------- MEMORY USAGE ------------" );
       ilog( "node._active_sync_requests size: ${size}", ("size", _active_sync_requests.size() ) );
       ilog( "node._received_sync_items size: ${size}", ("size", _received_sync_items.size() ) );
-      ilog( "node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size() ) );
+      if( !_received_sync_items.empty() )
+      {
+        const auto& received_by_num = _received_sync_items.get<sync_item_num_index>();
+        ilog( "  sync backlog spans blocks ${first} to ${last}",
+              ("first", received_by_num.begin()->block_num)("last", received_by_num.rbegin()->block_num) );
+      }
       ilog( "node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size() ) );
       ilog( "node._new_inventory size: ${size}", ("size", _new_inventory.size() ) );
       ilog( "node._message_cache size: ${size}", ("size", _message_cache.size() ) );
@@ -4916,6 +5214,12 @@ namespace graphene { namespace net { namespace detail {
         peer_details["current_head_block_number"] = _delegate->get_block_number(peer->last_block_delegate_has_seen);
         peer_details["current_head_block_time"] = peer->last_block_time_delegate_has_seen;
 
+        peer_details["sync_block_latency_ms"] = peer->sync_block_latency.count() / 1000;
+        peer_details["sync_block_interval_ms"] = peer->sync_block_interval.count() / 1000;
+        peer_details["sync_request_window"] = peer->sync_request_window;
+        peer_details["sync_blocks_received"] = peer->sync_blocks_received;
+        peer_details["sync_requests_overdue"] = peer->sync_requests_overdue;
+
         this_peer_status.info = peer_details;
         statuses.push_back(this_peer_status);
       }
@@ -5473,6 +5777,12 @@ namespace graphene { namespace net { namespace detail {
       INVOKE_AND_COLLECT_STATISTICS(handle_block, block_message, sync_mode, contained_transaction_message_ids);
     }
 
+    void statistics_gathering_node_delegate_wrapper::prevalidate_block( const graphene::net::block_message& block_message )
+    {
+      // called on the p2p thread, the delegate only queues work so there is nothing worth timing
+      _node_delegate->prevalidate_block( block_message );
+    }
+
     void statistics_gathering_node_delegate_wrapper::handle_transaction( const graphene::net::trx_message& transaction_message )
     {
       INVOKE_AND_COLLECT_STATISTICS(handle_transaction, transaction_message);
@@ -85,6 +85,13 @@ namespace graphene { namespace net
       peer_needs_sync_items_from_us(true),
       we_need_sync_items_from_peer(true),
       inhibit_fetching_sync_blocks(false),
+      sync_request_window(GRAPHENE_NET_MIN_BLOCKS_PER_PEER_DURING_SYNCING),
+      sync_blocks_received(0),
+      sync_requests_overdue(0),
+      // one generation more than the window, so items live for at least the full window
+      inventory_peer_advertised_to_us(GRAPHENE_NET_INVENTORY_GENERATIONS + 1),
+      inventory_advertised_to_peer(GRAPHENE_NET_INVENTORY_GENERATIONS + 1),
+      inventory_generation(current_inventory_generation()),
       transaction_fetching_inhibited_until(fc::time_point::min()),
       last_known_fork_block_number(0),
       firewall_check_state(nullptr),
@@ -264,14 +271,15 @@ namespace graphene { namespace net
       }
     } // connect_to()
 
-    void peer_connection::on_message( message_oriented_connection* originating_connection, const message& received_message )
+    void peer_connection::on_message( message_oriented_connection* originating_connection, const message& received_message,
+                                      const message_hash_type& message_hash )
     {
       VERIFY_CORRECT_THREAD();
       _currently_handling_message = true;
       BOOST_SCOPE_EXIT(this_) {
         this_->_currently_handling_message = false;
       } BOOST_SCOPE_EXIT_END
-      _node->on_message( this, received_message );
+      _node->on_message( this, received_message, message_hash );
     }
 
     void peer_connection::on_connection_closed( message_oriented_connection* originating_connection )
@@ -291,16 +299,30 @@ namespace graphene { namespace net
         ~counter() { assert(_send_message_queue_tasks_counter == 1); --_send_message_queue_tasks_counter; /* dlog("leaving peer_connection::send_queued_messages_task()"); */ }
       } concurrent_invocation_counter(_send_message_queue_tasks_running);
 #endif
+      std::vector<message> messages_to_send;
       while (!_queued_messages.empty())
       {
-        _queued_messages.front()->transmission_start_time = fc::time_point::now();
-        message message_to_send = _queued_messages.front()->get_message(_node);
+        // coalesce everything that is already queued, up to GRAPHENE_NET_MAX_COALESCED_SEND_SIZE
+        // bytes, into a single write.  Messages queued while we're writing go out in the next batch.
+        messages_to_send.clear();
+        size_t batch_size = 0;
+        fc::time_point transmission_start_time = fc::time_point::now();
+        for (auto queued_iter = _queued_messages.begin();
+             queued_iter != _queued_messages.end() &&
+             (messages_to_send.empty() || batch_size < GRAPHENE_NET_MAX_COALESCED_SEND_SIZE);
+             ++queued_iter)
+        {
+          (*queued_iter)->transmission_start_time = transmission_start_time;
+          messages_to_send.emplace_back((*queued_iter)->get_message(_node));
+          batch_size += sizeof(message_header) + messages_to_send.back().size;
+        }
+
         try
         {
-          //dlog("peer_connection::send_queued_messages_task() calling message_oriented_connection::send_message() "
-          //     "to send message of type ${type} for peer ${endpoint}",
-          //     ("type", message_to_send.msg_type)("endpoint", get_remote_endpoint()));
-          _message_connection.send_message(message_to_send);
+          //dlog("peer_connection::send_queued_messages_task() calling message_oriented_connection::send_messages() "
+          //     "to send ${count} messages for peer ${endpoint}",
+          //     ("count", messages_to_send.size())("endpoint", get_remote_endpoint()));
+          _message_connection.send_messages(messages_to_send);
           //dlog("peer_connection::send_queued_messages_task()'s call to message_oriented_connection::send_message() completed normally for peer ${endpoint}",
           //     ("endpoint", get_remote_endpoint()));
         }
@@ -330,9 +352,13 @@ namespace graphene { namespace net
         {
           elog("message_oriented_exception::send_message() threw an unhandled exception");
         }
-        _queued_messages.front()->transmission_finish_time = fc::time_point::now();
-        _total_queued_messages_size -= _queued_messages.front()->get_size_in_queue();
-        _queued_messages.pop();
+        fc::time_point transmission_finish_time = fc::time_point::now();
+        for (size_t i = 0; i < messages_to_send.size(); ++i)
+        {
+          _queued_messages.front()->transmission_finish_time = transmission_finish_time;
+          _total_queued_messages_size -= _queued_messages.front()->get_size_in_queue();
+          _queued_messages.pop_front();
+        }
       }
       //dlog("leaving peer_connection::send_queued_messages_task() due to queue exhaustion");
     }
@@ -341,7 +367,7 @@ namespace graphene { namespace net
     {
       VERIFY_CORRECT_THREAD();
       _total_queued_messages_size += message_to_send->get_size_in_queue();
-      _queued_messages.emplace(std::move(message_to_send));
+      _queued_messages.emplace_back(std::move(message_to_send));
       if (_total_queued_messages_size > GRAPHENE_NET_MAXIMUM_QUEUED_MESSAGES_IN_BYTES)
       {
         elog("send queue exceeded maximum size of ${max} bytes (current size ${current} bytes)",
@@ -474,28 +500,60 @@ namespace graphene { namespace net
       return _message_connection.get_shared_secret();
     }
 
+    uint32_t peer_connection::current_inventory_generation()
+    {
+      const uint32_t generation_length_in_seconds = GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES * 60 / GRAPHENE_NET_INVENTORY_GENERATIONS;
+      return fc::time_point_sec(fc::time_point::now()).sec_since_epoch() / generation_length_in_seconds;
+    }
+
     void peer_connection::clear_old_inventory()
     {
       VERIFY_CORRECT_THREAD();
-      fc::time_point_sec oldest_inventory_to_keep(fc::time_point::now() - fc::minutes(GRAPHENE_NET_MAX_INVENTORY_SIZE_IN_MINUTES));
-
-      // expire old items from inventory_advertised_to_peer
-      auto oldest_inventory_to_keep_iter = inventory_advertised_to_peer.get<timestamp_index>().lower_bound(oldest_inventory_to_keep);
-      auto begin_iter = inventory_advertised_to_peer.get<timestamp_index>().begin();
-      unsigned number_of_elements_advertised_to_peer_to_discard = std::distance(begin_iter, oldest_inventory_to_keep_iter);
-      inventory_advertised_to_peer.get<timestamp_index>().erase(begin_iter, oldest_inventory_to_keep_iter);
-
-      // also expire items from inventory_peer_advertised_to_us
-      oldest_inventory_to_keep_iter = inventory_peer_advertised_to_us.get<timestamp_index>().lower_bound(oldest_inventory_to_keep);
-      begin_iter = inventory_peer_advertised_to_us.get<timestamp_index>().begin();
-      unsigned number_of_elements_peer_advertised_to_discard = std::distance(begin_iter, oldest_inventory_to_keep_iter);
-      inventory_peer_advertised_to_us.get<timestamp_index>().erase(begin_iter, oldest_inventory_to_keep_iter);
+      // inventory_generation starts at the generation the connection was created in
+      uint32_t current_generation = current_inventory_generation();
+      if (current_generation == inventory_generation)
+        return;
+      uint32_t generations_passed = current_generation - inventory_generation;
+      inventory_generation = current_generation;
+
+      size_t number_of_elements_advertised_to_peer_to_discard = inventory_advertised_to_peer.advance(generations_passed);
+      size_t number_of_elements_peer_advertised_to_discard = inventory_peer_advertised_to_us.advance(generations_passed);
       dlog("Expiring old inventory for peer ${peer}: removing ${to_peer} items advertised to peer (${remain_to_peer} left), and ${to_us} advertised to us (${remain_to_us} left)",
            ("peer", get_remote_endpoint())
            ("to_peer", number_of_elements_advertised_to_peer_to_discard)("remain_to_peer", inventory_advertised_to_peer.size())
            ("to_us", number_of_elements_peer_advertised_to_discard)("remain_to_us", inventory_peer_advertised_to_us.size()));
     }
 
+    void peer_connection::record_sync_block_received(const fc::time_point& request_time)
+    {
+      VERIFY_CORRECT_THREAD();
+      fc::time_point now = fc::time_point::now();
+      // last_sync_item_received_time is also set when requesting, so this is the time the
+      // block took to arrive after the previous one or after the request, whichever was later
+      fc::microseconds interval = now - last_sync_item_received_time;
+      fc::microseconds latency = now - request_time;
+      if (sync_blocks_received == 0)
+      {
+        sync_block_interval = interval;
+        sync_block_latency = latency;
+      }
+      else
+      {
+        // exponential moving averages weighting the newest sample 1/8
+        sync_block_interval = fc::microseconds((sync_block_interval.count() * 7 + interval.count()) / 8);
+        sync_block_latency = fc::microseconds((sync_block_latency.count() * 7 + latency.count()) / 8);
+      }
+      ++sync_blocks_received;
+    }
+
+    fc::time_point peer_connection::get_sync_requests_overdue_time() const
+    {
+      VERIFY_CORRECT_THREAD();
+      fc::microseconds allowed_interval = std::max(fc::milliseconds(GRAPHENE_NET_MIN_SYNC_REQUEST_OVERDUE_MS),
+                                                   fc::microseconds(sync_block_interval.count() * GRAPHENE_NET_SYNC_REQUEST_OVERDUE_MULTIPLE));
+      return std::max(last_sync_item_received_time, last_sync_requests_overdue_time) + allowed_interval;
+    }
+
     // we have a higher limit for blocks than transactions so we will still fetch blocks even when transactions are throttled
     bool peer_connection::is_inventory_advertised_to_us_list_full_for_transactions() const
     {
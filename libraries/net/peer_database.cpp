@@ -26,26 +26,63 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/global_fun.hpp>
+#include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/tag.hpp>
 
 #include <fc/io/raw.hpp>
 #include <fc/io/raw_variant.hpp>
+#include <fc/io/datastream.hpp>
+#include <fc/io/fstream.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
 
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/config.hpp>
 
+#include <fstream>
+
 namespace graphene { namespace net {
   namespace detail
   {
     using namespace boost::multi_index;
 
+    // the peer database file starts with these, followed by log entries
+    const uint32_t peer_database_file_magic = 0x52454550; // "PEER"
+    const uint32_t peer_database_file_version = 1;
+
+    // each log entry is one of these, followed by a potential_peer_record or an endpoint
+    enum peer_database_log_operation
+    {
+      log_update_record = 0,
+      log_erase_record = 1
+    };
+
+    /**
+     * 0 if our last connection to the peer succeeded, 1 if we never tried it, and
+     * 2 + number_of_failed_connection_attempts if the last connection failed
+     */
+    uint32_t get_connection_health(const potential_peer_record& record)
+    {
+      if (record.last_connection_disposition == last_connection_succeeded)
+        return 0;
+      if (record.last_connection_disposition == never_attempted_to_connect)
+        return 1;
+      return 2 + record.number_of_failed_connection_attempts;
+    }
+
+    uint32_t get_record_address_bucket(const potential_peer_record& record)
+    {
+      return peer_database::get_address_bucket(record.endpoint);
+    }
+
     class peer_database_impl
     {
     public:
       struct last_seen_time_index {};
       struct endpoint_index {};
+      struct connection_health_index {};
+      struct address_bucket_index {};
       typedef boost::multi_index_container<potential_peer_record, 
                                            indexed_by<ordered_non_unique<tag<last_seen_time_index>, 
                                                                          member<potential_peer_record, 
@@ -55,11 +92,42 @@ namespace graphene { namespace net {
                                                                     member<potential_peer_record, 
                                                                            fc::ip::endpoint, 
                                                                            &potential_peer_record::endpoint>, 
-                                                                    std::hash<fc::ip::endpoint> > > > potential_peer_set;
+                                                                    std::hash<fc::ip::endpoint> >,
+                                                      ordered_non_unique<tag<connection_health_index>,
+                                                                         composite_key<potential_peer_record,
+                                                                                       global_fun<const potential_peer_record&,
+                                                                                                  uint32_t,
+                                                                                                  &get_connection_health>,
+                                                                                       member<potential_peer_record,
+                                                                                              fc::time_point_sec,
+                                                                                              &potential_peer_record::last_connection_attempt_time> > >,
+                                                      ordered_non_unique<tag<address_bucket_index>,
+                                                                         composite_key<potential_peer_record,
+                                                                                       global_fun<const potential_peer_record&,
+                                                                                                  uint32_t,
+                                                                                                  &get_record_address_bucket>,
+                                                                                       member<potential_peer_record,
+                                                                                              fc::time_point_sec,
+                                                                                              &potential_peer_record::last_seen_time> > > > > potential_peer_set;
 
     private:
       potential_peer_set     _potential_peer_set;
       fc::path _peer_database_filename;
+      std::ofstream _log;
+      // entries in the file, including ones superseded by later entries
+      size_t _log_entry_count = 0;
+      // entries appended since the log was last flushed
+      size_t _unflushed_entry_count = 0;
+      fc::time_point _oldest_unflushed_entry_time;
+
+      void load(const fc::path& filename);
+      void import_json(const fc::path& filename);
+      void compact();
+      void append_to_log(const potential_peer_record& updatedRecord);
+      void append_erase_to_log(const fc::ip::endpoint& erasedEndpoint);
+      void entry_appended();
+      void make_room_for(const fc::ip::endpoint& newEndpoint);
+      void prune();
 
     public:
       void open(const fc::path& databaseFilename);
@@ -69,6 +137,11 @@ namespace graphene { namespace net {
       void update_entry(const potential_peer_record& updatedRecord);
       potential_peer_record lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
       fc::optional<potential_peer_record> lookup_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
+      std::vector<potential_peer_record> get_connection_candidates(fc::time_point_sec now,
+                                                                   uint32_t retry_timeout,
+                                                                   size_t max_count,
+                                                                   const std::function<bool(const fc::ip::endpoint&)>& is_excluded,
+                                                                   const std::unordered_set<uint32_t>& buckets_in_use) const;
 
       peer_database::iterator begin() const;
       peer_database::iterator end() const;
@@ -90,45 +163,204 @@ namespace graphene { namespace net {
     void peer_database_impl::open(const fc::path& peer_database_filename)
     {
       _peer_database_filename = peer_database_filename;
-      if (fc::exists(_peer_database_filename))
+      fc::path legacy_filename = _peer_database_filename;
+      legacy_filename.replace_extension(".json");
+      try
       {
-        try
+        if (fc::exists(_peer_database_filename))
+          load(_peer_database_filename);
+        else if (legacy_filename != _peer_database_filename && fc::exists(legacy_filename))
+          import_json(legacy_filename);
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error opening peer database file ${peer_database_filename}, starting with a clean database: ${e}", 
+             ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
+        _potential_peer_set.clear();
+      }
+      prune();
+
+      try
+      {
+        fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
+        if (!fc::exists(peer_database_filename_dir))
+          fc::create_directories(peer_database_filename_dir);
+        compact();
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error writing peer database file ${peer_database_filename}, peers will not be saved: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
+      }
+    }
+
+    void peer_database_impl::load(const fc::path& filename)
+    {
+      std::string contents;
+      fc::read_file_contents(filename, contents);
+      fc::datastream<const char*> ds(contents.data(), contents.size());
+
+      uint32_t magic = 0;
+      uint32_t version = 0;
+      fc::raw::unpack(ds, magic);
+      fc::raw::unpack(ds, version);
+      FC_ASSERT(magic == peer_database_file_magic && version == peer_database_file_version,
+                "unrecognized peer database format", ("magic", magic)("version", version));
+
+      try
+      {
+        while (ds.remaining() > 0)
         {
-          std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
-          std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
-          if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+          uint8_t operation = 0;
+          fc::raw::unpack(ds, operation);
+          if (operation == log_erase_record)
+          {
+            fc::ip::endpoint erased_endpoint;
+            fc::raw::unpack(ds, erased_endpoint);
+            _potential_peer_set.get<endpoint_index>().erase(erased_endpoint);
+          }
+          else
           {
-            // prune database to a reasonable size
-            auto iter = _potential_peer_set.begin();
-            std::advance(iter, MAXIMUM_PEERDB_SIZE);
-            _potential_peer_set.erase(iter, _potential_peer_set.end());
+            FC_ASSERT(operation == log_update_record, "unknown peer database log operation ${operation}", ("operation", operation));
+            potential_peer_record record;
+            fc::raw::unpack(ds, record);
+            auto iter = _potential_peer_set.get<endpoint_index>().find(record.endpoint);
+            if (iter != _potential_peer_set.get<endpoint_index>().end())
+              _potential_peer_set.get<endpoint_index>().replace(iter, record);
+            else
+              _potential_peer_set.insert(record);
           }
         }
+      }
+      catch (const fc::exception& e)
+      {
+        // the entries before the damaged one are still good, e.g. when we died while appending
+        wlog("ignoring damaged tail of peer database file ${filename}: ${e}", ("filename", filename)("e", e.to_string()));
+      }
+    }
+
+    void peer_database_impl::import_json(const fc::path& filename)
+    {
+      ilog("importing peers from ${filename}", ("filename", filename));
+      std::vector<potential_peer_record> peer_records = fc::json::from_file(filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+      std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
+    }
+
+    void peer_database_impl::prune()
+    {
+      // evict the peers we haven't heard of for the longest time
+      auto& last_seen_index = _potential_peer_set.get<last_seen_time_index>();
+      while (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+        last_seen_index.erase(last_seen_index.begin());
+    }
+
+    void peer_database_impl::compact()
+    {
+      if (_log.is_open())
+        _log.close();
+
+      fc::path temporary_filename = _peer_database_filename.parent_path() / (_peer_database_filename.filename().string() + ".tmp");
+      {
+        std::ofstream snapshot(temporary_filename.generic_string().c_str(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc);
+        FC_ASSERT(snapshot, "unable to create ${filename}", ("filename", temporary_filename));
+        fc::raw::pack(snapshot, peer_database_file_magic);
+        fc::raw::pack(snapshot, peer_database_file_version);
+        for (const potential_peer_record& record : _potential_peer_set)
+        {
+          fc::raw::pack(snapshot, uint8_t(log_update_record));
+          fc::raw::pack(snapshot, record);
+        }
+        snapshot.flush();
+        FC_ASSERT(snapshot, "error writing ${filename}", ("filename", temporary_filename));
+      }
+      fc::rename(temporary_filename, _peer_database_filename);
+      _log_entry_count = _potential_peer_set.size();
+      _unflushed_entry_count = 0;
+
+      _log.open(_peer_database_filename.generic_string().c_str(), std::ofstream::binary | std::ofstream::out | std::ofstream::app);
+      FC_ASSERT(_log, "unable to open ${filename}", ("filename", _peer_database_filename));
+    }
+
+    void peer_database_impl::append_to_log(const potential_peer_record& updatedRecord)
+    {
+      if (!_log.is_open())
+        return;
+      fc::raw::pack(_log, uint8_t(log_update_record));
+      fc::raw::pack(_log, updatedRecord);
+      entry_appended();
+      // superseded entries make up most of the file, start over with one entry per record
+      if (_log_entry_count > _potential_peer_set.size() + MAXIMUM_PEERDB_SIZE)
+      {
+        try
+        {
+          compact();
+        }
         catch (const fc::exception& e)
         {
-          elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
-               ("peer_database_filename", _peer_database_filename));
+          elog("error compacting peer database file ${peer_database_filename}, peers will not be saved: ${e}",
+               ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
         }
       }
     }
 
-    void peer_database_impl::close()
+    void peer_database_impl::append_erase_to_log(const fc::ip::endpoint& erasedEndpoint)
     {
-      std::vector<potential_peer_record> peer_records;
-      peer_records.reserve(_potential_peer_set.size());
-      std::copy(_potential_peer_set.begin(), _potential_peer_set.end(), std::back_inserter(peer_records));
+      if (!_log.is_open())
+        return;
+      fc::raw::pack(_log, uint8_t(log_erase_record));
+      fc::raw::pack(_log, erasedEndpoint);
+      entry_appended();
+    }
 
-      try
+    void peer_database_impl::entry_appended()
+    {
+      ++_log_entry_count;
+      fc::time_point now = fc::time_point::now();
+      if (_unflushed_entry_count++ == 0)
+        _oldest_unflushed_entry_time = now;
+      // peers are updated on every connection attempt and address message, flushing each one
+      // would put a write on the node thread for every update
+      if (_unflushed_entry_count >= MAXIMUM_PEERDB_UNFLUSHED_ENTRIES ||
+          now - _oldest_unflushed_entry_time >= fc::seconds(MAXIMUM_PEERDB_FLUSH_DELAY_SEC))
       {
-        fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
-        if (!fc::exists(peer_database_filename_dir))
-          fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file( peer_records, _peer_database_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        _log.flush();
+        _unflushed_entry_count = 0;
       }
-      catch (const fc::exception& e)
+    }
+
+    void peer_database_impl::make_room_for(const fc::ip::endpoint& newEndpoint)
+    {
+      // a full address bucket makes room by evicting its own least recently seen peer,
+      // otherwise the least recently seen peer overall goes once the database is full
+      auto& bucket_index = _potential_peer_set.get<address_bucket_index>();
+      auto bucket_range = bucket_index.equal_range(boost::make_tuple(peer_database::get_address_bucket(newEndpoint)));
+      if (std::distance(bucket_range.first, bucket_range.second) >= MAXIMUM_PEERDB_RECORDS_PER_ADDRESS_BUCKET)
+      {
+        append_erase_to_log(bucket_range.first->endpoint);
+        bucket_index.erase(bucket_range.first);
+      }
+      else if (_potential_peer_set.size() >= MAXIMUM_PEERDB_SIZE)
+      {
+        auto& last_seen_index = _potential_peer_set.get<last_seen_time_index>();
+        append_erase_to_log(last_seen_index.begin()->endpoint);
+        last_seen_index.erase(last_seen_index.begin());
+      }
+    }
+
+    void peer_database_impl::close()
+    {
+      if (_log.is_open())
       {
-        elog("error saving peer database to file ${peer_database_filename}", 
-             ("peer_database_filename", _peer_database_filename));
+        try
+        {
+          compact();
+        }
+        catch (const fc::exception& e)
+        {
+          elog("error saving peer database to file ${peer_database_filename}: ${e}", 
+               ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
+        }
+        _log.close();
       }
       _potential_peer_set.clear();
     }
@@ -136,22 +368,46 @@ namespace graphene { namespace net {
     void peer_database_impl::clear()
     {
       _potential_peer_set.clear();
+      if (_log.is_open())
+      {
+        try
+        {
+          compact();
+        }
+        catch (const fc::exception& e)
+        {
+          elog("error clearing peer database file ${peer_database_filename}, peers will not be saved: ${e}",
+               ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
+        }
+      }
     }
 
     void peer_database_impl::erase(const fc::ip::endpoint& endpointToErase)
     {
       auto iter = _potential_peer_set.get<endpoint_index>().find(endpointToErase);
       if (iter != _potential_peer_set.get<endpoint_index>().end())
+      {
         _potential_peer_set.get<endpoint_index>().erase(iter);
+        append_erase_to_log(endpointToErase);
+      }
     }
 
     void peer_database_impl::update_entry(const potential_peer_record& updatedRecord)
     {
       auto iter = _potential_peer_set.get<endpoint_index>().find(updatedRecord.endpoint);
       if (iter != _potential_peer_set.get<endpoint_index>().end())
+      {
+        // records are often written back unchanged, e.g. when a peer repeats an address we know
+        if (fc::raw::pack(*iter) == fc::raw::pack(updatedRecord))
+          return;
         _potential_peer_set.get<endpoint_index>().modify(iter, [&updatedRecord](potential_peer_record& record) { record = updatedRecord; });
+      }
       else
+      {
+        make_room_for(updatedRecord.endpoint);
         _potential_peer_set.get<endpoint_index>().insert(updatedRecord);
+      }
+      append_to_log(updatedRecord);
     }
 
     potential_peer_record peer_database_impl::lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup)
@@ -170,6 +426,54 @@ namespace graphene { namespace net {
       return fc::optional<potential_peer_record>();
     }
 
+    std::vector<potential_peer_record> peer_database_impl::get_connection_candidates(fc::time_point_sec now,
+                                                                                     uint32_t retry_timeout,
+                                                                                     size_t max_count,
+                                                                                     const std::function<bool(const fc::ip::endpoint&)>& is_excluded,
+                                                                                     const std::unordered_set<uint32_t>& buckets_in_use) const
+    {
+      std::vector<potential_peer_record> candidates;
+      std::vector<potential_peer_record> candidates_in_used_buckets;
+      std::unordered_set<uint32_t> buckets(buckets_in_use);
+
+      const auto& health_index = _potential_peer_set.get<connection_health_index>();
+      auto iter = health_index.begin();
+      while (iter != health_index.end() && candidates.size() < max_count)
+      {
+        uint32_t health = get_connection_health(*iter);
+        auto group_end = health_index.upper_bound(boost::make_tuple(health));
+        auto eligible_end = group_end;
+        if (health >= 2)
+        {
+          // only the peers tried before the cutoff have waited out their backoff, and those
+          // come first because the group is ordered by last_connection_attempt_time
+          uint64_t delay = uint64_t(health - 1) * retry_timeout;
+          fc::time_point_sec cutoff = delay < now.sec_since_epoch() ? fc::time_point_sec(now.sec_since_epoch() - uint32_t(delay)) : fc::time_point_sec();
+          eligible_end = health_index.lower_bound(boost::make_tuple(health, cutoff));
+        }
+
+        for (; iter != eligible_end && candidates.size() < max_count; ++iter)
+        {
+          if (is_excluded(iter->endpoint))
+            continue;
+          if (buckets.insert(peer_database::get_address_bucket(iter->endpoint)).second)
+            candidates.push_back(*iter);
+          else if (candidates_in_used_buckets.size() < max_count)
+            candidates_in_used_buckets.push_back(*iter);
+        }
+        iter = group_end;
+      }
+
+      // not enough diverse peers, fall back to the healthiest of the others
+      for (const potential_peer_record& record : candidates_in_used_buckets)
+      {
+        if (candidates.size() >= max_count)
+          break;
+        candidates.push_back(record);
+      }
+      return candidates;
+    }
+
     peer_database::iterator peer_database_impl::begin() const
     {
       return peer_database::iterator(new peer_database_iterator_impl(_potential_peer_set.get<last_seen_time_index>().begin()));
@@ -223,6 +527,11 @@ namespace graphene { namespace net {
   peer_database::~peer_database()
   {}
 
+  uint32_t peer_database::get_address_bucket(const fc::ip::endpoint& endpoint)
+  {
+    return uint32_t(endpoint.get_address()) >> 16;
+  }
+
   void peer_database::open(const fc::path& databaseFilename)
   {
     my->open(databaseFilename);
@@ -258,6 +567,15 @@ namespace graphene { namespace net {
     return my->lookup_entry_for_endpoint(endpoint_to_lookup);
   }
 
+  std::vector<potential_peer_record> peer_database::get_connection_candidates(fc::time_point_sec now,
+                                                                              uint32_t retry_timeout,
+                                                                              size_t max_count,
+                                                                              const std::function<bool(const fc::ip::endpoint&)>& is_excluded,
+                                                                              const std::unordered_set<uint32_t>& buckets_in_use) const
+  {
+    return my->get_connection_candidates(now, retry_timeout, max_count, is_excluded, buckets_in_use);
+  }
+
   peer_database::iterator peer_database::begin() const
   {
     return my->begin();
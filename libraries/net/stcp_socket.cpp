@@ -78,6 +78,13 @@ void stcp_socket::bind( const fc::ip::endpoint& local_endpoint )
   _sock.bind(local_endpoint);
 }
 
+/**
+ *  Size of the chunks read from and written to the underlying TCP socket.  Reads
+ *  fetch as much as is available up to this size and decrypt it in one pass, so a
+ *  message header and a small body are usually served by a single socket read.
+ */
+static const size_t stcp_buffer_length = 16 * 1024;
+
 /**
  *   This method must read at least 16 bytes at a time from
  *   the underlying TCP socket so that it can decrypt them. It
@@ -98,20 +105,39 @@ size_t stcp_socket::readsome( char* buffer, size_t len )
     } buffer_in_use_checker(_read_buffer_in_use);
 #endif
 
-    const size_t read_buffer_length = 4096;
-    if (!_read_buffer)
-      _read_buffer.reset(new char[read_buffer_length], [](char* p){ delete[] p; });
+    if (_plaintext_begin < _plaintext_end)
+    {
+      // both the buffered amount and len are multiples of 16, so is what we return
+      len = std::min<size_t>(_plaintext_end - _plaintext_begin, len);
+      memcpy(buffer, _plaintext_buffer.get() + _plaintext_begin, len);
+      _plaintext_begin += len;
+      return len;
+    }
 
-    len = std::min<size_t>(read_buffer_length, len);
+    if (!_read_buffer)
+      _read_buffer.reset(new char[stcp_buffer_length], [](char* p){ delete[] p; });
 
-    size_t s = _sock.readsome( _read_buffer, len, 0 );
+    size_t s = _sock.readsome( _read_buffer, stcp_buffer_length, 0 );
     if( s % 16 ) 
     {
       _sock.read(_read_buffer, 16 - (s%16), s);
       s += 16-(s%16);
     }
-    _recv_aes.decode( _read_buffer.get(), s, buffer );
-    return s;
+
+    // if everything we got fits, decrypt straight into the caller's buffer, otherwise keep the rest
+    if (s <= len)
+    {
+      _recv_aes.decode( _read_buffer.get(), s, buffer );
+      return s;
+    }
+
+    if (!_plaintext_buffer)
+      _plaintext_buffer.reset(new char[stcp_buffer_length]);
+    _recv_aes.decode( _read_buffer.get(), s, _plaintext_buffer.get() );
+    memcpy(buffer, _plaintext_buffer.get(), len);
+    _plaintext_begin = len;
+    _plaintext_end = s;
+    return len;
 } FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
 
 size_t stcp_socket::readsome( const std::shared_ptr<char>& buf, size_t len, size_t offset ) 
@@ -121,7 +147,7 @@ size_t stcp_socket::readsome( const std::shared_ptr<char>& buf, size_t len, size
 
 bool stcp_socket::eof()const
 {
-  return _sock.eof();
+  return _plaintext_begin == _plaintext_end && _sock.eof();
 }
 
 size_t stcp_socket::writesome( const char* buffer, size_t len )
@@ -139,10 +165,9 @@ size_t stcp_socket::writesome( const char* buffer, size_t len )
     } buffer_in_use_checker(_write_buffer_in_use);
 #endif
 
-    const std::size_t write_buffer_length = 4096;
     if (!_write_buffer)
-      _write_buffer.reset(new char[write_buffer_length], [](char* p){ delete[] p; });
-    len = std::min<size_t>(write_buffer_length, len);
+      _write_buffer.reset(new char[stcp_buffer_length], [](char* p){ delete[] p; });
+    len = std::min<size_t>(stcp_buffer_length, len);
     memset(_write_buffer.get(), 0, len); // just in case aes.encode screws up
     /**
      * every sizeof(crypt_buf) bytes the aes channel
@@ -68,6 +68,7 @@ class account_history_plugin : public muse::app::plugin
       virtual ~account_history_plugin();
 
       std::string plugin_name()const override;
+      bool plugin_supports_replica()const override { return true; }
       virtual void plugin_set_program_options(
          boost::program_options::options_description& cli,
          boost::program_options::options_description& cfg) override;
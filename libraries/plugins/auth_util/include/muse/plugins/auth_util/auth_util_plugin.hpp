@@ -12,6 +12,7 @@ class auth_util_plugin : public muse::app::plugin
       virtual ~auth_util_plugin();
 
       virtual std::string plugin_name()const override;
+      virtual bool plugin_supports_replica()const override { return true; }
       virtual void plugin_initialize( const boost::program_options::variables_map& options ) override;
       virtual void plugin_startup() override;
       virtual void plugin_shutdown() override;
@@ -0,0 +1,117 @@
+#include <muse/app/api_context.hpp>
+#include <muse/app/application.hpp>
+#include <muse/chain/protocol/operations.hpp>
+
+#include <muse/plugins/block_profiler/block_profiler_api.hpp>
+#include <muse/plugins/block_profiler/block_profiler_plugin.hpp>
+
+namespace muse { namespace plugin { namespace block_profiler {
+
+namespace detail {
+
+struct get_operation_name
+{
+   std::string& name;
+   get_operation_name( std::string& n ):name(n){}
+
+   typedef void result_type;
+   template<typename T> void operator()( const T& )const
+   {
+      name = fc::get_typename<T>::name();
+      size_t p = name.rfind(':');
+      if( p != std::string::npos )
+         name = name.substr( p+1 );
+   }
+};
+
+class block_profiler_api_impl
+{
+   public:
+      block_profiler_api_impl( muse::app::application& _app );
+
+      chain::block_profiler& profiler()const { return app.chain_database()->get_block_profiler(); }
+
+      muse::app::application& app;
+};
+
+block_profiler_api_impl::block_profiler_api_impl( muse::app::application& _app ) : app( _app )
+{}
+
+} // detail
+
+block_profiler_api::block_profiler_api( const muse::app::api_context& ctx )
+{
+   my = std::make_shared< detail::block_profiler_api_impl >(ctx.app);
+}
+
+void block_profiler_api::on_api_startup() { }
+
+chain::timing_histogram block_profiler_api::get_block_timing()const
+{
+   return my->profiler().get_block_timing();
+}
+
+std::vector< phase_timing > block_profiler_api::get_phase_timings()const
+{
+   const auto& phases = my->profiler().get_phase_timings();
+   std::vector< phase_timing > result;
+   result.reserve( phases.size() );
+   for( uint32_t i = 0; i < phases.size(); ++i )
+   {
+      result.emplace_back();
+      result.back().phase = chain::apply_block_phase( i );
+      result.back().timing = phases[i];
+   }
+   return result;
+}
+
+std::vector< operation_timing > block_profiler_api::get_operation_timings()const
+{
+   const auto& ops = my->profiler().get_operation_profiles();
+   std::vector< operation_timing > result;
+   for( int64_t i = 0; i < int64_t( ops.size() ); ++i )
+   {
+      if( ops[i].timing.count == 0 )
+         continue;
+      chain::operation op;
+      op.set_which( i );
+      result.emplace_back();
+      op.visit( detail::get_operation_name( result.back().operation ) );
+      result.back().timing = ops[i].timing;
+      result.back().objects_written = ops[i].objects_written;
+      result.back().bytes_allocated = ops[i].bytes_allocated;
+   }
+   return result;
+}
+
+std::vector< chain::slow_transaction_record > block_profiler_api::get_slow_transactions()const
+{
+   const auto& slow = my->profiler().get_slow_transactions();
+   return std::vector< chain::slow_transaction_record >( slow.begin(), slow.end() );
+}
+
+profiler_status block_profiler_api::get_profiler_status()const
+{
+   profiler_status result;
+   result.enabled = my->profiler().enabled();
+   result.slow_transaction_threshold_us = my->profiler().get_slow_transaction_threshold();
+   return result;
+}
+
+void block_profiler_api::set_profiling_enabled( bool enabled )
+{
+   ilog( "Block profiling ${s}", ("s", enabled ? "enabled" : "disabled") );
+   my->profiler().set_enabled( enabled );
+}
+
+void block_profiler_api::set_slow_transaction_threshold( uint64_t threshold_us )
+{
+   my->profiler().set_slow_transaction_threshold( threshold_us );
+}
+
+void block_profiler_api::reset_timings()
+{
+   my->profiler().reset();
+}
+
+} } } // muse::plugin::block_profiler
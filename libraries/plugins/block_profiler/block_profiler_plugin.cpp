@@ -0,0 +1,61 @@
+#include <muse/chain/database.hpp>
+
+#include <muse/plugins/block_profiler/block_profiler_api.hpp>
+#include <muse/plugins/block_profiler/block_profiler_plugin.hpp>
+
+#include <string>
+
+namespace muse { namespace plugin { namespace block_profiler {
+
+block_profiler_plugin::block_profiler_plugin() {}
+block_profiler_plugin::~block_profiler_plugin() {}
+
+std::string block_profiler_plugin::plugin_name()const
+{
+   return "block_profiler";
+}
+
+void block_profiler_plugin::plugin_set_program_options(
+   boost::program_options::options_description& cli,
+   boost::program_options::options_description& cfg )
+{
+   cli.add_options()
+         ("block-profiler-trace-file", boost::program_options::value<std::string>(),
+           "Append a binary record of per-phase apply_block timings for every block to this file")
+         ("block-profiler-slow-trx-us", boost::program_options::value<uint64_t>()->default_value(0),
+           "Log transactions taking at least this many microseconds to apply (default: 0, disabled)")
+         ("block-profiler-disabled", boost::program_options::bool_switch()->default_value(false),
+           "Start with profiling switched off, it can be turned on later through block_profiler_api")
+         ;
+   cfg.add(cli);
+}
+
+void block_profiler_plugin::plugin_initialize( const boost::program_options::variables_map& options )
+{ try {
+   chain::block_profiler& profiler = database().get_block_profiler();
+   profiler.set_enabled( !options.at( "block-profiler-disabled" ).as< bool >() );
+   profiler.set_slow_transaction_threshold( options.at( "block-profiler-slow-trx-us" ).as< uint64_t >() );
+
+   if( options.count( "block-profiler-trace-file" ) )
+   {
+      fc::path trace_file( options.at( "block-profiler-trace-file" ).as< std::string >() );
+      ilog( "Writing apply_block timings to ${f}", ("f", trace_file) );
+      profiler.open_trace_file( trace_file );
+   }
+} FC_LOG_AND_RETHROW() }
+
+void block_profiler_plugin::plugin_startup()
+{
+   app().register_api_factory< block_profiler_api >( "block_profiler_api" );
+}
+
+void block_profiler_plugin::plugin_shutdown()
+{
+   chain::block_profiler& profiler = database().get_block_profiler();
+   profiler.set_enabled( false );
+   profiler.close_trace_file();
+}
+
+} } } // muse::plugin::block_profiler
+
+MUSE_DEFINE_PLUGIN( block_profiler, muse::plugin::block_profiler::block_profiler_plugin )
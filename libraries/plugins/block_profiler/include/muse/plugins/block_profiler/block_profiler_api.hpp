@@ -0,0 +1,98 @@
+#pragma once
+
+#include <muse/chain/block_profiler.hpp>
+
+#include <fc/api.hpp>
+
+namespace muse { namespace app {
+   struct api_context;
+} }
+
+namespace muse { namespace plugin { namespace block_profiler {
+
+namespace detail {
+class block_profiler_api_impl;
+}
+
+struct phase_timing
+{
+   chain::apply_block_phase phase = chain::APPLY_BLOCK_PHASE_COUNT;
+   chain::timing_histogram  timing;
+};
+
+struct operation_timing
+{
+   std::string              operation;
+   chain::timing_histogram  timing;
+   uint64_t                 objects_written = 0;
+   uint64_t                 bytes_allocated = 0;
+};
+
+struct profiler_status
+{
+   bool                     enabled = false;
+   uint64_t                 slow_transaction_threshold_us = 0;
+};
+
+class block_profiler_api
+{
+   public:
+      block_profiler_api( const muse::app::api_context& ctx );
+
+      void on_api_startup();
+
+      /** @return the histogram of total _apply_block durations */
+      chain::timing_histogram get_block_timing()const;
+
+      /** @return one histogram per phase of _apply_block */
+      std::vector< phase_timing > get_phase_timings()const;
+
+      /** @return timings and object writes per operation type evaluated at least once while applying a block */
+      std::vector< operation_timing > get_operation_timings()const;
+
+      /** @return the most recent transactions that exceeded the slow transaction threshold */
+      std::vector< chain::slow_transaction_record > get_slow_transactions()const;
+
+      profiler_status get_profiler_status()const;
+
+      /** turn profiling on or off without restarting the node */
+      void set_profiling_enabled( bool enabled );
+
+      /** @param threshold_us log transactions taking at least this long, 0 disables the log */
+      void set_slow_transaction_threshold( uint64_t threshold_us );
+
+      void reset_timings();
+
+   private:
+      std::shared_ptr< detail::block_profiler_api_impl > my;
+};
+
+} } }
+
+FC_REFLECT( muse::plugin::block_profiler::phase_timing,
+   (phase)
+   (timing)
+   )
+
+FC_REFLECT( muse::plugin::block_profiler::operation_timing,
+   (operation)
+   (timing)
+   (objects_written)
+   (bytes_allocated)
+   )
+
+FC_REFLECT( muse::plugin::block_profiler::profiler_status,
+   (enabled)
+   (slow_transaction_threshold_us)
+   )
+
+FC_API( muse::plugin::block_profiler::block_profiler_api,
+   (get_block_timing)
+   (get_phase_timings)
+   (get_operation_timings)
+   (get_slow_transactions)
+   (get_profiler_status)
+   (set_profiling_enabled)
+   (set_slow_transaction_threshold)
+   (reset_timings)
+   )
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <muse/app/plugin.hpp>
+
+#include <string>
+
+namespace muse { namespace plugin { namespace block_profiler {
+
+/**
+ *  Enables the chain's block_profiler and exposes its timings through block_profiler_api.
+ */
+class block_profiler_plugin : public muse::app::plugin
+{
+   public:
+      block_profiler_plugin();
+      virtual ~block_profiler_plugin();
+
+      virtual std::string plugin_name()const override;
+      virtual bool plugin_supports_replica()const override { return true; }
+      virtual void plugin_set_program_options(
+         boost::program_options::options_description& cli,
+         boost::program_options::options_description& cfg ) override;
+      virtual void plugin_initialize( const boost::program_options::variables_map& options ) override;
+      virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
+};
+
+} } }
@@ -87,43 +87,47 @@ void debug_apply_update( chain::database& db, const fc::variant_object& vo )
 
    auto& idx = db.get_index( oid );
 
-   switch( action )
+   // readers on the API threads must not see the object half written
+   db.with_write_lock( [&]()
    {
-      case db_action_create:
-         /*
-         idx.create( [&]( object& obj )
-         {
-            idx.object_from_variant( vo, obj );
-         } );
-         */
-         FC_ASSERT( false );
-         break;
-      case db_action_write:
-         db.modify( db.get_object( oid ), [&idx,&vo]( graphene::db::object& obj )
-         {
-            idx.object_default( obj );
-            idx.object_from_variant( vo, obj, GRAPHENE_MAX_NESTED_OBJECTS );
-         } );
-         break;
-      case db_action_update:
-         db.modify( db.get_object( oid ), [&idx,&vo]( graphene::db::object& obj )
-         {
-            idx.object_from_variant( vo, obj, GRAPHENE_MAX_NESTED_OBJECTS );
-         } );
-         break;
-      case db_action_delete:
-         db.remove( db.get_object( oid ) );
-         break;
-      case db_action_set_hardfork:
-         {
-            uint32_t hardfork_id;
-            from_variant( vo[ "hardfork_id" ], hardfork_id, GRAPHENE_MAX_NESTED_OBJECTS );
-            db.set_hardfork( hardfork_id, false );
-         }
-         break;
-      default:
-         FC_ASSERT( false );
-   }
+      switch( action )
+      {
+         case db_action_create:
+            /*
+            idx.create( [&]( object& obj )
+            {
+               idx.object_from_variant( vo, obj );
+            } );
+            */
+            FC_ASSERT( false );
+            break;
+         case db_action_write:
+            db.modify( db.get_object( oid ), [&idx,&vo]( graphene::db::object& obj )
+            {
+               idx.object_default( obj );
+               idx.object_from_variant( vo, obj, GRAPHENE_MAX_NESTED_OBJECTS );
+            } );
+            break;
+         case db_action_update:
+            db.modify( db.get_object( oid ), [&idx,&vo]( graphene::db::object& obj )
+            {
+               idx.object_from_variant( vo, obj, GRAPHENE_MAX_NESTED_OBJECTS );
+            } );
+            break;
+         case db_action_delete:
+            db.remove( db.get_object( oid ) );
+            break;
+         case db_action_set_hardfork:
+            {
+               uint32_t hardfork_id;
+               from_variant( vo[ "hardfork_id" ], hardfork_id, GRAPHENE_MAX_NESTED_OBJECTS );
+               db.set_hardfork( hardfork_id, false );
+            }
+            break;
+         default:
+            FC_ASSERT( false );
+      }
+   } );
 }
 
 void debug_node_plugin::apply_debug_updates()
@@ -152,8 +156,11 @@ void debug_node_plugin::debug_update( const fc::variant_object& update )
    FC_ASSERT( head_block.valid() );
 
    // What the last block does has been changed by adding to node_property_object, so we have to re-apply it
-   db.pop_block();
-   db.push_block( *head_block );
+   db.with_write_lock( [&]()
+   {
+      db.pop_block();
+      db.push_block( *head_block );
+   } );
 }
 
 void debug_node_plugin::on_changed_objects( const std::vector<graphene::db::object_id_type>& ids )
@@ -40,6 +40,7 @@ class market_history_plugin : public muse::app::plugin
       virtual ~market_history_plugin();
 
       virtual std::string plugin_name()const override { return MARKET_HISTORY_PLUGIN_NAME; }
+      virtual bool plugin_supports_replica()const override { return true; }
       virtual void plugin_set_program_options(
          boost::program_options::options_description& cli,
          boost::program_options::options_description& cfg ) override;
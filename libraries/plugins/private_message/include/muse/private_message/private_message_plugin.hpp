@@ -150,6 +150,7 @@ class private_message_plugin : public muse::app::plugin
       virtual ~private_message_plugin();
 
       std::string plugin_name()const override;
+      bool plugin_supports_replica()const override { return true; }
       virtual void plugin_set_program_options(
          boost::program_options::options_description& cli,
          boost::program_options::options_description& cfg) override;
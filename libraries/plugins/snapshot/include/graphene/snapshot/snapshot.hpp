@@ -35,6 +35,7 @@ class snapshot_plugin : public muse::app::plugin {
       ~snapshot_plugin() {}
 
       std::string plugin_name()const override;
+      bool plugin_supports_replica()const override { return true; }
 
       virtual void plugin_set_program_options(
          boost::program_options::options_description &command_line_options,
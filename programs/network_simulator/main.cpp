@@ -0,0 +1,826 @@
+/**
+ *  Runs a small muse network inside one process to measure the behaviour of graphene::net::node.
+ *
+ *  Every simulated node is a complete muse::app::application with its own chain database and
+ *  p2p node.  Nodes never connect to each other directly: each connection goes through a
+ *  shaped_link, a loopback proxy that adds latency, limits bandwidth and counts the bytes.
+ *  Producer nodes run the witness plugin with the initminer key, so blocks are produced by the
+ *  same code as on a live witness.  The scenario (partitions, late joining nodes, prefilled
+ *  chains to sync) is driven by the command line options.
+ */
+#include <muse/app/application.hpp>
+#include <muse/witness/witness.hpp>
+#include <muse/chain/database.hpp>
+
+#include <graphene/net/exceptions.hpp>
+#include <graphene/utilities/key_conversion.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/string.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/variant_object.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace muse;
+using namespace muse::chain;
+namespace bpo = boost::program_options;
+
+struct link_shaping
+{
+   /** one-way delay added to every chunk of data */
+   fc::microseconds latency;
+   /** per link and direction, 0 for unlimited */
+   uint64_t         bytes_per_second = 0;
+};
+
+/**
+ *  One proxied TCP connection: bytes read from one socket are queued with the time at which
+ *  they would arrive over the shaped link, and written to the other socket at that time.
+ *  The queue is unbounded, a sender that exceeds the bandwidth only sees its data arrive later.
+ */
+class shaped_connection
+{
+   public:
+      shaped_connection( const link_shaping& shaping, uint64_t& byte_counter )
+      : _shaping( shaping ), _byte_counter( byte_counter ) {}
+
+      /** the socket accepted from the connecting node */
+      fc::tcp_socket& accepted_socket() { return _sockets[0]; }
+
+      void start( const fc::ip::endpoint& target )
+      {
+         _connect_task = fc::async( [this, target]() {
+            try
+            {
+               _sockets[1].connect_to( target );
+            }
+            catch( const fc::exception& )
+            {
+               close();
+               return;
+            }
+            for( uint32_t from = 0; from < 2; ++from )
+            {
+               _directions[from].reader = fc::async( [this, from]() { read_loop( from ); }, "shaped_connection read" );
+               _directions[from].writer = fc::async( [this, from]() { write_loop( from ); }, "shaped_connection write" );
+            }
+         }, "shaped_connection connect" );
+      }
+
+      void close()
+      {
+         if( _closed )
+            return;
+         _closed = true;
+         for( fc::tcp_socket& socket : _sockets )
+         {
+            try
+            {
+               socket.close();
+            }
+            catch( const fc::exception& )
+            {
+            }
+         }
+         for( direction& d : _directions )
+            if( d.writer.valid() && !d.writer.ready() )
+               d.writer.cancel( "shaped_connection closed" );
+      }
+
+      /** true once the connection is closed and none of its tasks is running */
+      bool finished()const
+      {
+         if( !_closed || ( _connect_task.valid() && !_connect_task.ready() ) )
+            return false;
+         for( const direction& d : _directions )
+            if( ( d.reader.valid() && !d.reader.ready() ) || ( d.writer.valid() && !d.writer.ready() ) )
+               return false;
+         return true;
+      }
+
+      void wait()
+      {
+         std::vector< fc::future< void >* > tasks = { &_connect_task };
+         for( direction& d : _directions )
+         {
+            tasks.push_back( &d.reader );
+            tasks.push_back( &d.writer );
+         }
+         for( fc::future< void >* task : tasks )
+         {
+            try
+            {
+               if( task->valid() )
+                  task->wait();
+            }
+            catch( const fc::exception& )
+            {
+            }
+         }
+      }
+
+   private:
+      struct direction
+      {
+         std::deque< std::pair< fc::time_point, std::vector< char > > > queue;
+         /** when the link has finished sending the last queued chunk */
+         fc::time_point                                                 link_free;
+         fc::promise< void >::ptr                                       data_ready;
+         fc::future< void >                                             reader;
+         fc::future< void >                                             writer;
+      };
+
+      void read_loop( uint32_t from )
+      {
+         direction& d = _directions[from];
+         std::vector< char > buffer( 64 * 1024 );
+         try
+         {
+            while( !_closed )
+            {
+               size_t bytes_read = _sockets[from].readsome( buffer.data(), buffer.size() );
+               _byte_counter += bytes_read;
+
+               fc::time_point sent = std::max( fc::time_point::now(), d.link_free );
+               if( _shaping.bytes_per_second > 0 )
+                  sent += fc::microseconds( int64_t( bytes_read * 1000000 / _shaping.bytes_per_second ) );
+               d.link_free = sent;
+               d.queue.emplace_back( sent + _shaping.latency, std::vector< char >( buffer.begin(), buffer.begin() + bytes_read ) );
+
+               if( d.data_ready )
+               {
+                  fc::promise< void >::ptr data_ready = d.data_ready;
+                  d.data_ready.reset();
+                  data_ready->set_value();
+               }
+            }
+         }
+         catch( const fc::exception& )
+         {
+         }
+         close();
+      }
+
+      void write_loop( uint32_t from )
+      {
+         direction& d = _directions[from];
+         fc::tcp_socket& to = _sockets[1 - from];
+         try
+         {
+            while( !_closed )
+            {
+               if( d.queue.empty() )
+               {
+                  d.data_ready = fc::promise< void >::ptr( new fc::promise< void >( "shaped_connection::data_ready" ) );
+                  fc::promise< void >::ptr data_ready = d.data_ready;
+                  data_ready->wait();
+                  continue;
+               }
+
+               std::pair< fc::time_point, std::vector< char > > chunk = std::move( d.queue.front() );
+               d.queue.pop_front();
+               fc::time_point now = fc::time_point::now();
+               if( chunk.first > now )
+                  fc::usleep( chunk.first - now );
+
+               const char* data = chunk.second.data();
+               size_t remaining = chunk.second.size();
+               while( remaining > 0 )
+               {
+                  size_t written = to.writesome( data, remaining );
+                  data += written;
+                  remaining -= written;
+               }
+            }
+         }
+         catch( const fc::canceled_exception& )
+         {
+         }
+         catch( const fc::exception& )
+         {
+         }
+         close();
+      }
+
+      const link_shaping&  _shaping;
+      uint64_t&            _byte_counter;
+      fc::tcp_socket       _sockets[2];
+      direction            _directions[2];
+      fc::future< void >   _connect_task;
+      bool                 _closed = false;
+};
+
+/**
+ *  A loopback proxy standing in for the network between two nodes.  The dialing node connects
+ *  to endpoint() instead of the target node's p2p endpoint.  While partitioned, existing
+ *  connections are closed and new ones are refused.
+ */
+class shaped_link
+{
+   public:
+      shaped_link( uint32_t from_node, uint32_t to_node, const fc::ip::endpoint& target, const link_shaping& shaping )
+      : from_node( from_node ), to_node( to_node ), _target( target ), _shaping( shaping )
+      {
+         _server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+         _accept_task = fc::async( [this]() { accept_loop(); }, "shaped_link accept" );
+      }
+
+      ~shaped_link()
+      {
+         try
+         {
+            _server.close();
+            if( _accept_task.valid() && !_accept_task.ready() )
+               _accept_task.cancel_and_wait( "shaped_link destroyed" );
+         }
+         catch( const fc::exception& )
+         {
+         }
+         for( const std::shared_ptr< shaped_connection >& connection : _connections )
+            connection->close();
+         for( const std::shared_ptr< shaped_connection >& connection : _connections )
+            connection->wait();
+      }
+
+      fc::ip::endpoint endpoint()const { return fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), _server.get_port() ); }
+      uint64_t bytes()const { return _bytes; }
+      bool partitioned()const { return _partitioned; }
+
+      void set_partitioned( bool partitioned )
+      {
+         _partitioned = partitioned;
+         if( _partitioned )
+            for( const std::shared_ptr< shaped_connection >& connection : _connections )
+               connection->close();
+      }
+
+      const uint32_t from_node;
+      const uint32_t to_node;
+
+   private:
+      void accept_loop()
+      {
+         while( true )
+         {
+            std::shared_ptr< shaped_connection > connection = std::make_shared< shaped_connection >( _shaping, _bytes );
+            _server.accept( connection->accepted_socket() );
+
+            _connections.remove_if( []( const std::shared_ptr< shaped_connection >& c ) { return c->finished(); } );
+            _connections.push_back( connection );
+            if( _partitioned )
+               connection->close();
+            else
+               connection->start( _target );
+         }
+      }
+
+      fc::ip::endpoint                                  _target;
+      const link_shaping&                               _shaping;
+      fc::tcp_server                                    _server;
+      fc::future< void >                                _accept_task;
+      std::list< std::shared_ptr< shaped_connection > > _connections;
+      uint64_t                                          _bytes = 0;
+      bool                                              _partitioned = false;
+};
+
+struct simulator_config
+{
+   uint32_t               node_count = 0;
+   uint32_t               peers_per_node = 0;
+   std::set< uint32_t >   producers;
+   link_shaping           shaping;
+   uint32_t               duration = 0;
+   uint32_t               prefill_blocks = 0;
+   uint32_t               late_nodes = 0;
+   uint32_t               late_start = 0;
+   fc::optional< uint32_t > partition_at;
+   fc::optional< uint32_t > heal_at;
+   uint16_t               base_port = 0;
+   uint32_t               seed = 0;
+   fc::path               data_dir;
+   fc::ecc::private_key   init_key;
+};
+
+struct simulated_node
+{
+   uint32_t                                     index = 0;
+   bpo::variables_map                           options;
+   std::unique_ptr< app::application >          app;
+   std::vector< std::shared_ptr< shaped_link > > outgoing_links;
+
+   bool                                         running = false;
+   fc::time_point                               started_at;
+   /** the highest head block number among the running nodes when this one started */
+   uint32_t                                     sync_target = 0;
+   uint32_t                                     head_at_start = 0;
+   fc::optional< fc::time_point >               synced_at;
+   uint32_t                                     last_applied_num = 0;
+   /** blocks applied again at or below a height already reached, i.e. while switching forks */
+   uint32_t                                     reapplied_blocks = 0;
+
+   fc::ip::endpoint p2p_endpoint( uint16_t base_port )const
+   {
+      return fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), base_port + index );
+   }
+};
+
+struct block_record
+{
+   uint32_t                       block_num = 0;
+   uint32_t                       first_node = 0;
+   fc::time_point                 first_applied;
+   std::vector< fc::time_point >  applied;
+};
+
+class network_simulator
+{
+   public:
+      network_simulator( const simulator_config& config )
+      : _config( config )
+      {
+         for( uint32_t i = 0; i < _config.node_count; ++i )
+         {
+            _nodes.emplace_back( new simulated_node() );
+            _nodes.back()->index = i;
+         }
+         build_topology();
+      }
+
+      void run()
+      {
+         _run_start = fc::time_point::now();
+         uint32_t first_late_node = _config.node_count - std::min( _config.late_nodes, _config.node_count );
+         for( uint32_t i = 0; i < first_late_node; ++i )
+            start_node( *_nodes[i] );
+
+         bool late_nodes_started = first_late_node == _config.node_count;
+         bool partitioned = false;
+         bool healed = false;
+         fc::time_point end = _run_start + fc::seconds( _config.duration );
+         fc::time_point next_link_check;
+         while( fc::time_point::now() < end )
+         {
+            uint32_t elapsed = uint32_t( ( fc::time_point::now() - _run_start ).to_seconds() );
+            if( _config.partition_at && !partitioned && elapsed >= *_config.partition_at )
+            {
+               std::cout << "t=" << elapsed << "s: partitioning the network\n";
+               set_partitioned( true );
+               partitioned = true;
+            }
+            if( _config.heal_at && partitioned && !healed && elapsed >= *_config.heal_at )
+            {
+               std::cout << "t=" << elapsed << "s: healing the partition\n";
+               set_partitioned( false );
+               healed = true;
+            }
+            if( !late_nodes_started && elapsed >= _config.late_start )
+            {
+               std::cout << "t=" << elapsed << "s: starting " << _config.late_nodes << " late node(s)\n";
+               for( uint32_t i = first_late_node; i < _config.node_count; ++i )
+                  start_node( *_nodes[i] );
+               late_nodes_started = true;
+            }
+
+            // nodes don't look for peers on their own, so dropped links are redialed here
+            if( fc::time_point::now() >= next_link_check )
+            {
+               connect_links();
+               next_link_check = fc::time_point::now() + fc::seconds( 1 );
+            }
+            update_sync_progress();
+            fc::usleep( fc::milliseconds( 100 ) );
+         }
+         _run_end = fc::time_point::now();
+      }
+
+      void report( std::ostream& out )const
+      {
+         out << "\n=== " << _config.node_count << " nodes, " << _links.size() << " links, latency "
+             << _config.shaping.latency.count() / 1000 << " ms, bandwidth ";
+         if( _config.shaping.bytes_per_second > 0 )
+            out << _config.shaping.bytes_per_second << " bytes/s";
+         else
+            out << "unlimited";
+         out << ", " << ( _run_end - _run_start ).to_seconds() << " s ===\n";
+
+         // propagation is measured from the first node applying a block to every other node that
+         // was already synced at that time
+         std::vector< int64_t > delays;
+         std::vector< int64_t > full_propagation;
+         uint32_t incomplete = 0;
+         uint32_t orphaned = 0;
+         for( const auto& entry : _blocks )
+         {
+            const block_record& record = entry.second;
+            int64_t slowest = 0;
+            bool complete = true;
+            for( const std::unique_ptr< simulated_node >& node : _nodes )
+            {
+               if( node->index == record.first_node || !node->synced_at || *node->synced_at > record.first_applied )
+                  continue;
+               if( record.applied[node->index] == fc::time_point() )
+               {
+                  complete = false;
+                  continue;
+               }
+               int64_t delay = ( record.applied[node->index] - record.first_applied ).count();
+               delays.push_back( delay );
+               slowest = std::max( slowest, delay );
+            }
+            if( complete )
+               full_propagation.push_back( slowest );
+            else
+               ++incomplete;
+            if( !is_on_final_chain( entry.first, record.block_num ) )
+               ++orphaned;
+         }
+
+         out << "blocks produced:           " << _blocks.size() << " (" << orphaned << " not on node 0's final chain)\n";
+         print_percentiles( out, "block propagation delay:   ", delays );
+         print_percentiles( out, "time to reach every node:  ", full_propagation );
+         out << "blocks missing on a node:  " << incomplete << "\n";
+
+         uint64_t total_bytes = 0;
+         for( const std::shared_ptr< shaped_link >& link : _links )
+            total_bytes += link->bytes();
+         out << "bytes sent over links:     " << total_bytes << "\n";
+         if( !_blocks.empty() )
+            out << "bytes per block:           " << total_bytes / _blocks.size() << " (includes sync and keepalive traffic)\n";
+
+         for( const std::unique_ptr< simulated_node >& node : _nodes )
+         {
+            if( !node->running )
+               continue;
+            out << "node " << std::setw( 3 ) << node->index << ": head " << node->app->chain_database()->head_block_num()
+                << ", " << node->app->p2p_node()->get_connection_count() << " connections, "
+                << node->reapplied_blocks << " blocks reapplied on fork switches";
+            uint32_t synced_blocks = node->sync_target > node->head_at_start ? node->sync_target - node->head_at_start : 0;
+            if( synced_blocks > 0 )
+            {
+               if( node->synced_at )
+               {
+                  double seconds = double( ( *node->synced_at - node->started_at ).count() ) / 1000000;
+                  out << ", synced " << synced_blocks << " blocks in " << std::fixed << std::setprecision( 2 ) << seconds
+                      << " s (" << std::setprecision( 1 ) << ( seconds > 0 ? synced_blocks / seconds : 0 ) << " blocks/s)";
+               }
+               else
+                  out << ", did not finish syncing " << synced_blocks << " blocks";
+            }
+            out << "\n";
+         }
+
+         std::set< block_id_type > heads;
+         for( const std::unique_ptr< simulated_node >& node : _nodes )
+            if( node->running )
+               heads.insert( node->app->chain_database()->head_block_id() );
+         out << "heads agree:               " << ( heads.size() == 1 ? "yes" : "no" ) << "\n";
+      }
+
+      void shutdown()
+      {
+         for( const std::unique_ptr< simulated_node >& node : _nodes )
+         {
+            if( !node->running )
+               continue;
+            try
+            {
+               node->app->shutdown_plugins();
+               node->app->shutdown();
+            }
+            catch( const fc::exception& e )
+            {
+               elog( "error shutting down node ${n}: ${e}", ("n",node->index)("e",e.to_detail_string()) );
+            }
+            node->app.reset();
+            node->running = false;
+         }
+         _links.clear();
+      }
+
+   private:
+      /** a ring keeps the network connected, the remaining links go to random peers */
+      void build_topology()
+      {
+         std::mt19937 random( _config.seed );
+         uint32_t n = _config.node_count;
+         for( uint32_t i = 0; i < n; ++i )
+         {
+            std::set< uint32_t > targets;
+            if( n > 1 )
+               targets.insert( ( i + 1 ) % n );
+            uint32_t wanted = std::min( _config.peers_per_node, n - 1 );
+            while( targets.size() < wanted )
+            {
+               uint32_t target = random() % n;
+               if( target != i )
+                  targets.insert( target );
+            }
+            for( uint32_t target : targets )
+            {
+               auto link = std::make_shared< shaped_link >( i, target, _nodes[target]->p2p_endpoint( _config.base_port ), _config.shaping );
+               _nodes[i]->outgoing_links.push_back( link );
+               _links.push_back( link );
+            }
+         }
+      }
+
+      void start_node( simulated_node& node )
+      {
+         fc::path data_dir = _config.data_dir / ( "node" + fc::to_string( node.index ) );
+         bool producer = _config.producers.count( node.index ) > 0;
+
+         node.app.reset( new app::application() );
+         node.app->register_plugin< witness_plugin::witness_plugin >();
+
+         std::vector< std::string > args = {
+            "--p2p-endpoint", std::string( node.p2p_endpoint( _config.base_port ) ),
+            "--enable-plugin", "witness"
+         };
+         for( const std::shared_ptr< shaped_link >& link : node.outgoing_links )
+         {
+            args.push_back( "--seed-node" );
+            args.push_back( std::string( link->endpoint() ) );
+         }
+         if( producer )
+         {
+            args.push_back( "--witness" );
+            args.push_back( "\"" MUSE_INIT_MINER_NAME "\"" );
+            args.push_back( "--private-key" );
+            args.push_back( graphene::utilities::key_to_wif( _config.init_key ) );
+            args.push_back( "--enable-stale-production" );
+         }
+
+         bpo::options_description cli, cfg;
+         node.app->set_program_options( cli, cfg );
+         bpo::store( bpo::command_line_parser( args ).options( cli ).run(), node.options );
+         bpo::notify( node.options );
+
+         node.app->initialize( data_dir, node.options );
+         node.app->initialize_plugins( node.options );
+         node.app->startup();
+
+         graphene::net::node_ptr p2p = node.app->p2p_node();
+         // every connection must go through a shaped link, so the node may neither look for
+         // peers by itself nor tell its peers about other nodes' real endpoints
+         p2p->set_advanced_node_parameters( fc::mutable_variant_object()
+            ( "desired_number_of_connections", 0 )
+            ( "maximum_number_of_connections", _config.node_count * 2 ) );
+         p2p->disable_peer_advertising();
+
+         database& db = *node.app->chain_database();
+         if( node.index == 0 )
+            prefill( db );
+
+         db.applied_block.connect( [this, &node]( const signed_block& b ) { on_applied_block( node, b ); } );
+         node.last_applied_num = db.head_block_num();
+         node.head_at_start = db.head_block_num();
+         node.started_at = fc::time_point::now();
+         for( const std::unique_ptr< simulated_node >& other : _nodes )
+            if( other->running )
+               node.sync_target = std::max( node.sync_target, other->app->chain_database()->head_block_num() );
+         if( node.index == 0 )
+            node.sync_target = db.head_block_num();
+         node.running = true;
+
+         node.app->startup_plugins();
+      }
+
+      /** gives the other nodes a chain to sync */
+      void prefill( database& db )
+      {
+         if( db.head_block_num() >= _config.prefill_blocks )
+            return;
+         std::cout << "generating " << _config.prefill_blocks - db.head_block_num() << " blocks on node 0\n";
+         while( db.head_block_num() < _config.prefill_blocks )
+            db.generate_block( db.get_slot_time( 1 ), MUSE_INIT_MINER_NAME, _config.init_key, database::skip_nothing );
+      }
+
+      void on_applied_block( simulated_node& node, const signed_block& b )
+      {
+         uint32_t block_num = b.block_num();
+         if( block_num <= node.last_applied_num && node.synced_at )
+            ++node.reapplied_blocks;
+         node.last_applied_num = block_num;
+
+         // the prefilled chain is measured as sync throughput, not as propagation
+         if( block_num <= _config.prefill_blocks )
+            return;
+
+         fc::time_point now = fc::time_point::now();
+         block_id_type id = b.id();
+         auto itr = _blocks.find( id );
+         if( itr == _blocks.end() )
+         {
+            block_record record;
+            record.block_num = block_num;
+            record.first_node = node.index;
+            record.first_applied = now;
+            record.applied.resize( _config.node_count );
+            itr = _blocks.emplace( id, std::move( record ) ).first;
+         }
+         if( itr->second.applied[node.index] == fc::time_point() )
+            itr->second.applied[node.index] = now;
+      }
+
+      void update_sync_progress()
+      {
+         for( const std::unique_ptr< simulated_node >& node : _nodes )
+            if( node->running && !node->synced_at && node->app->chain_database()->head_block_num() >= node->sync_target )
+               node->synced_at = fc::time_point::now();
+      }
+
+      void connect_links()
+      {
+         for( const std::shared_ptr< shaped_link >& link : _links )
+         {
+            if( link->partitioned() || !_nodes[link->from_node]->running || !_nodes[link->to_node]->running )
+               continue;
+            try
+            {
+               _nodes[link->from_node]->app->p2p_node()->connect_to_endpoint( link->endpoint() );
+            }
+            catch( const graphene::net::already_connected_to_requested_peer& )
+            {
+            }
+            catch( const fc::exception& e )
+            {
+               wlog( "unable to connect node ${a} to node ${b}: ${e}", ("a",link->from_node)("b",link->to_node)("e",e.to_string()) );
+            }
+         }
+      }
+
+      /** splits the nodes into a lower and an upper half */
+      void set_partitioned( bool partitioned )
+      {
+         uint32_t half = _config.node_count / 2;
+         for( const std::shared_ptr< shaped_link >& link : _links )
+            if( ( link->from_node < half ) != ( link->to_node < half ) )
+               link->set_partitioned( partitioned );
+      }
+
+      bool is_on_final_chain( const block_id_type& id, uint32_t block_num )const
+      {
+         const simulated_node& reference = *_nodes[0];
+         if( !reference.running )
+            return false;
+         try
+         {
+            return reference.app->chain_database()->get_block_id_for_num( block_num ) == id;
+         }
+         catch( const fc::exception& )
+         {
+            return false;
+         }
+      }
+
+      static void print_percentiles( std::ostream& out, const char* label, std::vector< int64_t > samples_us )
+      {
+         out << label;
+         if( samples_us.empty() )
+         {
+            out << "no samples\n";
+            return;
+         }
+         std::sort( samples_us.begin(), samples_us.end() );
+         auto percentile = [&samples_us]( uint32_t p ) {
+            return samples_us[ std::min< size_t >( samples_us.size() - 1, samples_us.size() * p / 100 ) ] / 1000;
+         };
+         out << "p50 " << percentile( 50 ) << " ms, p90 " << percentile( 90 ) << " ms, p99 " << percentile( 99 )
+             << " ms, max " << samples_us.back() / 1000 << " ms (" << samples_us.size() << " samples)\n";
+      }
+
+      const simulator_config&                          _config;
+      std::vector< std::unique_ptr< simulated_node > > _nodes;
+      std::vector< std::shared_ptr< shaped_link > >    _links;
+      std::map< block_id_type, block_record >          _blocks;
+      fc::time_point                                   _run_start;
+      fc::time_point                                   _run_end;
+};
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description options_description( "Muse network simulator" );
+      options_description.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("nodes,n", bpo::value< uint32_t >()->default_value( 8 ), "Number of nodes to simulate")
+         ("peers-per-node", bpo::value< uint32_t >()->default_value( 3 ), "Number of links each node dials, the first one always goes to the next node in a ring")
+         ("producers", bpo::value< std::vector< uint32_t > >()->multitoken()->default_value( std::vector< uint32_t >( 1, 0 ), "0" ),
+          "Nodes producing blocks with the initminer key.  Several producers in one network produce competing blocks for each slot")
+         ("latency-ms", bpo::value< uint32_t >()->default_value( 50 ), "One-way latency of every link")
+         ("bandwidth", bpo::value< uint64_t >()->default_value( 0 ), "Bytes per second of every link in each direction, 0 for unlimited")
+         ("duration", bpo::value< uint32_t >()->default_value( 60 ), "Seconds to run the simulation")
+         ("prefill-blocks", bpo::value< uint32_t >()->default_value( 0 ), "Blocks generated on node 0 before the network starts, for the other nodes to sync")
+         ("late-nodes", bpo::value< uint32_t >()->default_value( 0 ), "Number of nodes, taken from the end, that join the network late")
+         ("late-start", bpo::value< uint32_t >()->default_value( 30 ), "Second at which the late nodes start")
+         ("partition-at", bpo::value< uint32_t >(), "Second at which the links between the lower and upper half of the nodes are cut")
+         ("heal-at", bpo::value< uint32_t >(), "Second at which the partition ends")
+         ("base-port", bpo::value< uint16_t >()->default_value( 43000 ), "Node i listens for p2p connections on 127.0.0.1 at base-port + i")
+         ("seed", bpo::value< uint32_t >()->default_value( 1 ), "Seed of the random topology")
+         ("data-dir,d", bpo::value< boost::filesystem::path >(), "Directory for the nodes' data, a temporary directory by default")
+         ("init-key", bpo::value< std::string >(), "WIF private key of initminer, required unless built with IS_TEST_NET")
+         ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line( argc, argv, options_description ), options );
+         bpo::notify( options );
+      }
+      catch( const boost::program_options::error& e )
+      {
+         std::cerr << "Error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count( "help" ) )
+      {
+         std::cout << options_description << "\n";
+         return 0;
+      }
+
+      simulator_config config;
+      config.node_count = options["nodes"].as< uint32_t >();
+      config.peers_per_node = options["peers-per-node"].as< uint32_t >();
+      for( uint32_t producer : options["producers"].as< std::vector< uint32_t > >() )
+         config.producers.insert( producer );
+      config.shaping.latency = fc::milliseconds( options["latency-ms"].as< uint32_t >() );
+      config.shaping.bytes_per_second = options["bandwidth"].as< uint64_t >();
+      config.duration = options["duration"].as< uint32_t >();
+      config.prefill_blocks = options["prefill-blocks"].as< uint32_t >();
+      config.late_nodes = options["late-nodes"].as< uint32_t >();
+      config.late_start = options["late-start"].as< uint32_t >();
+      if( options.count( "partition-at" ) )
+         config.partition_at = options["partition-at"].as< uint32_t >();
+      if( options.count( "heal-at" ) )
+         config.heal_at = options["heal-at"].as< uint32_t >();
+      config.base_port = options["base-port"].as< uint16_t >();
+      config.seed = options["seed"].as< uint32_t >();
+
+      FC_ASSERT( config.node_count > 0, "At least one node is required" );
+      FC_ASSERT( uint32_t( config.base_port ) + config.node_count <= 0xffff, "base-port is too high for ${n} nodes", ("n",config.node_count) );
+      for( uint32_t producer : config.producers )
+         FC_ASSERT( producer < config.node_count, "Producer ${p} is not one of the ${n} nodes", ("p",producer)("n",config.node_count) );
+
+      if( options.count( "init-key" ) )
+      {
+         fc::optional< fc::ecc::private_key > init_key = graphene::utilities::wif_to_key( options["init-key"].as< std::string >() );
+         FC_ASSERT( init_key.valid(), "Unable to parse init-key" );
+         config.init_key = *init_key;
+      }
+      else
+      {
+#ifdef IS_TEST_NET
+         config.init_key = MUSE_INIT_PRIVATE_KEY;
+#else
+         FC_THROW( "This build has no known initminer key, pass it with --init-key" );
+#endif
+      }
+      FC_ASSERT( public_key_type( config.init_key.get_public_key() ) == MUSE_INIT_PUBLIC_KEY,
+                 "init-key is not the initminer key ${k} of this build", ("k",MUSE_INIT_PUBLIC_KEY_STR) );
+
+      std::unique_ptr< fc::temp_directory > temp_dir;
+      if( options.count( "data-dir" ) )
+      {
+         config.data_dir = options["data-dir"].as< boost::filesystem::path >();
+         if( config.data_dir.is_relative() )
+            config.data_dir = fc::current_path() / config.data_dir;
+      }
+      else
+      {
+         temp_dir.reset( new fc::temp_directory( fc::temp_directory_path() ) );
+         config.data_dir = temp_dir->path();
+      }
+
+      // a dozen nodes logging at info level would drown the report
+      fc::logger::get( DEFAULT_LOGGER ).set_log_level( fc::log_level::warn );
+      fc::logger::get( "p2p" ).set_log_level( fc::log_level::warn );
+
+      network_simulator simulator( config );
+      simulator.run();
+      simulator.report( std::cout );
+      simulator.shutdown();
+      return 0;
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << "Error: " << e.to_detail_string() << "\n";
+      return 1;
+   }
+}
@@ -0,0 +1,207 @@
+/**
+ *  Measures database_api read latency while blocks are being applied.
+ *
+ *  Blocks are replayed with push_block() from the block log of an existing node into a fresh
+ *  database, while client fibers issue a mix of database_api queries as RPC connections would.
+ *  Running it once with --api-read-threads 0 and once with worker threads shows how much reads
+ *  and block application delay each other.
+ */
+#include <muse/app/api_read_thread_pool.hpp>
+#include <muse/app/database_api.hpp>
+#include <muse/chain/block_database.hpp>
+#include <muse/chain/database.hpp>
+#include <muse/egenesis/egenesis.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace muse;
+using namespace muse::chain;
+namespace bpo = boost::program_options;
+
+static void print_percentiles( std::ostream& out, const char* label, std::vector< int64_t > samples_us )
+{
+   out << label;
+   if( samples_us.empty() )
+   {
+      out << "no samples\n";
+      return;
+   }
+   std::sort( samples_us.begin(), samples_us.end() );
+   auto percentile = [&samples_us]( uint32_t p ) {
+      return samples_us[ std::min< size_t >( samples_us.size() - 1, samples_us.size() * p / 100 ) ];
+   };
+   out << "p50 " << percentile( 50 ) << " us, p99 " << percentile( 99 ) << " us, max " << samples_us.back()
+       << " us (" << samples_us.size() << " samples)\n";
+}
+
+/**
+ *  Issues queries until stopped, recording the latency of each one.
+ */
+static void run_client( app::database_api& api, uint32_t seed, const bool& stopped, std::vector< int64_t >& latencies_us )
+{
+   std::mt19937 rng( seed );
+   while( !stopped )
+   {
+      fc::time_point start = fc::time_point::now();
+      try
+      {
+         switch( rng() % 6 )
+         {
+            case 0:
+               api.get_dynamic_global_properties();
+               break;
+            case 1:
+            {
+               uint64_t count = api.get_account_count();
+               if( count > 0 )
+                  api.get_account_from_id( account_id_type( rng() % count ) );
+               break;
+            }
+            case 2:
+               api.lookup_accounts( "", 100 );
+               break;
+            case 3:
+            {
+               uint32_t head = api.get_dynamic_global_properties().head_block_number;
+               if( head > 0 )
+                  api.get_block( 1 + rng() % head );
+               break;
+            }
+            case 4:
+               api.get_order_book( 50 );
+               break;
+            case 5:
+               api.lookup_content( "", 100 );
+               break;
+         }
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "query failed: ${e}", ("e",e.to_string()) );
+      }
+      latencies_us.push_back( ( fc::time_point::now() - start ).count() );
+      // let the other clients and the replay run, as separate RPC connections would
+      fc::yield();
+   }
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description options_description( "Muse API read load test" );
+      options_description.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("source-dir,s", bpo::value< boost::filesystem::path >(), "Data directory of a node whose blocks are replayed")
+         ("blocks,b", bpo::value< uint32_t >()->default_value( 0 ), "Number of blocks to replay, 0 for all of them")
+         ("clients,c", bpo::value< uint32_t >()->default_value( 16 ), "Number of concurrent API clients")
+         ("api-read-threads,t", bpo::value< uint32_t >()->default_value( 2 ), "Threads serving queries, 0 serves them on the chain thread")
+         ("genesis-json", bpo::value< boost::filesystem::path >(), "Genesis of the source chain, the built in genesis by default")
+         ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line( argc, argv, options_description ), options );
+         bpo::notify( options );
+      }
+      catch( const boost::program_options::error& e )
+      {
+         std::cerr << "Error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count( "help" ) || !options.count( "source-dir" ) )
+      {
+         std::cout << options_description << "\n";
+         return options.count( "help" ) ? 0 : 1;
+      }
+
+      genesis_state_type genesis;
+      if( options.count( "genesis-json" ) )
+         genesis = fc::json::from_file( fc::path( options["genesis-json"].as< boost::filesystem::path >() ) ).as< genesis_state_type >( 20 );
+      else
+      {
+         std::string egenesis_json;
+         muse::egenesis::compute_egenesis_json( egenesis_json );
+         genesis = fc::json::from_string( egenesis_json ).as< genesis_state_type >( 20 );
+      }
+      genesis.initial_chain_id = MUSE_CHAIN_ID;
+
+      block_database source;
+      source.open( fc::path( options["source-dir"].as< boost::filesystem::path >() ) / "blockchain" / "database" / "block_num_to_block" );
+      optional< block_id_type > last_id = source.last_id();
+      FC_ASSERT( last_id.valid(), "The source block log is empty" );
+      uint32_t last_block = block_header::num_from_id( *last_id );
+      if( options["blocks"].as< uint32_t >() > 0 )
+         last_block = std::min( last_block, options["blocks"].as< uint32_t >() );
+
+      fc::temp_directory data_dir;
+      database db;
+      db.open( data_dir.path(), genesis, "api_read_load_test" );
+
+      auto read_threads = std::make_shared< app::api_read_thread_pool >( db, options["api-read-threads"].as< uint32_t >() );
+      app::database_api api( db, read_threads );
+
+      bool stopped = false;
+      uint32_t client_count = options["clients"].as< uint32_t >();
+      std::vector< std::vector< int64_t > > latencies( client_count );
+      std::vector< fc::future< void > > clients;
+      for( uint32_t i = 0; i < client_count; ++i )
+         clients.push_back( fc::async( [&, i]() { run_client( api, i, stopped, latencies[i] ); }, "api_client" ) );
+
+      std::vector< int64_t > apply_us;
+      apply_us.reserve( last_block );
+      const uint32_t skip = database::skip_witness_signature |
+                            database::skip_transaction_signatures |
+                            database::skip_transaction_dupe_check |
+                            database::skip_tapos_check |
+                            database::skip_authority_check |
+                            database::skip_validate_invariants;
+      fc::time_point replay_start = fc::time_point::now();
+      for( uint32_t num = db.head_block_num() + 1; num <= last_block; ++num )
+      {
+         optional< signed_block > block = source.fetch_by_number( num );
+         FC_ASSERT( block.valid(), "Block ${n} is missing from the source block log", ("n",num) );
+         fc::time_point start = fc::time_point::now();
+         db.push_block( *block, skip );
+         apply_us.push_back( ( fc::time_point::now() - start ).count() );
+         fc::yield();
+      }
+      fc::microseconds replay_time = fc::time_point::now() - replay_start;
+
+      stopped = true;
+      for( fc::future< void >& client : clients )
+         client.wait();
+
+      std::vector< int64_t > read_us;
+      for( const std::vector< int64_t >& client_latencies : latencies )
+         read_us.insert( read_us.end(), client_latencies.begin(), client_latencies.end() );
+
+      std::cout << "api read threads:  " << read_threads->thread_count() << ", clients: " << client_count << "\n";
+      std::cout << "blocks replayed:   " << apply_us.size() << " in " << replay_time.count() / 1000 << " ms\n";
+      print_percentiles( std::cout, "block apply time:  ", apply_us );
+      print_percentiles( std::cout, "query latency:     ", read_us );
+      if( replay_time.count() > 0 )
+         std::cout << "queries per second: " << read_us.size() * 1000000 / replay_time.count() << "\n";
+
+      db.close();
+      return 0;
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
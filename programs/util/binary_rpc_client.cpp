@@ -0,0 +1,83 @@
+/**
+ *  Downloads blocks from the binary RPC endpoint of a node (rpc-binary-endpoint) and reports the
+ *  transfer rate.  Optionally writes the blocks as JSON, one per line.
+ */
+#include <muse/app/binary_rpc.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <string>
+
+using namespace muse;
+using namespace muse::chain;
+namespace bpo = boost::program_options;
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description options_description( "Muse binary RPC client" );
+      options_description.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("server,s", bpo::value< std::string >()->default_value( "127.0.0.1:8091" ), "Binary RPC endpoint of the node")
+         ("start", bpo::value< uint32_t >()->default_value( 1 ), "First block to download")
+         ("count,c", bpo::value< uint32_t >()->default_value( 0 ), "Number of blocks to download, 0 up to the head block")
+         ("print,p", "Print the blocks as JSON")
+         ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line( argc, argv, options_description ), options );
+         bpo::notify( options );
+      }
+      catch( const boost::program_options::error& e )
+      {
+         std::cerr << "Error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count( "help" ) )
+      {
+         std::cout << options_description << "\n";
+         return 0;
+      }
+
+      app::binary_rpc_client client;
+      client.connect( fc::ip::endpoint::from_string( options["server"].as< std::string >() ) );
+
+      uint32_t start = options["start"].as< uint32_t >();
+      uint32_t count = options["count"].as< uint32_t >();
+      if( count == 0 )
+      {
+         uint32_t head = client.get_dynamic_global_properties().head_block_number;
+         count = head >= start ? head - start + 1 : 0;
+      }
+
+      bool print = options.count( "print" ) > 0;
+      uint64_t bytes_before = client.bytes_received();
+      fc::time_point begin = fc::time_point::now();
+      uint32_t received = client.get_blocks( start, count, [print]( const signed_block& block ) {
+         if( print )
+            std::cout << fc::json::to_string( block ) << "\n";
+      } );
+      fc::microseconds elapsed = fc::time_point::now() - begin;
+      uint64_t bytes = client.bytes_received() - bytes_before;
+
+      std::cerr << "blocks received: " << received << ", " << bytes << " bytes in " << elapsed.count() / 1000 << " ms\n";
+      if( elapsed.count() > 0 )
+         std::cerr << "bytes per second: " << bytes * 1000000 / elapsed.count()
+                   << ", blocks per second: " << uint64_t( received ) * 1000000 / elapsed.count() << "\n";
+      client.close();
+      return 0;
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
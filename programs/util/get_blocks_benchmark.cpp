@@ -0,0 +1,136 @@
+/**
+ *  Measures how long a client needs to fetch a range of blocks through database_api.
+ *
+ *  Blocks are replayed from the block log of an existing node into a fresh database, then the
+ *  whole range is fetched three ways: one get_block() call per block, get_blocks() batches and
+ *  get_block_range_raw() batches.  Every result is converted to JSON as the RPC layer would, so
+ *  the times include what a client waits for apart from the network.
+ */
+#include <muse/app/database_api.hpp>
+#include <muse/chain/block_database.hpp>
+#include <muse/chain/database.hpp>
+#include <muse/egenesis/egenesis.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+#include <fc/variant.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace muse;
+using namespace muse::chain;
+namespace bpo = boost::program_options;
+
+static void print_result( const char* label, uint32_t calls, uint64_t bytes, const fc::microseconds& elapsed, uint32_t blocks )
+{
+   std::cout << label << calls << " calls, " << bytes << " bytes in " << elapsed.count() / 1000 << " ms";
+   if( elapsed.count() > 0 )
+      std::cout << ", " << uint64_t( blocks ) * 1000000 / elapsed.count() << " blocks per second";
+   std::cout << "\n";
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description options_description( "Muse get_blocks benchmark" );
+      options_description.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("source-dir,s", bpo::value< boost::filesystem::path >(), "Data directory of a node whose blocks are replayed")
+         ("blocks,b", bpo::value< uint32_t >()->default_value( 10000 ), "Number of blocks to replay and fetch, 0 for all of them")
+         ("batch-size,n", bpo::value< uint32_t >()->default_value( 1000 ), "Blocks per get_blocks and get_block_range_raw call, at most 1000")
+         ("genesis-json", bpo::value< boost::filesystem::path >(), "Genesis of the source chain, the built in genesis by default")
+         ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line( argc, argv, options_description ), options );
+         bpo::notify( options );
+      }
+      catch( const boost::program_options::error& e )
+      {
+         std::cerr << "Error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count( "help" ) || !options.count( "source-dir" ) )
+      {
+         std::cout << options_description << "\n";
+         return options.count( "help" ) ? 0 : 1;
+      }
+
+      genesis_state_type genesis;
+      if( options.count( "genesis-json" ) )
+         genesis = fc::json::from_file( fc::path( options["genesis-json"].as< boost::filesystem::path >() ) ).as< genesis_state_type >( 20 );
+      else
+      {
+         std::string egenesis_json;
+         muse::egenesis::compute_egenesis_json( egenesis_json );
+         genesis = fc::json::from_string( egenesis_json ).as< genesis_state_type >( 20 );
+      }
+      genesis.initial_chain_id = MUSE_CHAIN_ID;
+
+      block_database source;
+      source.open( fc::path( options["source-dir"].as< boost::filesystem::path >() ) / "blockchain" / "database" / "block_num_to_block" );
+      optional< block_id_type > last_id = source.last_id();
+      FC_ASSERT( last_id.valid(), "The source block log is empty" );
+      uint32_t last_block = block_header::num_from_id( *last_id );
+      if( options["blocks"].as< uint32_t >() > 0 )
+         last_block = std::min( last_block, options["blocks"].as< uint32_t >() );
+      const uint32_t batch_size = options["batch-size"].as< uint32_t >();
+      FC_ASSERT( batch_size > 0 && batch_size <= 1000, "The batch size must be between 1 and 1000" );
+
+      fc::temp_directory data_dir;
+      database db;
+      db.open( data_dir.path(), genesis, "get_blocks_benchmark" );
+
+      const uint32_t skip = database::skip_witness_signature |
+                            database::skip_transaction_signatures |
+                            database::skip_transaction_dupe_check |
+                            database::skip_tapos_check |
+                            database::skip_authority_check |
+                            database::skip_validate_invariants;
+      for( uint32_t num = db.head_block_num() + 1; num <= last_block; ++num )
+      {
+         optional< signed_block > block = source.fetch_by_number( num );
+         FC_ASSERT( block.valid(), "Block ${n} is missing from the source block log", ("n",num) );
+         db.push_block( *block, skip );
+      }
+      const uint32_t blocks = db.head_block_num();
+      app::database_api api( db );
+
+      uint32_t calls = 0;
+      uint64_t bytes = 0;
+      fc::time_point start = fc::time_point::now();
+      for( uint32_t num = 1; num <= blocks; ++num, ++calls )
+         bytes += fc::json::to_string( fc::variant( api.get_block( num ) ) ).size();
+      print_result( "get_block:           ", calls, bytes, fc::time_point::now() - start, blocks );
+
+      calls = 0;
+      bytes = 0;
+      start = fc::time_point::now();
+      for( uint32_t num = 1; num <= blocks; num += batch_size, ++calls )
+         bytes += fc::json::to_string( fc::variant( api.get_blocks( num, batch_size ) ) ).size();
+      print_result( "get_blocks:          ", calls, bytes, fc::time_point::now() - start, blocks );
+
+      calls = 0;
+      bytes = 0;
+      start = fc::time_point::now();
+      for( uint32_t num = 1; num <= blocks; num += batch_size, ++calls )
+         bytes += fc::json::to_string( fc::variant( api.get_block_range_raw( num, batch_size ) ) ).size();
+      print_result( "get_block_range_raw: ", calls, bytes, fc::time_point::now() - start, blocks );
+
+      db.close();
+      return 0;
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
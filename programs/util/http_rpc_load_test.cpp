@@ -0,0 +1,176 @@
+/**
+ *  Measures the throughput of the HTTP JSON-RPC endpoint of a node (rpc-http-endpoint).
+ *
+ *  Every connection sends database_api read calls over one persistent connection, pipeline
+ *  requests at a time, and waits for their responses before sending the next ones.
+ */
+#include <fc/exception/exception.hpp>
+#include <fc/network/ip.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bpo = boost::program_options;
+
+static const char* const calls[] = {
+   "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"database_api.get_dynamic_global_properties\",\"params\":[]}",
+   "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"database_api.get_block\",\"params\":[1]}",
+   "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"database_api.lookup_accounts\",\"params\":[\"\",100]}",
+   "{\"jsonrpc\":\"2.0\",\"id\":4,\"method\":\"call\",\"params\":[\"database_api\",\"get_account_count\",[]]}",
+};
+
+struct connection_result
+{
+   uint64_t                requests = 0;
+   uint64_t                failures = 0;
+   uint64_t                bytes    = 0;
+   std::vector< int64_t >  latencies_us;
+};
+
+static std::string read_line( fc::tcp_socket& socket )
+{
+   std::string line;
+   char ch = 0;
+   while( true )
+   {
+      socket.read( &ch, 1 );
+      if( ch == '\n' )
+         break;
+      if( ch != '\r' )
+         line.push_back( ch );
+   }
+   return line;
+}
+
+/** reads one response and returns whether its status was 200 */
+static bool read_response( fc::tcp_socket& socket, connection_result& result )
+{
+   std::string status = read_line( socket );
+   size_t length = 0;
+   for( std::string line = read_line( socket ); !line.empty(); line = read_line( socket ) )
+   {
+      auto colon = line.find( ':' );
+      if( colon != std::string::npos && boost::algorithm::iequals( line.substr( 0, colon ), "content-length" ) )
+         length = boost::lexical_cast< size_t >( boost::algorithm::trim_copy( line.substr( colon + 1 ) ) );
+   }
+   std::vector< char > body( length );
+   if( length > 0 )
+      socket.read( body.data(), length );
+   result.bytes += status.size() + length;
+   return status.find( " 200 " ) != std::string::npos &&
+          std::string( body.begin(), body.end() ).find( "\"error\"" ) == std::string::npos;
+}
+
+static void run_connection( const fc::ip::endpoint& server, uint32_t pipeline, fc::time_point end, connection_result& result )
+{
+   fc::tcp_socket socket;
+   socket.connect_to( server );
+   uint32_t next_call = 0;
+   while( fc::time_point::now() < end )
+   {
+      std::string requests;
+      for( uint32_t i = 0; i < pipeline; ++i )
+      {
+         const std::string body = calls[ next_call++ % ( sizeof( calls ) / sizeof( calls[0] ) ) ];
+         requests += "POST / HTTP/1.1\r\nHost: muse\r\nContent-Type: application/json\r\nContent-Length: "
+                     + std::to_string( body.size() ) + "\r\n\r\n" + body;
+      }
+      fc::time_point start = fc::time_point::now();
+      socket.write( requests.data(), requests.size() );
+      socket.flush();
+      for( uint32_t i = 0; i < pipeline; ++i )
+      {
+         if( !read_response( socket, result ) )
+            ++result.failures;
+         ++result.requests;
+         result.latencies_us.push_back( ( fc::time_point::now() - start ).count() );
+      }
+   }
+   socket.close();
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description options_description( "Muse HTTP JSON-RPC load test" );
+      options_description.add_options()
+         ("help,h", "Print this help message and exit.")
+         ("server,s", bpo::value< std::string >()->default_value( "127.0.0.1:8092" ), "HTTP RPC endpoint of the node")
+         ("connections,c", bpo::value< uint32_t >()->default_value( 16 ), "Number of persistent connections")
+         ("pipeline,p", bpo::value< uint32_t >()->default_value( 4 ), "Requests each connection sends before reading the responses")
+         ("seconds,t", bpo::value< uint32_t >()->default_value( 10 ), "Duration of the test")
+         ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line( argc, argv, options_description ), options );
+         bpo::notify( options );
+      }
+      catch( const boost::program_options::error& e )
+      {
+         std::cerr << "Error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count( "help" ) )
+      {
+         std::cout << options_description << "\n";
+         return 0;
+      }
+
+      fc::ip::endpoint server = fc::ip::endpoint::from_string( options["server"].as< std::string >() );
+      uint32_t connection_count = options["connections"].as< uint32_t >();
+      uint32_t pipeline = std::max< uint32_t >( 1, options["pipeline"].as< uint32_t >() );
+      fc::time_point begin = fc::time_point::now();
+      fc::time_point end = begin + fc::seconds( options["seconds"].as< uint32_t >() );
+
+      std::vector< connection_result > results( connection_count );
+      std::vector< fc::future< void > > connections;
+      for( uint32_t i = 0; i < connection_count; ++i )
+         connections.push_back( fc::async( [&, i]() { run_connection( server, pipeline, end, results[i] ); }, "http_client" ) );
+      for( fc::future< void >& c : connections )
+         c.wait();
+      fc::microseconds elapsed = fc::time_point::now() - begin;
+
+      connection_result total;
+      for( const connection_result& r : results )
+      {
+         total.requests += r.requests;
+         total.failures += r.failures;
+         total.bytes += r.bytes;
+         total.latencies_us.insert( total.latencies_us.end(), r.latencies_us.begin(), r.latencies_us.end() );
+      }
+      std::sort( total.latencies_us.begin(), total.latencies_us.end() );
+
+      std::cout << "connections: " << connection_count << ", pipeline: " << pipeline << "\n";
+      std::cout << "requests:    " << total.requests << " (" << total.failures << " failed), "
+                << total.bytes << " response bytes\n";
+      if( elapsed.count() > 0 )
+         std::cout << "requests per second: " << total.requests * 1000000 / elapsed.count() << "\n";
+      if( !total.latencies_us.empty() )
+      {
+         auto percentile = [&total]( uint32_t p ) {
+            return total.latencies_us[ std::min< size_t >( total.latencies_us.size() - 1, total.latencies_us.size() * p / 100 ) ];
+         };
+         std::cout << "latency: p50 " << percentile( 50 ) << " us, p99 " << percentile( 99 ) << " us, max "
+                   << total.latencies_us.back() << " us\n";
+      }
+      return 0;
+   }
+   catch( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+   }
+   return 1;
+}
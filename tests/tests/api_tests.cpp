@@ -25,6 +25,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <muse/app/database_api.hpp>
+#include <muse/app/transaction_confirmation_tracker.hpp>
+#include <muse/app/api_admission_control.hpp>
+#include <muse/app/api_read_thread_pool.hpp>
+#include <muse/app/response_cache.hpp>
 #include <muse/chain/protocol/operations.hpp>
 
 #include "../common/database_fixture.hpp"
@@ -448,4 +452,487 @@ BOOST_AUTO_TEST_CASE( get_accounts_test )
    }
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( subscribe_to_changes_test )
+{ try {
+   ACTORS( (alice)(brenda)(charlene) );
+   fund( "alice" );
+   generate_block();
+   fc::yield();
+
+   muse::app::database_api by_name( db );
+   muse::app::database_api by_id( db );
+   vector< fc::variants > name_batches;
+   vector< fc::variants > id_batches;
+   by_name.set_subscribe_callback( [&name_batches]( const fc::variant& v ) { name_batches.push_back( v.get_array() ); }, true );
+   by_id.set_subscribe_callback( [&id_batches]( const fc::variant& v ) { id_batches.push_back( v.get_array() ); }, true );
+
+   muse::app::subscription_interests interests;
+   interests.accounts.push_back( "alice" );
+   by_name.subscribe_to_changes( interests );
+   interests.accounts.clear();
+   interests.objects.push_back( brenda_id );
+   by_id.subscribe_to_changes( interests );
+
+   transfer( "alice", "brenda", 1000 );
+   transfer( "alice", "charlene", 1000 );
+   generate_block();
+   fc::yield();
+
+   // everything changed while pushing is delivered in one batch per session
+   BOOST_REQUIRE_EQUAL( 1, name_batches.size() );
+   BOOST_REQUIRE_EQUAL( 1, name_batches[0].size() );
+   BOOST_CHECK_EQUAL( "alice", name_batches[0][0]["name"].as_string() );
+   BOOST_REQUIRE_EQUAL( 1, id_batches.size() );
+   BOOST_REQUIRE_EQUAL( 1, id_batches[0].size() );
+   BOOST_CHECK_EQUAL( "brenda", id_batches[0][0]["name"].as_string() );
+
+   by_id.cancel_all_subscriptions();
+   transfer( "charlene", "brenda", 500 );
+   generate_block();
+   fc::yield();
+   BOOST_CHECK_EQUAL( 1, id_batches.size() );
+   BOOST_CHECK_EQUAL( 1, name_batches.size() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( subscription_session_removed_by_callback_test )
+{ try {
+   ACTORS( (alice)(brenda) );
+   fund( "alice" );
+   generate_block();
+   fc::yield();
+
+   muse::app::subscription_manager manager( db );
+   muse::app::subscription_manager::session_id first = 0;
+   muse::app::subscription_manager::session_id second = 0;
+   uint32_t first_calls = 0;
+   uint32_t second_calls = 0;
+   // each callback removes both sessions, whichever runs first must not touch the other's entry
+   auto remove_both = [&]() {
+      fc::yield();
+      manager.remove_session( first );
+      manager.remove_session( second );
+   };
+   first = manager.add_session( [&]( const fc::variant& ) { ++first_calls; remove_both(); } );
+   second = manager.add_session( [&]( const fc::variant& ) { ++second_calls; remove_both(); } );
+   muse::app::subscription_interests interests;
+   interests.accounts.push_back( "alice" );
+   manager.subscribe( first, interests );
+   manager.subscribe( second, interests );
+
+   transfer( "alice", "brenda", 1000 );
+   generate_block();
+   fc::yield();
+   fc::yield();
+
+   BOOST_CHECK_EQUAL( 1, first_calls + second_calls );
+   BOOST_CHECK_EQUAL( 0, manager.session_count() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( subscription_many_sessions_test )
+{ try {
+   ACTORS( (alice)(brenda) );
+   fund( "alice" );
+   generate_block();
+   fc::yield();
+
+   const uint32_t session_count = 10000;
+   muse::app::subscription_manager manager( db );
+   uint32_t notified = 0;
+   muse::app::subscription_interests interests;
+   interests.accounts.push_back( "alice" );
+   interests.objects.push_back( brenda_id );
+   for( uint32_t i = 0; i < session_count; ++i )
+   {
+      auto session = manager.add_session( [&notified]( const fc::variant& v ) {
+         if( v.get_array().size() == 2 )
+            ++notified;
+      } );
+      manager.subscribe( session, interests );
+   }
+
+   transfer( "alice", "brenda", 1000 );
+   const fc::time_point start = fc::time_point::now();
+   generate_block();
+   fc::yield();
+   const fc::microseconds elapsed = fc::time_point::now() - start;
+
+   BOOST_CHECK_EQUAL( session_count, notified );
+   BOOST_TEST_MESSAGE( "--- Block with notifications for " << session_count << " sessions took " << elapsed.count() << " us" );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( get_blocks_test )
+{ try {
+   muse::app::database_api db_api( db );
+   generate_blocks( 5 );
+   const uint32_t head = db.head_block_num();
+
+   vector< signed_block > blocks = db_api.get_blocks( 2, 1000 );
+   BOOST_REQUIRE_EQUAL( head - 1, blocks.size() );
+   vector< vector< char > > raw = db_api.get_block_range_raw( 2, 3 );
+   BOOST_REQUIRE_EQUAL( 3, raw.size() );
+   for( uint32_t i = 0; i < blocks.size(); ++i )
+   {
+      BOOST_CHECK_EQUAL( 2 + i, blocks[i].block_num() );
+      BOOST_CHECK( blocks[i].id() == db.fetch_block_by_number( 2 + i )->id() );
+      if( i < raw.size() )
+         BOOST_CHECK( fc::raw::unpack_from_vector< signed_block >( raw[i] ).id() == blocks[i].id() );
+   }
+
+   BOOST_CHECK_EQUAL( 0, db_api.get_blocks( head + 1, 10 ).size() );
+   MUSE_REQUIRE_THROW( db_api.get_blocks( 1, 1001 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( transaction_confirmation_tracker_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( "alice" );
+   generate_block();
+   fc::yield();
+
+   muse::app::transaction_confirmation_tracker tracker( db );
+   vector< fc::variant > confirmations;
+   auto record = [&confirmations]( const fc::variant& v ) { confirmations.push_back( v ); };
+
+   // transactions that are never included wait until they expire
+   const uint32_t outstanding = 50000;
+   signed_transaction never;
+   never.operations.push_back( transfer_operation() );
+   never.set_expiration( db.head_block_time() + fc::seconds( 60 ) );
+   for( uint32_t i = 0; i < outstanding; ++i )
+   {
+      never.ref_block_prefix = i;
+      tracker.watch( never, record );
+   }
+
+   transfer_operation op;
+   op.from = "alice";
+   op.to = "bob";
+   op.amount = asset( 1000, MUSE_SYMBOL );
+   signed_transaction tx;
+   tx.operations.push_back( op );
+   tx.set_expiration( db.head_block_time() + MUSE_MAX_TIME_UNTIL_EXPIRATION );
+   tracker.watch( tx, record );
+   tracker.watch( tx, record );
+   db.push_transaction( tx, ~0 );
+   generate_block();
+   fc::yield();
+
+   BOOST_REQUIRE_EQUAL( 2, confirmations.size() );
+   for( const fc::variant& confirmation : confirmations )
+   {
+      BOOST_CHECK( confirmation["id"].as< transaction_id_type >() == tx.id() );
+      BOOST_CHECK_EQUAL( db.head_block_num(), confirmation["block_num"].as_uint64() );
+      BOOST_CHECK_EQUAL( 0, confirmation["trx_num"].as_int64() );
+      BOOST_CHECK( !confirmation["expired"].as_bool() );
+   }
+   BOOST_CHECK_EQUAL( outstanding, tracker.waiting_count() );
+
+   generate_blocks( db.head_block_time() + fc::seconds( 61 ) );
+   fc::yield();
+   BOOST_CHECK_EQUAL( 0, tracker.waiting_count() );
+   BOOST_REQUIRE_EQUAL( 2 + outstanding, confirmations.size() );
+   BOOST_CHECK( confirmations.back()["expired"].as_bool() );
+   BOOST_CHECK_EQUAL( -1, confirmations.back()["trx_num"].as_int64() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( api_admission_control_test )
+{ try {
+   using muse::app::api_admission_control;
+   api_admission_control::config cfg;
+   cfg.tokens_per_second = 1;
+   cfg.burst = 10;
+   cfg.max_in_flight = 2;
+   cfg.costs["get_order_book"] = 4;
+   api_admission_control control( db, cfg );
+   auto budget = control.open_connection();
+
+   // the bucket starts full and does not refill noticeably during the test
+   {
+      api_admission_control::call_guard first( &control, "get_order_book", budget.get() );
+      api_admission_control::call_guard second( &control, "get_accounts", budget.get() );
+      // two calls are in flight already
+      BOOST_CHECK_THROW( api_admission_control::call_guard( &control, "get_accounts", budget.get() ), fc::exception );
+      first.succeeded();
+      second.succeeded();
+   }
+   {
+      api_admission_control::call_guard call( &control, "get_order_book", budget.get() );
+      call.succeeded();
+   }
+   BOOST_CHECK_THROW( api_admission_control::call_guard( &control, "get_order_book", budget.get() ), fc::exception );
+   // a call that does not get to succeeded() failed, even without an exception in flight
+   { api_admission_control::call_guard call( &control, "get_accounts", nullptr ); }
+
+   muse::app::api_admission_stats stats = control.get_stats();
+   BOOST_CHECK_EQUAL( 0, stats.in_flight );
+   BOOST_REQUIRE_EQUAL( 2, stats.methods.size() );
+   BOOST_CHECK_EQUAL( "get_accounts", stats.methods[0].method );
+   BOOST_CHECK_EQUAL( 2, stats.methods[0].calls );
+   BOOST_CHECK_EQUAL( 1, stats.methods[0].rejected );
+   BOOST_CHECK_EQUAL( 1, stats.methods[0].failed );
+   BOOST_CHECK_EQUAL( "get_order_book", stats.methods[1].method );
+   BOOST_CHECK_EQUAL( 4, stats.methods[1].cost );
+   BOOST_CHECK_EQUAL( 2, stats.methods[1].calls );
+   BOOST_CHECK_EQUAL( 1, stats.methods[1].rejected );
+   uint64_t histogram_calls = 0;
+   for( uint64_t n : stats.methods[1].latency_histogram )
+      histogram_calls += n;
+   BOOST_CHECK_EQUAL( 2, histogram_calls );
+   BOOST_CHECK_EQUAL( 0, stats.methods[1].failed );
+
+   // the cost grows with the requested size, up to the burst
+   cfg.max_in_flight = 0;
+   cfg.burst = 50;
+   cfg.cost_unit_size = 10;
+   api_admission_control scaled( db, cfg );
+   budget = scaled.open_connection();
+   { api_admission_control::call_guard call( &scaled, "get_order_book", budget.get(), 10 ); }
+   BOOST_CHECK_EQUAL( 46, int64_t( budget->tokens ) );
+   { api_admission_control::call_guard call( &scaled, "get_order_book", budget.get(), 11 ); }
+   BOOST_CHECK_EQUAL( 38, int64_t( budget->tokens ) );
+   { api_admission_control::call_guard call( &scaled, "get_accounts", budget.get(), 0 ); }
+   BOOST_CHECK_EQUAL( 37, int64_t( budget->tokens ) );
+   BOOST_CHECK_THROW( api_admission_control::call_guard( &scaled, "get_order_book", budget.get(), 1000 ), fc::exception );
+   budget = scaled.open_connection();
+   { api_admission_control::call_guard call( &scaled, "get_order_book", budget.get(), 1000 ); }
+   BOOST_CHECK_EQUAL( 0, int64_t( budget->tokens ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( list_account_history_test )
+{ try {
+   muse::app::database_api db_api( db );
+
+   ACTORS( (alice)(bob) );
+   fund( "alice" );
+   for( int i = 0; i < 5; ++i )
+      transfer( "alice", "bob", 10 );
+   generate_block();
+
+   map< uint32_t, operation_object > full = db_api.get_account_history( "alice", uint64_t(-1), 100 );
+   BOOST_REQUIRE_LT( 3, full.size() );
+
+   vector< uint32_t > paged;
+   string cursor;
+   do
+   {
+      muse::app::account_history_page page = db_api.list_account_history( "alice", cursor, 3 );
+      BOOST_REQUIRE_GE( 3, page.items.size() );
+      BOOST_REQUIRE( !page.items.empty() );
+      for( const auto& item : page.items )
+         paged.push_back( item.first );
+      cursor = page.next_cursor;
+   } while( !cursor.empty() );
+
+   // newest first, every operation exactly once
+   BOOST_REQUIRE_EQUAL( full.size(), paged.size() );
+   auto fitr = full.rbegin();
+   for( uint32_t seq : paged )
+      BOOST_CHECK_EQUAL( (fitr++)->first, seq );
+
+   muse::app::account_history_page page = db_api.list_account_history( "alice", string(), full.size() );
+   BOOST_CHECK_EQUAL( full.size(), page.items.size() );
+   BOOST_CHECK( page.next_cursor.empty() );
+
+   page = db_api.list_account_history( "nobody", string(), 10 );
+   BOOST_CHECK( page.items.empty() );
+   BOOST_CHECK( page.next_cursor.empty() );
+
+   BOOST_CHECK_THROW( db_api.list_account_history( "alice", "xyz", 10 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( list_proposed_transactions_test )
+{ try {
+   muse::app::database_api db_api( db );
+
+   ACTORS( (alice)(brenda)(charlene) );
+   fund( "alice" );
+   generate_block();
+   trx.clear();
+   trx.set_expiration( db.head_block_time() + MUSE_MAX_TIME_UNTIL_EXPIRATION );
+
+   vector< proposal_id_type > alice_proposals;
+   for( int i = 0; i < 5; ++i )
+   {
+      transfer_operation top;
+      top.from = "alice";
+      top.to   = "brenda";
+      top.amount = asset( 100 + i, MUSE_SYMBOL );
+
+      proposal_create_operation pco;
+      pco.proposed_ops.emplace_back( top );
+      pco.expiration_time = db.head_block_time() + fc::days(1);
+      trx.operations.push_back( pco );
+      PUSH_TX( db, trx );
+      trx.clear();
+      alice_proposals.push_back( db.get_index_type<proposal_index>().indices().get<by_id>().rbegin()->id );
+   }
+
+   proposal_id_type basic_pid;
+   { // needs basic authority of brenda and charlene only
+      friendship_operation fop;
+      fop.who  = "brenda";
+      fop.whom = "charlene";
+
+      proposal_create_operation pco;
+      pco.proposed_ops.emplace_back( fop );
+      pco.expiration_time = db.head_block_time() + fc::days(1);
+      trx.operations.push_back( pco );
+      PUSH_TX( db, trx );
+      trx.clear();
+      basic_pid = db.get_index_type<proposal_index>().indices().get<by_id>().rbegin()->id;
+   }
+   generate_block();
+
+   vector< proposal_id_type > paged;
+   string cursor;
+   do
+   {
+      muse::app::proposal_page page = db_api.list_proposed_transactions( "alice", cursor, 2 );
+      BOOST_REQUIRE_GE( 2, page.items.size() );
+      for( const auto& p : page.items )
+         paged.push_back( p.id );
+      cursor = page.next_cursor;
+   } while( !cursor.empty() );
+   BOOST_CHECK( alice_proposals == paged );
+   BOOST_CHECK_EQUAL( alice_proposals.size(), db_api.get_proposed_transactions( "alice" ).size() );
+
+   // basic authority alone does not make a proposal relevant to the proposal calls,
+   // get_accounts lists it
+   BOOST_CHECK( db_api.get_proposed_transactions( "brenda" ).empty() );
+   muse::app::proposal_page page = db_api.list_proposed_transactions( "brenda", string(), 10 );
+   BOOST_CHECK( page.items.empty() );
+   BOOST_CHECK( page.next_cursor.empty() );
+   vector< muse::app::extended_account > accounts = db_api.get_accounts( { "brenda" } );
+   BOOST_REQUIRE_EQUAL( 1, accounts[0].proposals.size() );
+   BOOST_CHECK( basic_pid == accounts[0].proposals[0].id );
+
+   // a removed proposal that is restored by undo is found again
+   {
+      auto session = db._undo_db.start_undo_session();
+      db.remove( db.get< proposal_object >( alice_proposals[2] ) );
+      BOOST_CHECK_EQUAL( alice_proposals.size() - 1, db_api.get_proposed_transactions( "alice" ).size() );
+      db.remove( db.get< proposal_object >( basic_pid ) );
+      BOOST_CHECK( db_api.get_accounts( { "brenda" } )[0].proposals.empty() );
+      session.undo();
+   }
+   BOOST_CHECK_EQUAL( alice_proposals.size(), db_api.get_proposed_transactions( "alice" ).size() );
+   page = db_api.list_proposed_transactions( "alice", string(), 10 );
+   BOOST_REQUIRE_EQUAL( alice_proposals.size(), page.items.size() );
+   BOOST_CHECK( alice_proposals[2] == page.items[2].id );
+   BOOST_CHECK_EQUAL( 1, db_api.get_accounts( { "brenda" } )[0].proposals.size() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( api_read_thread_pool_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( "alice" );
+   generate_block();
+   const share_type total = db.get_account( "alice" ).balance.amount + db.get_account( "bob" ).balance.amount;
+
+   muse::app::api_read_thread_pool pool( db, 2 );
+   std::atomic< bool > stop( false );
+   std::atomic< uint32_t > reads( 0 );
+   std::atomic< uint32_t > inconsistent( 0 );
+   std::vector< std::unique_ptr< fc::thread > > callers;
+   std::vector< fc::future< void > > loops;
+   for( int i = 0; i < 3; ++i )
+   {
+      callers.emplace_back( new fc::thread( "api_caller_" + std::to_string( i ) ) );
+      loops.push_back( callers.back()->async( [&]() {
+         while( !stop )
+         {
+            // a transfer moves balance between the two, a read never sees it half done
+            bool consistent = pool.run( [&]() -> bool {
+               share_type sum = db.get_account( "alice" ).balance.amount + db.get_account( "bob" ).balance.amount;
+               return sum == total && db.head_block_num() == block_header::num_from_id( db.head_block_id() );
+            } );
+            if( !consistent )
+               ++inconsistent;
+            ++reads;
+         }
+      }, "read_loop" ) );
+   }
+
+   const uint32_t start_block = db.head_block_num();
+   for( int i = 0; i < 30; ++i )
+   {
+      transfer( "alice", "bob", 1 );
+      generate_block();
+      if( i % 3 == 2 )
+         db.pop_block();
+   }
+   while( reads < 100 )
+      fc::usleep( fc::milliseconds( 1 ) );
+   stop = true;
+   for( auto& loop : loops )
+      loop.wait();
+
+   BOOST_CHECK_EQUAL( 0, inconsistent );
+   BOOST_CHECK_EQUAL( total.value, db.get_account( "alice" ).balance.amount.value + db.get_account( "bob" ).balance.amount.value );
+   // every third block is popped again
+   BOOST_CHECK_EQUAL( start_block + 20, db.head_block_num() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( response_cache_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( "alice" );
+   generate_block();
+
+   muse::app::response_cache cache( db, 3 );
+   uint32_t computed = 0;
+   auto state = [&]( const std::string& params ) {
+      return cache.get< int64_t >( "balance", params, false, [&]() {
+         ++computed;
+         return db.get_account( "alice" ).balance.amount.value;
+      } );
+   };
+   auto block = [&]( uint32_t num ) {
+      return cache.get< uint32_t >( "block", std::to_string( num ), true, [&]() {
+         ++computed;
+         return num;
+      } );
+   };
+
+   const int64_t balance = state( "" );
+   BOOST_CHECK_EQUAL( balance, state( "" ) );
+   block( 1 );
+   block( 1 );
+   BOOST_CHECK_EQUAL( 2, computed );
+
+   // pending transactions do not invalidate
+   transfer( "alice", "bob", 1 );
+   BOOST_CHECK_EQUAL( balance, state( "" ) );
+   BOOST_CHECK_EQUAL( 2, computed );
+
+   // a new block drops the state results, not the immutable ones
+   generate_block();
+   BOOST_CHECK_EQUAL( balance - 1, state( "" ) );
+   block( 1 );
+   BOOST_CHECK_EQUAL( 3, computed );
+
+   // so does popping a block
+   db.pop_block();
+   db.clear_pending();
+   BOOST_CHECK_EQUAL( balance, state( "" ) );
+   block( 1 );
+   BOOST_CHECK_EQUAL( 4, computed );
+
+   // when full the least recently used result is evicted
+   state( "a" );
+   block( 1 );
+   block( 2 );
+   BOOST_CHECK_EQUAL( 6, computed );
+   block( 1 );
+   state( "" );
+   BOOST_CHECK_EQUAL( 7, computed );
+   block( 1 );
+   BOOST_CHECK_EQUAL( 7, computed );
+
+   muse::app::response_cache_stats stats = cache.get_stats();
+   BOOST_CHECK_EQUAL( 3, stats.entries );
+   BOOST_CHECK_EQUAL( 2, stats.invalidations );
+   BOOST_CHECK_EQUAL( 2, stats.evictions );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1419,4 +1419,47 @@ BOOST_AUTO_TEST_CASE( basic_authority )
    BOOST_CHECK_EQUAL( 0, pidx.size() );
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( authority_cache )
+{ try {
+   ACTORS( (nathan) );
+   fund( "nathan" );
+   generate_block();
+
+   transfer_operation op;
+   op.from = "nathan";
+   op.to = MUSE_INIT_MINER_NAME;
+   op.amount = asset( 1, MUSE_SYMBOL );
+   trx.operations.push_back( op );
+   sign( trx, nathan_private_key );
+   PUSH_TX( db, trx, database::skip_transaction_dupe_check );
+
+   BOOST_TEST_MESSAGE( "Verifying the same authority again is served from the cache" );
+   uint64_t hits = db.get_authority_cache().hits();
+   uint64_t misses = db.get_authority_cache().misses();
+   PUSH_TX( db, trx, database::skip_transaction_dupe_check );
+   BOOST_CHECK_GT( db.get_authority_cache().hits(), hits );
+   BOOST_CHECK_EQUAL( db.get_authority_cache().misses(), misses );
+   trx.clear();
+
+   BOOST_TEST_MESSAGE( "Popping the block that created an account drops it from the cache" );
+   generate_block();
+   PREP_ACTOR( dave );
+   account_create( "dave", dave_public_key, dave_post_key.get_public_key() );
+   fund( "dave" );
+   generate_block();
+
+   op.from = "dave";
+   trx.operations.push_back( op );
+   sign( trx, dave_private_key );
+   PUSH_TX( db, trx, database::skip_transaction_dupe_check );
+
+   db.pop_block();
+   const auto& by_name_idx = db.get_index_type< account_index >().indices().get< by_name >();
+   BOOST_REQUIRE( by_name_idx.find( "dave" ) == by_name_idx.end() );
+
+   misses = db.get_authority_cache().misses();
+   MUSE_CHECK_THROW( PUSH_TX( db, trx, database::skip_transaction_dupe_check ), fc::exception );
+   BOOST_CHECK_GT( db.get_authority_cache().misses(), misses );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -422,6 +422,243 @@ BOOST_AUTO_TEST_CASE( duplicate_transactions )
    }
 }
 
+BOOST_AUTO_TEST_CASE( prevalidated_block )
+{
+   try {
+      fc::temp_directory dir1( graphene::utilities::temp_directory_path() ),
+                         dir2( graphene::utilities::temp_directory_path() );
+
+      genesis_state_type genesis;
+      genesis.init_supply = INITIAL_TEST_SUPPLY;
+
+      database db1,
+               db2;
+      db1.open(dir1.path(), genesis, "TEST" );
+      init_witness_keys( db1 );
+      db2.open(dir2.path(), genesis, "TEST" );
+      init_witness_keys( db2 );
+
+      signed_transaction trx;
+      account_create_operation cop;
+      cop.new_account_name = "alice";
+      cop.creator = MUSE_INIT_MINER_NAME;
+      cop.owner = authority(1, init_account_pub_key(), 1);
+      cop.active = cop.owner;
+      trx.operations.push_back(cop);
+      transfer_operation t;
+      t.from = MUSE_INIT_MINER_NAME;
+      t.to = "alice";
+      t.amount = asset(500,MUSE_SYMBOL);
+      trx.operations.push_back(t);
+      trx.set_expiration( db1.head_block_time() + MUSE_MAX_TIME_UNTIL_EXPIRATION );
+      trx.sign( init_account_priv_key(), db1.get_chain_id() );
+      PUSH_TX( db1, trx );
+
+      auto b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key(), database::skip_nothing );
+
+      prevalidated_block pre = prevalidate_block( b, db2.get_chain_id(), true );
+      BOOST_CHECK( pre.block_id == b.id() );
+      BOOST_CHECK( pre.transaction_merkle_root == b.transaction_merkle_root );
+      BOOST_REQUIRE( pre.signee.valid() );
+      BOOST_CHECK( *pre.signee == public_key_type( init_account_pub_key() ) );
+      BOOST_CHECK( pre.transactions_valid );
+      BOOST_REQUIRE_EQUAL( pre.signature_keys.size(), 1u );
+      BOOST_CHECK( pre.signature_keys[0] == trx.get_signature_keys( db2.get_chain_id() ) );
+
+      // results for another block are ignored
+      prevalidated_block other;
+      other.signee = public_key_type( fc::ecc::private_key::regenerate( fc::sha256::hash( std::string( "other" ) ) ).get_public_key() );
+      other.signature_keys.resize( 1 );
+      db2.push_block( b, database::skip_nothing, &other );
+      BOOST_CHECK( db2.head_block_id() == b.id() );
+      db2.pop_block();
+
+      // the id only covers the header, the results must not be used for other transactions
+      signed_block forged = b;
+      forged.transactions.front().operations.back().get< transfer_operation >().amount = asset( 5000, MUSE_SYMBOL );
+      BOOST_CHECK( forged.id() == b.id() );
+      MUSE_CHECK_THROW( db2.push_block( forged, database::skip_nothing, &pre ), fc::exception );
+      MUSE_CHECK_THROW( db2.push_block( forged, database::skip_merkle_check, &pre ), fc::exception );
+      BOOST_CHECK_EQUAL( db2.head_block_num(), 0u );
+
+      db2.push_block( b, database::skip_nothing, &pre );
+      BOOST_CHECK( db2.head_block_id() == b.id() );
+      BOOST_CHECK_EQUAL( db2.get_balance( "alice", MUSE_SYMBOL ).amount.value, 500 );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( state_delta_replica )
+{
+   try {
+      fc::temp_directory dir1( graphene::utilities::temp_directory_path() ),
+                         dir2( graphene::utilities::temp_directory_path() ),
+                         dir3( graphene::utilities::temp_directory_path() );
+
+      genesis_state_type genesis;
+      genesis.init_supply = INITIAL_TEST_SUPPLY;
+
+      // db1 produces the blocks, db2 validates them and db3 only applies their state deltas
+      database db1,
+               db2,
+               db3;
+      db1.open( dir1.path(), genesis, "TEST" );
+      init_witness_keys( db1 );
+      db2.open( dir2.path(), genesis, "TEST" );
+      init_witness_keys( db2 );
+      db3.open( dir3.path(), genesis, "TEST" );
+      init_witness_keys( db3 );
+
+      vector< vector<char> > deltas;
+      db1.applied_state_delta.connect( [&deltas]( const state_delta& delta ) {
+         deltas.push_back( fc::raw::pack_to_vector( delta ) );
+      } );
+
+      const vector<string> names = { "alice", "bob", "carol", "dave", "eve", "frank" };
+      for( uint32_t i = 0; i < 30; ++i )
+      {
+         if( i % 5 == 0 )
+         {
+            signed_transaction trx;
+            account_create_operation cop;
+            cop.new_account_name = names[ i / 5 ];
+            cop.creator = MUSE_INIT_MINER_NAME;
+            cop.owner = authority(1, init_account_pub_key(), 1);
+            cop.active = cop.owner;
+            trx.operations.push_back(cop);
+            transfer_operation t;
+            t.from = MUSE_INIT_MINER_NAME;
+            t.to = cop.new_account_name;
+            t.amount = asset(500,MUSE_SYMBOL);
+            trx.operations.push_back(t);
+            // expires within the test, so that the transaction object is removed again
+            trx.set_expiration( db1.head_block_time() + fc::seconds( 30 ) );
+            trx.sign( init_account_priv_key(), db1.get_chain_id() );
+            PUSH_TX( db1, trx );
+         }
+         auto b = db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key(), database::skip_nothing );
+         PUSH_BLOCK( db2, b );
+      }
+      BOOST_REQUIRE_EQUAL( deltas.size(), 30u );
+
+      bool removed = false;
+      for( const vector<char>& packed : deltas )
+      {
+         state_delta delta;
+         fc::datastream<const char*> ds( packed.data(), packed.size() );
+         fc::raw::unpack( ds, delta );
+         removed = removed || !delta.removed.empty();
+         db3.apply_state_delta( delta );
+      }
+      BOOST_CHECK( removed );
+
+      BOOST_CHECK( db3.head_block_id() == db2.head_block_id() );
+      BOOST_CHECK( db3.fetch_block_by_number( 10 )->id() == db2.fetch_block_by_number( 10 )->id() );
+      BOOST_CHECK_EQUAL( db3.get_balance( "eve", MUSE_SYMBOL ).amount.value, 500 );
+      uint32_t compared = 0;
+      for( uint32_t space = 0; space < 256; ++space )
+      {
+         for( uint32_t type = 0; type < 256; ++type )
+         {
+            const graphene::db::index* validated = db2.find_index( space, type );
+            const graphene::db::index* replicated = db3.find_index( space, type );
+            BOOST_REQUIRE( ( validated == nullptr ) == ( replicated == nullptr ) );
+            if( validated == nullptr )
+               continue;
+            BOOST_CHECK_MESSAGE( validated->hash() == replicated->hash(), "index " << space << "." << type << " differs" );
+            BOOST_CHECK( validated->get_next_id() == replicated->get_next_id() );
+            ++compared;
+         }
+      }
+      BOOST_CHECK( compared > 0 );
+
+      // a delta that does not build on the head block is refused
+      state_delta first;
+      fc::datastream<const char*> ds( deltas.front().data(), deltas.front().size() );
+      fc::raw::unpack( ds, first );
+      MUSE_CHECK_THROW( db3.apply_state_delta( first ), fc::exception );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( state_delta_unique_key_swap )
+{
+   try {
+      fc::temp_directory dir1( graphene::utilities::temp_directory_path() ),
+                         dir2( graphene::utilities::temp_directory_path() );
+
+      genesis_state_type genesis;
+      genesis.init_supply = INITIAL_TEST_SUPPLY;
+
+      database db1,
+               db2;
+      db1.open( dir1.path(), genesis, "TEST" );
+      init_witness_keys( db1 );
+      db2.open( dir2.path(), genesis, "TEST" );
+      init_witness_keys( db2 );
+
+      vector< state_delta > deltas;
+      db1.applied_state_delta.connect( [&deltas]( const state_delta& delta ) {
+         deltas.push_back( delta );
+      } );
+
+      signed_transaction trx;
+      for( const string& name : { "alice", "bob" } )
+      {
+         account_create_operation cop;
+         cop.new_account_name = name;
+         cop.creator = MUSE_INIT_MINER_NAME;
+         cop.owner = authority(1, init_account_pub_key(), 1);
+         cop.active = cop.owner;
+         trx.operations.push_back(cop);
+      }
+      trx.set_expiration( db1.head_block_time() + MUSE_MAX_TIME_UNTIL_EXPIRATION );
+      trx.sign( init_account_priv_key(), db1.get_chain_id() );
+      PUSH_TX( db1, trx );
+      db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key(), database::skip_nothing );
+      db1.generate_block( db1.get_slot_time(1), db1.get_scheduled_witness( 1 ), init_account_priv_key(), database::skip_nothing );
+      BOOST_REQUIRE_EQUAL( deltas.size(), 2u );
+      db2.apply_state_delta( deltas[0] );
+
+      // alice and bob exchange their names within one block, whichever is applied first collides
+      // with the other one's old name
+      const account_id_type alice_id = db2.get_account( "alice" ).id;
+      const account_id_type bob_id = db2.get_account( "bob" ).id;
+      account_object alice = db2.get_account( "alice" );
+      account_object bob = db2.get_account( "bob" );
+      alice.name = "bob";
+      bob.name = "alice";
+      state_delta swap = deltas[1];
+      swap.upserted.push_back( state_delta_object{ alice.id, fc::raw::pack_to_vector( alice ) } );
+      swap.upserted.push_back( state_delta_object{ bob.id, fc::raw::pack_to_vector( bob ) } );
+      const object_id_type next_account_id = db2.get_index( alice.id.space(), alice.id.type() ).get_next_id();
+      db2.apply_state_delta( swap );
+
+      BOOST_CHECK( db2.head_block_id() == db1.head_block_id() );
+      BOOST_CHECK( db2.get_account( "alice" ).id == bob_id );
+      BOOST_CHECK( db2.get_account( "bob" ).id == alice_id );
+      BOOST_CHECK( db2.get_index( alice.id.space(), alice.id.type() ).get_next_id() == next_account_id );
+      // the exchange is recorded as two modifications
+      const auto& head_undo = db2._undo_db.head();
+      BOOST_CHECK( head_undo.old_values.count( alice_id ) && head_undo.old_values.count( bob_id ) );
+      BOOST_CHECK( !head_undo.removed.count( alice_id ) && !head_undo.removed.count( bob_id ) );
+      BOOST_CHECK( !head_undo.new_ids.count( alice_id ) && !head_undo.new_ids.count( bob_id ) );
+
+      // and undone as such
+      db2._undo_db.pop_commit();
+      BOOST_CHECK( db2.get_account( "alice" ).id == alice_id );
+      BOOST_CHECK( db2.get_account( "bob" ).id == bob_id );
+      BOOST_CHECK( db2.get_index( alice.id.space(), alice.id.type() ).get_next_id() == next_account_id );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( tapos )
 {
    try {
@@ -1094,4 +1331,414 @@ BOOST_FIXTURE_TEST_CASE( generate_block_size, clean_database_fixture )
    FC_LOG_AND_RETHROW()
 }
 
+BOOST_FIXTURE_TEST_CASE( block_profiler_test, clean_database_fixture )
+{
+   try
+   {
+      block_profiler& profiler = db.get_block_profiler();
+      generate_block();
+      BOOST_CHECK_EQUAL( 0, profiler.get_block_timing().count );
+
+      profiler.set_enabled( true );
+
+      signed_transaction tx;
+      tx.set_expiration( db.head_block_time() + MUSE_MAX_TIME_UNTIL_EXPIRATION );
+      transfer_operation op;
+      op.from = MUSE_INIT_MINER_NAME;
+      op.to = MUSE_TEMP_ACCOUNT;
+      op.amount = asset( 1000, MUSE_SYMBOL );
+      tx.operations.push_back( op );
+      sign( tx, init_account_priv_key );
+      db.push_transaction( tx, 0 );
+
+      generate_block();
+      generate_block();
+
+      BOOST_CHECK_EQUAL( 2, profiler.get_block_timing().count );
+      // one sample per block, also for phases entered twice in a block
+      for( const auto& phase : profiler.get_phase_timings() )
+         BOOST_CHECK_EQUAL( 2, phase.count );
+      // the transfer counts once although it was also applied as a pending transaction
+      const operation_profile& transfers = profiler.get_operation_profiles()[ operation::tag< transfer_operation >::value ];
+      BOOST_CHECK_EQUAL( 1, transfers.timing.count );
+      BOOST_CHECK_GE( transfers.objects_written, 2 * transfers.timing.count );
+      BOOST_CHECK_EQUAL( 0, profiler.get_operation_profiles()[ operation::tag< vote_operation >::value ].timing.count );
+
+      BOOST_CHECK( profiler.get_slow_transactions().empty() );
+      profiler.set_slow_transaction_threshold( 1 );
+      tx.operations.front().get< transfer_operation >().amount = asset( 999, MUSE_SYMBOL );
+      tx.signatures.clear();
+      sign( tx, init_account_priv_key );
+      db.push_transaction( tx, 0 );
+      BOOST_REQUIRE_EQUAL( 1, profiler.get_slow_transactions().size() );
+      BOOST_CHECK( profiler.get_slow_transactions().front().trx_id == tx.id() );
+
+      BOOST_TEST_MESSAGE( "--- Applying it again while generating the block is not recorded again" );
+      generate_block();
+      BOOST_CHECK_EQUAL( 1, profiler.get_slow_transactions().size() );
+
+      profiler.reset();
+      BOOST_CHECK_EQUAL( 0, profiler.get_block_timing().count );
+      BOOST_CHECK( profiler.get_slow_transactions().empty() );
+      profiler.set_enabled( false );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( conflict_tracker_test, clean_database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob)(sam)(dave) )
+      fund( "alice", 10000 );
+      fund( "sam", 10000 );
+      generate_block();
+
+      db.enable_conflict_tracking();
+      const conflict_tracker& tracker = db.get_conflict_tracker();
+
+      auto push_transfer = [&]( const string& from, const string& to, const fc::ecc::private_key& key )
+      {
+         signed_transaction tx;
+         tx.set_expiration( db.head_block_time() + MUSE_MAX_TIME_UNTIL_EXPIRATION );
+         transfer_operation op;
+         op.from = from;
+         op.to = to;
+         op.amount = asset( 100, MUSE_SYMBOL );
+         tx.operations.push_back( op );
+         sign( tx, key );
+         db.push_transaction( tx, 0 );
+      };
+
+      BOOST_TEST_MESSAGE( "--- Transfers between disjoint accounts write disjoint objects" );
+      push_transfer( "alice", "bob", alice_private_key );
+      push_transfer( "sam", "dave", sam_private_key );
+      generate_block();
+      BOOST_CHECK_EQUAL( 1, tracker.get_stats().blocks );
+      BOOST_CHECK_EQUAL( 2, tracker.get_stats().transactions );
+      BOOST_CHECK_EQUAL( 0, tracker.get_stats().write_conflicting_transactions );
+
+      BOOST_TEST_MESSAGE( "--- Transfers from the same account conflict" );
+      push_transfer( "alice", "bob", alice_private_key );
+      push_transfer( "alice", "dave", alice_private_key );
+      generate_block();
+      BOOST_CHECK_EQUAL( 2, tracker.get_stats().blocks );
+      BOOST_CHECK_EQUAL( 4, tracker.get_stats().transactions );
+      BOOST_CHECK_EQUAL( 1, tracker.get_stats().write_conflicting_transactions );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+BOOST_FIXTURE_TEST_CASE( push_transactions_batch, clean_database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob)(sam)(dave) )
+      fund( "alice", 10000 );
+      fund( "sam", 10000 );
+      generate_block();
+
+      auto make_transfer = [&]( const string& from, const string& to, share_type amount, const fc::ecc::private_key& key )
+      {
+         signed_transaction tx;
+         tx.set_expiration( db.head_block_time() + MUSE_MAX_TIME_UNTIL_EXPIRATION );
+         transfer_operation op;
+         op.from = from;
+         op.to = to;
+         op.amount = asset( amount, MUSE_SYMBOL );
+         tx.operations.push_back( op );
+         sign( tx, key );
+         return tx;
+      };
+      const int64_t bob_balance = get_balance( "bob" ).amount.value;
+      const int64_t dave_balance = get_balance( "dave" ).amount.value;
+
+      vector< signed_transaction > trxs;
+      trxs.push_back( make_transfer( "alice", "bob", 100, alice_private_key ) );
+      trxs.push_back( make_transfer( "alice", "bob", 1000000, alice_private_key ) );
+      trxs.push_back( make_transfer( "sam", "dave", 100, sam_private_key ) );
+      vector< database::batched_transaction > batch;
+      for( const auto& tx : trxs )
+         batch.push_back( database::batched_transaction{ &tx, nullptr } );
+
+      BOOST_TEST_MESSAGE( "--- A failing transaction is undone alone" );
+      vector< fc::exception_ptr > results = db.push_transactions( batch );
+      BOOST_REQUIRE_EQUAL( 3, results.size() );
+      BOOST_CHECK( !results[0] );
+      BOOST_CHECK( results[1] );
+      BOOST_CHECK( !results[2] );
+      BOOST_CHECK_EQUAL( bob_balance + 100, get_balance( "bob" ).amount.value );
+      BOOST_CHECK_EQUAL( dave_balance + 100, get_balance( "dave" ).amount.value );
+
+      BOOST_TEST_MESSAGE( "--- The pushed transactions make it into the next block" );
+      generate_block();
+      BOOST_CHECK_EQUAL( 2, db.fetch_block_by_number( db.head_block_num() )->transactions.size() );
+      BOOST_CHECK_EQUAL( bob_balance + 100, get_balance( "bob" ).amount.value );
+      BOOST_CHECK_EQUAL( dave_balance + 100, get_balance( "dave" ).amount.value );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
+/** what the witness schedule update produced before it was optimized */
+struct previous_schedule_result
+{
+   vector< string >   shuffled_witnesses;
+   fc::uint128        virtual_time;
+   uint32_t           next_shuffle_block_num = 0;
+   version            majority_version;
+   hardfork_version   next_hardfork;
+   time_point_sec     next_hardfork_time;
+   asset              account_creation_fee;
+   asset              streaming_platform_update_fee;
+   uint32_t           maximum_block_size = 0;
+   uint16_t           mbd_interest_rate = 0;
+};
+
+/**
+ *  The previous update_witness_schedule4() and update_median_witness_props(), computed from the
+ *  state before the update without modifying it.
+ */
+static previous_schedule_result previous_witness_schedule( const database& db )
+{
+   const witness_schedule_object& wso = db.get_witness_schedule_object();
+   const hardfork_property_object& hpo = hardfork_property_id_type()( db );
+   previous_schedule_result result;
+   result.next_hardfork = hpo.next_hardfork;
+   result.next_hardfork_time = hpo.next_hardfork_time;
+
+   vector<string> active_witnesses;
+
+   flat_set<witness_id_type> selected_voted;
+   const auto& widx = db.get_index_type<witness_index>().indices().get<by_vote_name>();
+   for( auto itr = widx.begin(); itr != widx.end() && selected_voted.size() < MUSE_MAX_VOTED_WITNESSES; ++itr )
+   {
+      if( db.has_hardfork( MUSE_HARDFORK_0_3 ) && (itr->signing_key == public_key_type()) )
+         continue;
+      selected_voted.insert(itr->get_id());
+      active_witnesses.push_back(itr->owner);
+   }
+
+   fc::uint128 new_virtual_time = wso.current_virtual_time;
+   const auto& schedule_idx = db.get_index_type<witness_index>().indices().get<by_schedule_time>();
+   auto sitr = schedule_idx.begin();
+   vector<decltype(sitr)> processed_witnesses;
+   for( auto witness_count = selected_voted.size(); sitr != schedule_idx.end() && witness_count < MUSE_MAX_MINERS; ++sitr )
+   {
+      new_virtual_time = sitr->virtual_scheduled_time;
+      processed_witnesses.push_back(sitr);
+      if( db.has_hardfork( MUSE_HARDFORK_0_3 ) && sitr->signing_key == public_key_type() )
+         continue;
+      if( selected_voted.find(sitr->get_id()) == selected_voted.end() )
+      {
+         active_witnesses.push_back(sitr->owner);
+         ++witness_count;
+      }
+   }
+
+   for( auto itr = processed_witnesses.begin(); itr != processed_witnesses.end(); ++itr )
+   {
+      auto new_virtual_scheduled_time = new_virtual_time + fc::uint128::max_value() / ((*itr)->votes.value+1);
+      if( new_virtual_scheduled_time < new_virtual_time )
+      {
+         new_virtual_time = fc::uint128();
+         break;
+      }
+   }
+
+   auto majority_version = wso.majority_version;
+   flat_map< version, uint32_t, std::greater< version > > witness_versions;
+   flat_map< std::tuple< hardfork_version, time_point_sec >, uint32_t > hardfork_version_votes;
+   for( uint32_t i = 0; i < wso.current_shuffled_witnesses.size(); i++ )
+   {
+      auto witness = db.get_witness( wso.current_shuffled_witnesses[ i ] );
+      if( witness_versions.find( witness.running_version ) == witness_versions.end() )
+         witness_versions[ witness.running_version ] = 1;
+      else
+         witness_versions[ witness.running_version ] += 1;
+
+      auto version_vote = std::make_tuple( witness.hardfork_version_vote, witness.hardfork_time_vote );
+      if( hardfork_version_votes.find( version_vote ) == hardfork_version_votes.end() )
+         hardfork_version_votes[ version_vote ] = 1;
+      else
+         hardfork_version_votes[ version_vote ] += 1;
+   }
+
+   int witnesses_on_version = 0;
+   for( auto ver_itr = witness_versions.begin(); ver_itr != witness_versions.end(); ++ver_itr )
+   {
+      witnesses_on_version += ver_itr->second;
+      if( witnesses_on_version >= MUSE_HARDFORK_REQUIRED_WITNESSES )
+      {
+         majority_version = ver_itr->first;
+         break;
+      }
+   }
+
+   auto hf_itr = hardfork_version_votes.begin();
+   for( ; hf_itr != hardfork_version_votes.end(); ++hf_itr )
+   {
+      if( hf_itr->second >= MUSE_HARDFORK_REQUIRED_WITNESSES )
+      {
+         result.next_hardfork = std::get<0>( hf_itr->first );
+         result.next_hardfork_time = std::get<1>( hf_itr->first );
+         break;
+      }
+   }
+   if( hf_itr == hardfork_version_votes.end() )
+      result.next_hardfork = hpo.current_hardfork_version;
+
+   result.shuffled_witnesses = active_witnesses;
+   auto now_hi = uint64_t(db.head_block_time().sec_since_epoch()) << 32;
+   for( uint32_t i = 0; i < result.shuffled_witnesses.size(); ++i )
+   {
+      uint64_t k = now_hi + uint64_t(i)*2685821657736338717ULL;
+      k ^= (k >> 12);
+      k ^= (k << 25);
+      k ^= (k >> 27);
+      k *= 2685821657736338717ULL;
+
+      uint32_t jmax = result.shuffled_witnesses.size() - i;
+      uint32_t j = i + k%jmax;
+      std::swap( result.shuffled_witnesses[i], result.shuffled_witnesses[j] );
+   }
+   result.virtual_time = new_virtual_time;
+   result.next_shuffle_block_num = db.head_block_num() + result.shuffled_witnesses.size();
+   result.majority_version = majority_version;
+
+   vector<const witness_object*> active;
+   for( const auto& wname : result.shuffled_witnesses )
+      active.push_back(&db.get_witness(wname));
+
+   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
+   {
+      return a->props.account_creation_fee.amount < b->props.account_creation_fee.amount;
+   } );
+   result.account_creation_fee = active[active.size()/2]->props.account_creation_fee;
+   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
+   {
+      return a->props.streaming_platform_update_fee.amount < b->props.streaming_platform_update_fee.amount;
+   } );
+   result.streaming_platform_update_fee = active[active.size()/2]->props.streaming_platform_update_fee;
+   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
+   {
+      return a->props.maximum_block_size < b->props.maximum_block_size;
+   } );
+   result.maximum_block_size = active[active.size()/2]->props.maximum_block_size;
+   std::sort( active.begin(), active.end(), [&]( const witness_object* a, const witness_object* b )
+   {
+      return a->props.mbd_interest_rate < b->props.mbd_interest_rate;
+   } );
+   result.mbd_interest_rate = active[active.size()/2]->props.mbd_interest_rate;
+
+   return result;
+}
+
+BOOST_FIXTURE_TEST_CASE( witness_schedule_matches_previous_algorithm, clean_database_fixture )
+{
+   try
+   {
+      vector< witness_id_type > witnesses;
+      for( const witness_object& w : db.get_index_type<witness_index>().indices() )
+         witnesses.push_back( w.id );
+      BOOST_REQUIRE_EQUAL( MUSE_MAX_MINERS, witnesses.size() );
+
+      auto modify_witness = [&]( size_t i, const std::function< void( witness_object& ) >& m )
+      {
+         db.modify( witnesses[i](db), m );
+      };
+
+      // runs the schedule update on top of setup's changes and compares it to the previous one,
+      // then undoes both
+      uint32_t rounds = 0;
+      auto compare_round = [&]( const string& name, const std::function< void() >& setup )
+      {
+         BOOST_TEST_MESSAGE( "--- " + name );
+         generate_blocks( MUSE_MAX_MINERS - db.head_block_num() % MUSE_MAX_MINERS );
+         BOOST_REQUIRE_EQUAL( 0, db.head_block_num() % MUSE_MAX_MINERS );
+
+         auto session = db._undo_db.start_undo_session();
+         setup();
+         const previous_schedule_result expected = previous_witness_schedule( db );
+         db.update_witness_schedule();
+
+         const witness_schedule_object& wso = db.get_witness_schedule_object();
+         const hardfork_property_object& hpo = hardfork_property_id_type()( db );
+         const dynamic_global_property_object& dgp = db.get_dynamic_global_properties();
+         BOOST_CHECK( expected.shuffled_witnesses == wso.current_shuffled_witnesses );
+         BOOST_CHECK( expected.virtual_time == wso.current_virtual_time );
+         BOOST_CHECK_EQUAL( expected.next_shuffle_block_num, wso.next_shuffle_block_num );
+         BOOST_CHECK( expected.majority_version == wso.majority_version );
+         BOOST_CHECK( expected.next_hardfork == hpo.next_hardfork );
+         BOOST_CHECK( expected.next_hardfork_time == hpo.next_hardfork_time );
+         BOOST_CHECK( expected.account_creation_fee == wso.median_props.account_creation_fee );
+         BOOST_CHECK( expected.streaming_platform_update_fee == wso.median_props.streaming_platform_update_fee );
+         BOOST_CHECK_EQUAL( expected.maximum_block_size, dgp.maximum_block_size );
+         BOOST_CHECK_EQUAL( expected.mbd_interest_rate, dgp.mbd_interest_rate );
+         session.undo();
+         ++rounds;
+      };
+
+      compare_round( "Equal votes and properties", [](){} );
+      compare_round( "Next round from the updated virtual times", [](){} );
+
+      compare_round( "Tied votes", [&]() {
+         for( size_t i = 0; i < witnesses.size(); ++i )
+            modify_witness( i, [&]( witness_object& w ) { w.votes = i % 3; } );
+      } );
+
+      compare_round( "Tied and distinct properties", [&]() {
+         for( size_t i = 0; i < witnesses.size(); ++i )
+            modify_witness( i, [&]( witness_object& w ) {
+               w.props.account_creation_fee = asset( MUSE_MIN_ACCOUNT_CREATION_FEE + ( i % 4 ) * 100, MUSE_SYMBOL );
+               w.props.streaming_platform_update_fee = asset( 1000 - ( i % 5 ) * 10, MUSE_SYMBOL );
+               w.props.maximum_block_size = MUSE_MIN_BLOCK_SIZE_LIMIT * 2 + ( i / 7 ) * 1024;
+               w.props.mbd_interest_rate = 100 * ( i % 2 );
+            } );
+      } );
+
+      const time_point_sec vote_time = db.head_block_time() + fc::days( 30 );
+      compare_round( "Hardfork majority", [&]() {
+         for( size_t i = 0; i < MUSE_HARDFORK_REQUIRED_WITNESSES; ++i )
+            modify_witness( i, [&]( witness_object& w ) {
+               w.running_version = version( 0, 4, 0 );
+               w.hardfork_version_vote = hardfork_version( 0, 4 );
+               w.hardfork_time_vote = vote_time;
+            } );
+      } );
+
+      compare_round( "Hardfork votes one short of a majority", [&]() {
+         db.modify( hardfork_property_id_type()( db ), [&]( hardfork_property_object& hpo ) {
+            hpo.next_hardfork = hardfork_version( 0, 4 );
+            hpo.next_hardfork_time = vote_time;
+         } );
+         for( size_t i = 0; i + 1 < MUSE_HARDFORK_REQUIRED_WITNESSES; ++i )
+            modify_witness( i, [&]( witness_object& w ) {
+               w.running_version = version( 0, 4, 0 );
+               w.hardfork_version_vote = hardfork_version( 0, 4 );
+               w.hardfork_time_vote = vote_time;
+            } );
+      } );
+
+      compare_round( "Fewer witnesses with a signing key than scheduled", [&]() {
+         for( size_t i = 0; i < witnesses.size(); i += 5 )
+            modify_witness( i, []( witness_object& w ) { w.signing_key = public_key_type(); } );
+      } );
+
+      compare_round( "Fewer witnesses than voted slots", [&]() {
+         for( size_t i = 0; i < witnesses.size(); ++i )
+         {
+            modify_witness( i, [&]( witness_object& w ) {
+               w.votes = i % 2;
+               if( i >= 6 )
+                  w.signing_key = public_key_type();
+               w.props.maximum_block_size = MUSE_MIN_BLOCK_SIZE_LIMIT * 2 + i * 1024;
+            } );
+         }
+      } );
+
+      BOOST_CHECK_EQUAL( 8, rounds );
+   }
+   FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2018 Peertracks, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/config.hpp>
+#include <graphene/net/core_messages.hpp>
+#include <graphene/net/peer_connection.hpp>
+#include <graphene/net/peer_database.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+
+#include <fstream>
+
+using namespace graphene::net;
+
+BOOST_AUTO_TEST_SUITE( net_tests )
+
+BOOST_AUTO_TEST_CASE( inventory_expiration )
+{ try {
+   peer_connection_ptr peer = peer_connection::make_shared( nullptr );
+   std::vector< item_id > items;
+   for( int i = 0; i < 10; ++i )
+      items.emplace_back( block_message_type, fc::ripemd160::hash( std::to_string( i ) ) );
+
+   // the first batch advertised on a new connection is kept
+   for( const item_id& item : items )
+   {
+      peer->inventory_advertised_to_peer.insert( item );
+      peer->inventory_peer_advertised_to_us.insert( item );
+   }
+   peer->clear_old_inventory();
+   for( const item_id& item : items )
+   {
+      BOOST_CHECK( peer->inventory_advertised_to_peer.contains( item ) );
+      BOOST_CHECK( peer->inventory_peer_advertised_to_us.contains( item ) );
+   }
+
+   // items survive as many generations as the window holds
+   peer->inventory_generation -= GRAPHENE_NET_INVENTORY_GENERATIONS;
+   peer->clear_old_inventory();
+   BOOST_CHECK_EQUAL( items.size(), peer->inventory_advertised_to_peer.size() );
+   BOOST_CHECK_EQUAL( items.size(), peer->inventory_peer_advertised_to_us.size() );
+
+   // and expire one generation later
+   --peer->inventory_generation;
+   peer->clear_old_inventory();
+   BOOST_CHECK( peer->inventory_advertised_to_peer.empty() );
+   BOOST_CHECK( peer->inventory_peer_advertised_to_us.empty() );
+   BOOST_CHECK_EQUAL( peer_connection::current_inventory_generation(), peer->inventory_generation );
+} FC_LOG_AND_RETHROW() }
+
+namespace {
+   fc::ip::endpoint peer_endpoint( const std::string& address )
+   {
+      return fc::ip::endpoint::from_string( address + ":2001" );
+   }
+
+   potential_peer_record peer_record( const std::string& address, potential_peer_last_connection_disposition disposition,
+                                      fc::time_point_sec last_attempt, uint32_t failed_attempts = 0 )
+   {
+      potential_peer_record record( peer_endpoint( address ), last_attempt, disposition );
+      record.last_connection_attempt_time = last_attempt;
+      record.number_of_failed_connection_attempts = failed_attempts;
+      return record;
+   }
+
+   std::vector< std::string > candidate_addresses( const std::vector< potential_peer_record >& candidates )
+   {
+      std::vector< std::string > result;
+      for( const potential_peer_record& record : candidates )
+         result.push_back( std::string( record.endpoint.get_address() ) );
+      return result;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( peer_database_log_replay )
+{ try {
+   fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   const fc::path filename = dir.path() / "peers.dat";
+   const fc::time_point_sec seen( 1500000000 );
+   {
+      // dropped without close(), so the file holds the appended log instead of a snapshot
+      peer_database peers;
+      peers.open( filename );
+      peers.update_entry( potential_peer_record( peer_endpoint( "10.1.0.1" ), seen ) );
+      peers.update_entry( potential_peer_record( peer_endpoint( "10.2.0.1" ), seen ) );
+      peers.update_entry( potential_peer_record( peer_endpoint( "10.3.0.1" ), seen ) );
+      peers.erase( peer_endpoint( "10.2.0.1" ) );
+      peers.update_entry( potential_peer_record( peer_endpoint( "10.1.0.1" ), seen + 60 ) );
+   }
+
+   peer_database peers;
+   peers.open( filename );
+   BOOST_CHECK_EQUAL( 2, peers.size() );
+   BOOST_REQUIRE( peers.lookup_entry_for_endpoint( peer_endpoint( "10.1.0.1" ) ).valid() );
+   BOOST_CHECK( seen + 60 == peers.lookup_entry_for_endpoint( peer_endpoint( "10.1.0.1" ) )->last_seen_time );
+   BOOST_CHECK( !peers.lookup_entry_for_endpoint( peer_endpoint( "10.2.0.1" ) ).valid() );
+   BOOST_CHECK( peers.lookup_entry_for_endpoint( peer_endpoint( "10.3.0.1" ) ).valid() );
+   peers.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( peer_database_damaged_tail )
+{ try {
+   fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   const fc::path filename = dir.path() / "peers.dat";
+   {
+      peer_database peers;
+      peers.open( filename );
+      peers.update_entry( potential_peer_record( peer_endpoint( "10.1.0.1" ) ) );
+      peers.update_entry( potential_peer_record( peer_endpoint( "10.2.0.1" ) ) );
+      peers.close();
+   }
+   {
+      // an update entry cut off in the middle, as left behind by a crash while appending
+      std::ofstream file( filename.generic_string().c_str(), std::ofstream::binary | std::ofstream::app );
+      const char truncated_entry[] = { 0, 10, 4 };
+      file.write( truncated_entry, sizeof( truncated_entry ) );
+   }
+
+   peer_database peers;
+   peers.open( filename );
+   BOOST_CHECK_EQUAL( 2, peers.size() );
+   BOOST_CHECK( peers.lookup_entry_for_endpoint( peer_endpoint( "10.1.0.1" ) ).valid() );
+   BOOST_CHECK( peers.lookup_entry_for_endpoint( peer_endpoint( "10.2.0.1" ) ).valid() );
+   peers.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( peer_database_json_import )
+{ try {
+   fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   std::vector< potential_peer_record > records;
+   records.push_back( potential_peer_record( peer_endpoint( "10.1.0.1" ), fc::time_point_sec( 1500000000 ) ) );
+   records.push_back( potential_peer_record( peer_endpoint( "10.2.0.1" ), fc::time_point_sec( 1500000060 ), last_connection_succeeded ) );
+   fc::json::save_to_file( records, dir.path() / "peers.json" );
+
+   {
+      peer_database peers;
+      peers.open( dir.path() / "peers.dat" );
+      BOOST_CHECK_EQUAL( 2, peers.size() );
+      BOOST_REQUIRE( peers.lookup_entry_for_endpoint( peer_endpoint( "10.2.0.1" ) ).valid() );
+      BOOST_CHECK( last_connection_succeeded == peers.lookup_entry_for_endpoint( peer_endpoint( "10.2.0.1" ) )->last_connection_disposition );
+      peers.close();
+   }
+   BOOST_CHECK( fc::exists( dir.path() / "peers.dat" ) );
+
+   // the binary file wins from then on
+   fc::remove( dir.path() / "peers.json" );
+   peer_database peers;
+   peers.open( dir.path() / "peers.dat" );
+   BOOST_CHECK_EQUAL( 2, peers.size() );
+   peers.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( peer_database_bucket_eviction )
+{ try {
+   peer_database peers;
+   const fc::time_point_sec seen( 1500000000 );
+   peers.update_entry( potential_peer_record( peer_endpoint( "10.2.0.1" ), seen ) );
+   for( uint32_t i = 0; i < MAXIMUM_PEERDB_RECORDS_PER_ADDRESS_BUCKET; ++i )
+      peers.update_entry( potential_peer_record( peer_endpoint( "10.1." + std::to_string( i / 256 ) + "." + std::to_string( i % 256 ) ), seen + i + 1 ) );
+   BOOST_CHECK_EQUAL( MAXIMUM_PEERDB_RECORDS_PER_ADDRESS_BUCKET + 1, peers.size() );
+
+   // a full bucket evicts its own least recently seen peer, not the older one of another bucket
+   peers.update_entry( potential_peer_record( peer_endpoint( "10.1.255.255" ), seen + 1000 ) );
+   BOOST_CHECK_EQUAL( MAXIMUM_PEERDB_RECORDS_PER_ADDRESS_BUCKET + 1, peers.size() );
+   BOOST_CHECK( !peers.lookup_entry_for_endpoint( peer_endpoint( "10.1.0.0" ) ).valid() );
+   BOOST_CHECK( peers.lookup_entry_for_endpoint( peer_endpoint( "10.1.0.1" ) ).valid() );
+   BOOST_CHECK( peers.lookup_entry_for_endpoint( peer_endpoint( "10.1.255.255" ) ).valid() );
+   BOOST_CHECK( peers.lookup_entry_for_endpoint( peer_endpoint( "10.2.0.1" ) ).valid() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( peer_database_connection_candidates )
+{ try {
+   peer_database peers;
+   const fc::time_point_sec now( 1500000000 );
+   const uint32_t retry_timeout = 60;
+   peers.update_entry( peer_record( "10.1.0.1", last_connection_succeeded, now - 500 ) );
+   peers.update_entry( peer_record( "10.1.0.2", last_connection_succeeded, now - 400 ) );
+   peers.update_entry( peer_record( "10.2.0.1", never_attempted_to_connect, fc::time_point_sec() ) );
+   // one failed attempt waits out 2 * retry_timeout
+   peers.update_entry( peer_record( "10.3.0.1", last_connection_failed, now - 100, 1 ) );
+   peers.update_entry( peer_record( "10.4.0.1", last_connection_failed, now - 1000, 1 ) );
+
+   auto nothing_excluded = []( const fc::ip::endpoint& ) { return false; };
+   std::vector< std::string > expected = { "10.1.0.1", "10.2.0.1", "10.4.0.1", "10.1.0.2" };
+   BOOST_CHECK( expected == candidate_addresses( peers.get_connection_candidates( now, retry_timeout, 10, nothing_excluded, {} ) ) );
+
+   // peers from buckets in use only fill up what is left
+   const std::unordered_set< uint32_t > in_use = { peer_database::get_address_bucket( peer_endpoint( "10.1.0.1" ) ) };
+   expected = { "10.2.0.1", "10.4.0.1" };
+   BOOST_CHECK( expected == candidate_addresses( peers.get_connection_candidates( now, retry_timeout, 2, nothing_excluded, in_use ) ) );
+
+   auto exclude_first = []( const fc::ip::endpoint& e ) { return e == peer_endpoint( "10.1.0.1" ); };
+   expected = { "10.1.0.2", "10.2.0.1" };
+   BOOST_CHECK( expected == candidate_addresses( peers.get_connection_candidates( now, retry_timeout, 2, exclude_first, {} ) ) );
+
+   // once the backoff is over the recently failed peer is offered again
+   expected = { "10.1.0.1", "10.2.0.1", "10.4.0.1", "10.3.0.1", "10.1.0.2" };
+   BOOST_CHECK( expected == candidate_addresses( peers.get_connection_candidates( now + 30, retry_timeout, 10, nothing_excluded, {} ) ) );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,436 @@
+/*
+ * Copyright (c) 2018 Peertracks, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <muse/app/binary_rpc.hpp>
+#include <muse/app/database_api.hpp>
+#include <muse/app/http_rpc_server.hpp>
+#include <muse/chain/history_object.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/network/tcp_socket.hpp>
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace muse::chain;
+using namespace muse::app;
+
+namespace {
+
+   struct http_response
+   {
+      uint16_t    status = 0;
+      std::string body;
+      bool        close = false;
+   };
+
+   /** a raw HTTP client, requests are sent as they are given */
+   class http_test_client
+   {
+      public:
+         explicit http_test_client( uint16_t port )
+         {
+            _socket.connect_to( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), port ) );
+         }
+
+         void send( const std::string& data )
+         {
+            _socket.write( data.data(), data.size() );
+            _socket.flush();
+         }
+
+         void post( const std::string& body, const std::string& headers = "", const std::string& version = "HTTP/1.1" )
+         {
+            send( "POST / " + version + "\r\nContent-Length: " + std::to_string( body.size() ) + "\r\n" + headers + "\r\n" + body );
+         }
+
+         /** reads the next response, fails if none arrives within a few seconds */
+         http_response read_response()
+         {
+            fc::future< http_response > result = fc::async( [this]() {
+               http_response response;
+               size_t end;
+               while( ( end = _buffer.find( "\r\n\r\n" ) ) == std::string::npos )
+                  FC_ASSERT( fill(), "Connection closed without a response" );
+               std::string head = _buffer.substr( 0, end );
+               _buffer.erase( 0, end + 4 );
+               response.status = std::stoi( head.substr( head.find( ' ' ) + 1, 3 ) );
+               response.close = head.find( "\r\nConnection: close" ) != std::string::npos;
+               size_t length_pos = head.find( "Content-Length: " );
+               FC_ASSERT( length_pos != std::string::npos );
+               size_t length = std::stoul( head.substr( length_pos + 16 ) );
+               while( _buffer.size() < length )
+                  FC_ASSERT( fill(), "Connection closed in the middle of a response" );
+               response.body = _buffer.substr( 0, length );
+               _buffer.erase( 0, length );
+               return response;
+            }, "read_response" );
+            return result.wait( fc::seconds( 5 ) );
+         }
+
+         /** true if the server closes the connection within timeout without sending anything more */
+         bool closed_within( const fc::microseconds& timeout )
+         {
+            fc::future< bool > result = fc::async( [this]() { return !fill(); }, "closed_within" );
+            return result.wait( timeout );
+         }
+
+      private:
+         bool fill()
+         {
+            char data[ 4096 ];
+            try
+            {
+               size_t n = _socket.readsome( data, sizeof( data ) );
+               _buffer.append( data, n );
+               return n > 0;
+            }
+            catch( const fc::eof_exception& )
+            {
+               return false;
+            }
+         }
+
+         fc::tcp_socket _socket;
+         std::string    _buffer;
+   };
+
+   std::string rpc_call( int64_t id, const std::string& method, const std::string& params = "[]" )
+   {
+      return "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string( id ) + ",\"method\":\"" + method + "\",\"params\":" + params + "}";
+   }
+
+   struct http_rpc_fixture : public clean_database_fixture
+   {
+      http_rpc_fixture( const http_rpc_limits& limits = http_rpc_limits(), uint32_t max_pipeline = 16 )
+      {
+         app.register_api_factory< database_api >( "database_api" );
+         server.reset( new http_rpc_server( app, { "database_api" }, 2, max_pipeline, limits ) );
+         server->listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+      }
+
+      std::unique_ptr< http_rpc_server > server;
+   };
+
+   http_rpc_limits short_timeouts()
+   {
+      http_rpc_limits limits;
+      limits.idle_timeout = fc::seconds( 1 );
+      limits.header_timeout = fc::seconds( 1 );
+      limits.body_timeout = fc::seconds( 1 );
+      return limits;
+   }
+
+   http_rpc_limits small_buffer()
+   {
+      http_rpc_limits limits;
+      limits.max_buffered_bytes = 100;
+      return limits;
+   }
+
+   struct http_rpc_timeout_fixture : public http_rpc_fixture
+   {
+      http_rpc_timeout_fixture() : http_rpc_fixture( short_timeouts() ) {}
+   };
+
+   struct http_rpc_small_buffer_fixture : public http_rpc_fixture
+   {
+      http_rpc_small_buffer_fixture() : http_rpc_fixture( small_buffer(), 4 ) {}
+   };
+
+} // anonymous
+
+BOOST_FIXTURE_TEST_SUITE( rpc_tests, clean_database_fixture )
+
+BOOST_AUTO_TEST_CASE( binary_rpc_framing_test )
+{ try {
+   fc::tcp_server server;
+   server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+   fc::tcp_socket accepted;
+   fc::future< void > accepting = fc::async( [&]() { server.accept( accepted ); }, "accept" );
+   fc::tcp_socket sender;
+   sender.connect_to( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), server.get_port() ) );
+   accepting.wait();
+
+   std::vector< char > header = { 1, 2, 3 };
+   std::string body = "body";
+   binary_rpc::write_frame( sender, header, body.data(), body.size() );
+   binary_rpc::write_frame( sender, std::vector< char >(), nullptr, 0 );
+   binary_rpc::write_frame( sender, header, nullptr, 0 );
+
+   // the size prefix covers header and body
+   BOOST_CHECK( std::vector< char >( { 1, 2, 3, 'b', 'o', 'd', 'y' } ) == binary_rpc::read_frame( accepted, 7 ) );
+   BOOST_CHECK( binary_rpc::read_frame( accepted, 7 ).empty() );
+   // a frame larger than the limit is refused
+   MUSE_CHECK_THROW( binary_rpc::read_frame( accepted, 2 ), fc::exception );
+
+   // a truncated frame ends with the connection
+   std::vector< char > prefix = fc::raw::pack_to_vector( uint32_t( 10 ) );
+   sender.write( prefix.data(), prefix.size() );
+   sender.write( header.data(), header.size() );
+   sender.flush();
+   sender.close();
+   MUSE_CHECK_THROW( binary_rpc::read_frame( accepted, 10 ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( binary_rpc_handlers_test )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( "alice" );
+   transfer( "alice", "bob", 10 );
+   generate_block();
+
+   binary_rpc_server server( app );
+   server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+   binary_rpc_client client;
+   client.connect( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), server.get_port() ) );
+   database_api db_api( db );
+
+   BOOST_CHECK( db.head_block_id() == client.get_dynamic_global_properties().head_block_id );
+
+   fc::optional< signed_block > block = client.get_block( db.head_block_num() );
+   BOOST_REQUIRE( block );
+   BOOST_CHECK( db.head_block_id() == block->id() );
+   BOOST_CHECK( !client.get_block( db.head_block_num() + 1 ) );
+
+   // streams stop at the head block
+   std::vector< signed_block > blocks;
+   BOOST_CHECK_EQUAL( db.head_block_num(), client.get_blocks( 1, 1000, [&]( const signed_block& b ) { blocks.push_back( b ); } ) );
+   BOOST_REQUIRE_EQUAL( db.head_block_num(), blocks.size() );
+   for( uint32_t i = 0; i < blocks.size(); ++i )
+      BOOST_CHECK_EQUAL( i + 1, blocks[i].block_num() );
+
+   std::vector< object_id_type > ids = { alice_id, object_id_type( account_id_type( 1000000 ) ), bob_id };
+   std::vector< std::vector< char > > objects = client.call_packed< std::vector< std::vector< char > > >( "get_objects", ids );
+   BOOST_REQUIRE_EQUAL( 3, objects.size() );
+   BOOST_CHECK_EQUAL( "alice", fc::raw::unpack_from_vector< account_object >( objects[0] ).name );
+   BOOST_CHECK( objects[1].empty() );
+   BOOST_CHECK_EQUAL( "bob", fc::raw::unpack_from_vector< account_object >( objects[2] ).name );
+   ids.resize( 1001, alice_id );
+   MUSE_CHECK_THROW( ( client.call_packed< std::vector< std::vector< char > > >( "get_objects", ids ) ), fc::exception );
+
+   std::vector< fc::optional< account_object > > accounts = client.call_packed< std::vector< fc::optional< account_object > > >(
+      "lookup_account_names", std::vector< std::string >( { "bob", "nobody" } ) );
+   BOOST_REQUIRE_EQUAL( 2, accounts.size() );
+   BOOST_REQUIRE( accounts[0] );
+   BOOST_CHECK_EQUAL( "bob", accounts[0]->name );
+   BOOST_CHECK( !accounts[1] );
+
+   std::map< uint32_t, operation_object > expected = db_api.get_account_history( "alice", uint64_t( -1 ), 10 );
+   std::vector< std::pair< uint32_t, operation_object > > history;
+   std::vector< char > params;
+   binary_rpc::pack_args( params, std::string( "alice" ), uint64_t( -1 ), uint32_t( 10 ) );
+   client.call( "get_account_history", params, [&]( const char* data, size_t size ) {
+      history.push_back( binary_rpc::unpack< std::pair< uint32_t, operation_object > >( data, size ) );
+   } );
+   BOOST_REQUIRE_EQUAL( expected.size(), history.size() );
+   BOOST_CHECK( !history.empty() );
+   for( const auto& entry : history )
+      BOOST_CHECK( expected.at( entry.first ).trx_id == entry.second.trx_id );
+
+   // errors are replied, the connection stays usable
+   MUSE_CHECK_THROW( client.get_state_deltas( 1, 1, []( const state_delta& ) {} ), fc::exception );
+   MUSE_CHECK_THROW( client.call( "no_such_method", std::vector< char >(), []( const char*, size_t ) {} ), fc::exception );
+   BOOST_CHECK( db.head_block_id() == client.get_dynamic_global_properties().head_block_id );
+
+   client.close();
+   server.close();
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( http_rpc_parse_errors_test, http_rpc_fixture )
+{ try {
+   {
+      // other methods than POST are answered without closing the connection
+      http_test_client client( server->get_port() );
+      client.send( "GET / HTTP/1.1\r\n\r\n" );
+      http_response response = client.read_response();
+      BOOST_CHECK_EQUAL( 405, response.status );
+      BOOST_CHECK( !response.close );
+
+      client.post( "{not json" );
+      response = client.read_response();
+      BOOST_CHECK_EQUAL( 200, response.status );
+      BOOST_CHECK_EQUAL( -32700, fc::json::from_string( response.body )["error"]["code"].as_int64() );
+
+      client.post( rpc_call( 7, "database_api.no_such_method" ) );
+      response = client.read_response();
+      BOOST_CHECK_EQUAL( 200, response.status );
+      BOOST_CHECK_EQUAL( 7, fc::json::from_string( response.body )["id"].as_int64() );
+      BOOST_CHECK( fc::json::from_string( response.body ).get_object().contains( "error" ) );
+
+      client.post( rpc_call( 8, "database_api.get_dynamic_global_properties" ) );
+      response = client.read_response();
+      BOOST_CHECK_EQUAL( 200, response.status );
+      BOOST_CHECK_EQUAL( db.head_block_num(), fc::json::from_string( response.body )["result"]["head_block_number"].as_uint64() );
+   }
+   {
+      http_test_client client( server->get_port() );
+      client.send( "POST /\r\n\r\n" );
+      http_response response = client.read_response();
+      BOOST_CHECK_EQUAL( 400, response.status );
+      BOOST_CHECK( response.close );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+   {
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\nContent-Length: 2\r\nno colon\r\n\r\n{}" );
+      http_response response = client.read_response();
+      BOOST_CHECK_EQUAL( 400, response.status );
+      BOOST_CHECK( response.close );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( http_rpc_content_length_test, http_rpc_fixture )
+{ try {
+   {
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\n\r\n" );
+      http_response response = client.read_response();
+      BOOST_CHECK_EQUAL( 411, response.status );
+      BOOST_CHECK( response.close );
+   }
+   {
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\n{}\r\n0\r\n\r\n" );
+      BOOST_CHECK_EQUAL( 411, client.read_response().status );
+   }
+   {
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\nContent-Length: " + std::to_string( 16 * 1024 * 1024 + 1 ) + "\r\n\r\n" );
+      http_response response = client.read_response();
+      BOOST_CHECK_EQUAL( 413, response.status );
+      BOOST_CHECK( response.close );
+   }
+   {
+      // an unparsable length leaves no way to find the next request
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n" );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+   {
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\nContent-Length: 0\r\n\r\n" );
+      http_response response = client.read_response();
+      BOOST_CHECK_EQUAL( 200, response.status );
+      BOOST_CHECK_EQUAL( -32700, fc::json::from_string( response.body )["error"]["code"].as_int64() );
+
+      // the length delimits the body, what follows is the next request
+      std::string call = rpc_call( 1, "database_api.get_dynamic_global_properties" );
+      client.send( "POST / HTTP/1.1\r\nContent-Length: " + std::to_string( call.size() ) + "\r\n\r\n" + call + "\r\n" );
+      client.post( rpc_call( 2, "database_api.get_dynamic_global_properties" ) );
+      BOOST_CHECK_EQUAL( 1, fc::json::from_string( client.read_response().body )["id"].as_int64() );
+      BOOST_CHECK_EQUAL( 2, fc::json::from_string( client.read_response().body )["id"].as_int64() );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( http_rpc_keep_alive_test, http_rpc_fixture )
+{ try {
+   const std::string call = rpc_call( 1, "database_api.get_dynamic_global_properties" );
+   {
+      // HTTP/1.1 connections persist unless the client closes them
+      http_test_client client( server->get_port() );
+      client.post( call );
+      BOOST_CHECK( !client.read_response().close );
+      client.post( call, "Connection: Keep-Alive\r\n" );
+      BOOST_CHECK( !client.read_response().close );
+      client.post( call, "Connection: close\r\n" );
+      http_response response = client.read_response();
+      BOOST_CHECK_EQUAL( 200, response.status );
+      BOOST_CHECK( response.close );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+   {
+      // HTTP/1.0 connections persist only on request
+      http_test_client client( server->get_port() );
+      client.post( call, "Connection: keep-alive\r\n", "HTTP/1.0" );
+      BOOST_CHECK( !client.read_response().close );
+      client.post( call, "", "HTTP/1.0" );
+      BOOST_CHECK( client.read_response().close );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( http_rpc_pipelining_test, http_rpc_small_buffer_fixture )
+{ try {
+   // more requests than max_pipeline and more body bytes than max_buffered_bytes are sent at once
+   http_test_client client( server->get_port() );
+   std::string requests;
+   for( int64_t id = 1; id <= 20; ++id )
+   {
+      std::string call = id % 3 == 0 ? "[" + rpc_call( id, "database_api.get_block", "[1]" ) + "," + rpc_call( id, "database_api.get_config" ) + "]"
+                                      : rpc_call( id, id % 2 ? "database_api.get_dynamic_global_properties" : "database_api.get_block", id % 2 ? "[]" : "[1]" );
+      requests += "POST / HTTP/1.1\r\nContent-Length: " + std::to_string( call.size() ) + "\r\n\r\n" + call;
+   }
+   client.send( requests );
+
+   for( int64_t id = 1; id <= 20; ++id )
+   {
+      http_response response = client.read_response();
+      BOOST_REQUIRE_EQUAL( 200, response.status );
+      fc::variant result = fc::json::from_string( response.body );
+      if( id % 3 == 0 )
+      {
+         BOOST_REQUIRE( result.is_array() );
+         BOOST_REQUIRE_EQUAL( 2, result.get_array().size() );
+         BOOST_CHECK_EQUAL( id, result.get_array()[0]["id"].as_int64() );
+         BOOST_CHECK_EQUAL( id, result.get_array()[1]["id"].as_int64() );
+      }
+      else
+      {
+         BOOST_CHECK_EQUAL( id, result["id"].as_int64() );
+         BOOST_CHECK( result.get_object().contains( "result" ) );
+      }
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_FIXTURE_TEST_CASE( http_rpc_timeouts_test, http_rpc_timeout_fixture )
+{ try {
+   {
+      http_test_client client( server->get_port() );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+   {
+      // idling starts again after each response
+      http_test_client client( server->get_port() );
+      client.post( rpc_call( 1, "database_api.get_config" ) );
+      BOOST_CHECK_EQUAL( 200, client.read_response().status );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+   {
+      // headers sent line by line, too slowly
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\n" );
+      client.send( "Content-Length: 2\r\n" );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+   {
+      http_test_client client( server->get_port() );
+      client.send( "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\n{\"id\"" );
+      BOOST_CHECK( client.closed_within( fc::seconds( 5 ) ) );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()